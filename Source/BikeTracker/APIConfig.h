@@ -61,18 +61,42 @@
 #define HTTP_RETRY_ATTEMPTS 3            // Number of HTTP retry attempts
 #define HTTP_RETRY_DELAY 2000           // Delay between HTTP retries (ms)
 
+// Upload retry policy. Reports wait in a queue; a failed one is retried
+// after HTTP_RETRY_DELAY doubled per failure (capped, with jitter) until its
+// budget runs out. Consecutive failures open a breaker that holds all
+// uploads for a cooldown before one trial report is let through.
+#define UPLOAD_ALERT_ATTEMPTS (HTTP_RETRY_ATTEMPTS + 2)  // Alerts get a larger budget
+#define UPLOAD_BACKOFF_MAX 60000         // Longest wait between attempts (ms)
+#define UPLOAD_BREAKER_THRESHOLD 4       // Consecutive failures that open the breaker
+#define UPLOAD_BREAKER_COOLDOWN 180000   // Time the breaker stays open (ms)
+#define OFFLINE_LOG_MAX_RELOADS 5        // Fresh budgets a logged report gets before it is abandoned
+
 // Connection monitoring
 #define CONNECTION_CHECK_INTERVAL 60000  // Check connection health every 60 seconds
 #define CONNECTION_TIMEOUT 300000        // Reset connection if inactive for 5 minutes
 
 // Data transmission intervals
-#define HTTP_UPDATE_INTERVAL 30000       // Regular location updates (30 seconds)
+#define HTTP_UPDATE_INTERVAL 30000       // Longest gap between reports while moving (30 seconds)
 #define HTTP_ALERT_IMMEDIATE true        // Send alerts immediately (true/false)
 
+// Adaptive sampling, see SamplingPolicy.h. Each GPS fix is checked and a
+// report is queued only when one of these triggers.
+#define SAMPLING_HEADING_CHANGE 30.0       // Turn since the last report (degrees)
+#define SAMPLING_HEADING_MIN_SPEED 8.0     // Course is ignored below this speed (km/h)
+#define SAMPLING_DISTANCE 200.0            // Distance since the last report (metres)
+#define SAMPLING_MIN_INTERVAL 5000         // Never report more often than this (ms)
+#define SAMPLING_PARKED_SPEED 3.0          // Slower than this may be parked (km/h)
+#define SAMPLING_PARKED_AFTER 120000       // Slow and in place this long counts as parked (ms)
+#define SAMPLING_HEARTBEAT_INTERVAL 900000 // Report interval while parked (15 minutes)
+
 // Philippines-specific data transmission settings
-#define PH_DATA_COMPRESSION_ENABLED true    // Enable data compression for PH networks
+#define PH_DATA_COMPRESSION_ENABLED false   // Send reports in the binary LocationCodec format
+                                            // (server must accept LOCATION_CODEC_CONTENT_TYPE)
+#define PH_CONTENT_ENCODING_ENABLED false   // LZSS-compress upload bodies, see Lzss.h
+                                            // (server must decode Content-Encoding: x-lzss)
 #define PH_BATCH_UPDATES_ENABLED true      // Batch multiple updates to save data costs
 #define PH_MAX_BATCH_SIZE 5                // Maximum updates per batch for PH networks
+#define PH_BATCH_MAX_AGE 180000            // Send a partial batch once its oldest fix waited this long (ms)
 #define PH_OFFLINE_STORAGE_ENABLED true    // Store data offline during poor connectivity
 #define PH_MAX_OFFLINE_RECORDS 50          // Maximum records to store offline
 
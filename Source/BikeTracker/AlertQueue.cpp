@@ -0,0 +1,301 @@
+// AlertQueue.cpp
+// Implementation of the prioritized alert pipeline
+
+#include "AlertQueue.h"
+#include <string.h>
+
+AlertQueue::AlertQueue(unsigned long refillInterval, uint8_t burst, uint8_t smsAttempts, unsigned long retryDelay)
+    : refillInterval(refillInterval), burst(burst), smsAttempts(smsAttempts), retryDelay(retryDelay) {
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        used[i] = false;
+    }
+    for (uint8_t i = 0; i < ALERT_TYPES; i++) {
+        tokens[i] = burst;
+        refilledAt[i] = 0;
+    }
+    smsInFlight = false;
+    nextId = 1;
+    memset(&stats, 0, sizeof(stats));
+}
+
+AlertRaise AlertQueue::raise(AlertType type, const char *message, int32_t latitudeE7, int32_t longitudeE7,
+                             bool sms, bool api, unsigned long now) {
+    if (type <= ALERT_NONE || type >= ALERT_TYPES) {
+        return ALERT_DROPPED;
+    }
+    AlertTypeStats &typeStats = stats.types[type];
+    typeStats.raised++;
+
+    // Same type still waiting to go out: fold this raise into it
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        AlertEvent &event = events[i];
+        if (!used[i] || event.type != type) {
+            continue;
+        }
+        bool waiting = event.sms == DELIVERY_PENDING || (event.sms == DELIVERY_NONE && event.api == DELIVERY_PENDING);
+        if (waiting) {
+            if (event.occurrences < 255) {
+                event.occurrences++;
+            }
+            copyMessage(event.message, message);
+            event.latitudeE7 = latitudeE7;
+            event.longitudeE7 = longitudeE7;
+            event.lastRaisedAt = now;
+            if (sms && event.sms == DELIVERY_NONE) {
+                event.sms = DELIVERY_PENDING;
+                event.smsDueAt = now;
+            }
+            if (api && event.api == DELIVERY_NONE) {
+                event.api = DELIVERY_PENDING;
+            }
+            typeStats.merged++;
+            return ALERT_MERGED;
+        }
+    }
+
+    if (!takeToken(type, now)) {
+        typeStats.rateLimited++;
+        return ALERT_RATE_LIMITED;
+    }
+    int8_t slot = freeSlot(priority(type));
+    if (slot < 0) {
+        tokens[type]++; // Nothing was sent, give the token back
+        typeStats.dropped++;
+        return ALERT_DROPPED;
+    }
+
+    AlertEvent &event = events[slot];
+    event.id = nextId++;
+    if (nextId == 0) {
+        nextId = 1;
+    }
+    event.type = type;
+    event.priority = priority(type);
+    event.occurrences = 1;
+    copyMessage(event.message, message);
+    event.latitudeE7 = latitudeE7;
+    event.longitudeE7 = longitudeE7;
+    event.raisedAt = now;
+    event.lastRaisedAt = now;
+    event.sms = sms ? DELIVERY_PENDING : DELIVERY_NONE;
+    event.api = api ? DELIVERY_PENDING : DELIVERY_NONE;
+    event.smsAttempts = 0;
+    event.smsDueAt = now;
+    used[slot] = true;
+    retire(slot); // Neither sink wanted it
+    return ALERT_QUEUED;
+}
+
+uint8_t AlertQueue::takeSMS(AlertEvent **batch, uint8_t max, unsigned long now) {
+    if (smsInFlight || max == 0) {
+        return 0;
+    }
+    int8_t best = -1;
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        if (used[i] && events[i].sms == DELIVERY_PENDING && (long)(now - events[i].smsDueAt) >= 0 &&
+            (best < 0 || isBefore(events[i], events[best]))) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return 0;
+    }
+
+    uint8_t count = 0;
+    batch[count++] = &events[best];
+    if (coalesces(events[best].type)) {
+        // Waiting for a retry does not matter here; they go along now
+        for (uint8_t i = 0; i < ALERT_QUEUE_SIZE && count < max; i++) {
+            if (i != best && used[i] && events[i].sms == DELIVERY_PENDING && coalesces(events[i].type)) {
+                batch[count++] = &events[i];
+            }
+        }
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        batch[i]->sms = DELIVERY_SENDING;
+        batch[i]->smsAttempts++;
+    }
+    smsInFlight = true;
+    return count;
+}
+
+void AlertQueue::completeSMS(bool success, unsigned long now) {
+    if (!smsInFlight) {
+        return;
+    }
+    smsInFlight = false;
+
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        AlertEvent &event = events[i];
+        if (!used[i] || event.sms != DELIVERY_SENDING) {
+            continue;
+        }
+        count++;
+        if (success) {
+            event.sms = DELIVERY_SENT;
+            stats.types[event.type].smsSent++;
+        } else if (event.smsAttempts >= smsAttempts) {
+            event.sms = DELIVERY_FAILED;
+            stats.types[event.type].smsFailed++;
+        } else {
+            event.sms = DELIVERY_PENDING;
+            event.smsDueAt = now + retryDelay;
+        }
+        retire(i);
+    }
+    if (success) {
+        stats.smsMessages++;
+        if (count > 1) {
+            stats.coalesced += count;
+        }
+    }
+}
+
+AlertEvent *AlertQueue::takeAPI() {
+    int8_t best = -1;
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        if (used[i] && events[i].api == DELIVERY_PENDING && (best < 0 || isBefore(events[i], events[best]))) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return NULL;
+    }
+    events[best].api = DELIVERY_SENDING;
+    return &events[best];
+}
+
+void AlertQueue::completeAPI(uint16_t id, AlertDelivery result) {
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        AlertEvent &event = events[i];
+        if (!used[i] || event.id != id || event.api != DELIVERY_SENDING) {
+            continue;
+        }
+        event.api = result;
+        if (result == DELIVERY_SENT) {
+            stats.types[event.type].apiSent++;
+        } else if (result == DELIVERY_FAILED) {
+            stats.types[event.type].apiFailed++;
+        }
+        retire(i);
+        return;
+    }
+}
+
+uint8_t AlertQueue::count() {
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        if (used[i]) {
+            total++;
+        }
+    }
+    return total;
+}
+
+AlertEvent *AlertQueue::get(uint8_t index) {
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        if (used[i] && index-- == 0) {
+            return &events[i];
+        }
+    }
+    return NULL;
+}
+
+const AlertQueueStats &AlertQueue::getStats() {
+    return stats;
+}
+
+uint8_t AlertQueue::priority(AlertType type) {
+    switch (type) {
+        case ALERT_MOTION_DETECTED:
+        case ALERT_GEOFENCE_BREACH:
+            return 3; // Possible theft
+        case ALERT_SPEED_EXCEEDED:
+        case ALERT_SYSTEM_ERROR:
+            return 2;
+        case ALERT_GPS_LOST:
+        case ALERT_GSM_LOST:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+bool AlertQueue::coalesces(AlertType type) {
+    return type == ALERT_MOTION_DETECTED || type == ALERT_GEOFENCE_BREACH || type == ALERT_SPEED_EXCEEDED;
+}
+
+const char *AlertQueue::typeName(AlertType type) {
+    switch (type) {
+        case ALERT_MOTION_DETECTED: return "MOTION ALERT";
+        case ALERT_SPEED_EXCEEDED: return "SPEED ALERT";
+        case ALERT_GEOFENCE_BREACH: return "GEOFENCE ALERT";
+        case ALERT_SYSTEM_ERROR: return "SYSTEM ERROR";
+        case ALERT_GPS_LOST: return "GPS LOST";
+        case ALERT_GSM_LOST: return "GSM LOST";
+        default: return "GENERAL ALERT";
+    }
+}
+
+bool AlertQueue::takeToken(AlertType type, unsigned long now) {
+    unsigned long gained = refillInterval > 0 ? (now - refilledAt[type]) / refillInterval : burst;
+    if (gained > 0) {
+        if (tokens[type] + gained >= burst) {
+            tokens[type] = burst;
+            refilledAt[type] = now;
+        } else {
+            tokens[type] += gained;
+            refilledAt[type] += gained * refillInterval;
+        }
+    }
+    if (tokens[type] == 0) {
+        return false;
+    }
+    if (tokens[type] == burst) {
+        refilledAt[type] = now; // Refill starts with the first token spent
+    }
+    tokens[type]--;
+    return true;
+}
+
+int8_t AlertQueue::freeSlot(uint8_t priority) {
+    // A free slot, or the least important event not being sent by SMS
+    // right now, if it is no more important than the new one
+    int8_t victim = -1;
+    for (uint8_t i = 0; i < ALERT_QUEUE_SIZE; i++) {
+        if (!used[i]) {
+            return i;
+        }
+        if (events[i].sms != DELIVERY_SENDING && (victim < 0 || isBefore(events[victim], events[i]))) {
+            victim = i;
+        }
+    }
+    if (victim < 0 || events[victim].priority > priority) {
+        return -1;
+    }
+    stats.types[events[victim].type].dropped++;
+    used[victim] = false;
+    return victim;
+}
+
+bool AlertQueue::isBefore(const AlertEvent &a, const AlertEvent &b) {
+    if (a.priority != b.priority) {
+        return a.priority > b.priority;
+    }
+    return (long)(b.raisedAt - a.raisedAt) > 0;
+}
+
+void AlertQueue::retire(uint8_t slot) {
+    AlertEvent &event = events[slot];
+    bool smsSettled = event.sms != DELIVERY_PENDING && event.sms != DELIVERY_SENDING;
+    bool apiSettled = event.api != DELIVERY_PENDING && event.api != DELIVERY_SENDING;
+    if (smsSettled && apiSettled) {
+        used[slot] = false;
+    }
+}
+
+void AlertQueue::copyMessage(char *target, const char *message) {
+    strncpy(target, message != NULL ? message : "", ALERT_MESSAGE_SIZE - 1);
+    target[ALERT_MESSAGE_SIZE - 1] = '\0';
+}
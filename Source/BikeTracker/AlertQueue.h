@@ -0,0 +1,130 @@
+// AlertQueue.h
+// Header for the prioritized alert pipeline
+//
+// Checks raise alerts as events; nothing is sent from inside the check.
+// Events wait in a fixed-size queue ordered by priority and age and are
+// drained to the SMS and web API sinks by the owner, one send at a time.
+// A new alert of a type that is still waiting for its SMS is merged into
+// the waiting event instead of queueing a second one. Motion, geofence and
+// speed alerts waiting together go out as one SMS. Each type has its own
+// token bucket, so a burst of one type cannot starve or silence another.
+
+#ifndef ALERTQUEUE_H
+#define ALERTQUEUE_H
+
+#include <Arduino.h>
+
+#define ALERT_QUEUE_SIZE 8
+#define ALERT_MESSAGE_SIZE 48       // Detail text kept per event, truncated
+
+enum AlertType {
+    ALERT_NONE,
+    ALERT_MOTION_DETECTED,     // ✅ Works with GPS
+    ALERT_SPEED_EXCEEDED,      // ✅ Works with GPS
+    ALERT_GEOFENCE_BREACH,     // ✅ Works with GPS
+    ALERT_SYSTEM_ERROR,        // ✅ Works with software monitoring
+    ALERT_GPS_LOST,            // ✅ GPS fix lost alert
+    ALERT_GSM_LOST,            // ✅ GSM connection lost alert
+    ALERT_TYPES
+};
+
+// Delivery state of one event at one sink
+enum AlertDelivery {
+    DELIVERY_NONE,                  // Not sent to this sink
+    DELIVERY_PENDING,
+    DELIVERY_SENDING,
+    DELIVERY_SENT,
+    DELIVERY_STORED,                // API only: kept in the offline log for later
+    DELIVERY_FAILED
+};
+
+enum AlertRaise {
+    ALERT_QUEUED,
+    ALERT_MERGED,                   // Folded into a waiting event of the same type
+    ALERT_RATE_LIMITED,             // Type out of tokens, not queued
+    ALERT_DROPPED                   // Queue full of more important events
+};
+
+struct AlertEvent {
+    uint16_t id;                    // Never 0
+    AlertType type;
+    uint8_t priority;
+    uint8_t occurrences;            // Raises folded into this event
+    char message[ALERT_MESSAGE_SIZE];
+    int32_t latitudeE7;             // Position at the latest raise
+    int32_t longitudeE7;
+    unsigned long raisedAt;
+    unsigned long lastRaisedAt;
+    AlertDelivery sms;
+    AlertDelivery api;
+    uint8_t smsAttempts;
+    unsigned long smsDueAt;
+};
+
+struct AlertTypeStats {
+    unsigned long raised;
+    unsigned long merged;
+    unsigned long rateLimited;
+    unsigned long dropped;
+    unsigned long smsSent;
+    unsigned long smsFailed;
+    unsigned long apiSent;
+    unsigned long apiFailed;
+};
+
+struct AlertQueueStats {
+    AlertTypeStats types[ALERT_TYPES];
+    unsigned long smsMessages;      // SMS sent, each carrying one or more events
+    unsigned long coalesced;        // Events that shared an SMS with another
+};
+
+class AlertQueue {
+public:
+    // Each type earns a token every refillInterval ms, holding at most
+    // burst; a new event costs one. SMS that fail are retried after
+    // retryDelay until smsAttempts run out.
+    AlertQueue(unsigned long refillInterval, uint8_t burst, uint8_t smsAttempts, unsigned long retryDelay);
+
+    AlertRaise raise(AlertType type, const char *message, int32_t latitudeE7, int32_t longitudeE7,
+                     bool sms, bool api, unsigned long now);
+
+    // SMS sink. takeSMS() fills batch with the events for the next SMS:
+    // the most important one due and, if it coalesces, every other
+    // coalescing event waiting for an SMS. Returns the count, 0 if an SMS
+    // is already in flight or nothing is due. completeSMS() settles them.
+    uint8_t takeSMS(AlertEvent **batch, uint8_t max, unsigned long now);
+    void completeSMS(bool success, unsigned long now);
+
+    // API sink. takeAPI() returns the most important event waiting for
+    // the API and marks it sending; completeAPI() settles it by id.
+    AlertEvent *takeAPI();
+    void completeAPI(uint16_t id, AlertDelivery result);
+
+    uint8_t count();
+    AlertEvent *get(uint8_t index);  // Queued events, NULL past the last
+    const AlertQueueStats &getStats();
+    static uint8_t priority(AlertType type);
+    static bool coalesces(AlertType type);
+    static const char *typeName(AlertType type);
+
+private:
+    AlertEvent events[ALERT_QUEUE_SIZE];
+    bool used[ALERT_QUEUE_SIZE];
+    uint8_t tokens[ALERT_TYPES];
+    unsigned long refilledAt[ALERT_TYPES];
+    unsigned long refillInterval;
+    uint8_t burst;
+    uint8_t smsAttempts;
+    unsigned long retryDelay;
+    bool smsInFlight;
+    uint16_t nextId;
+    AlertQueueStats stats;
+
+    bool takeToken(AlertType type, unsigned long now);
+    int8_t freeSlot(uint8_t priority);
+    bool isBefore(const AlertEvent &a, const AlertEvent &b);
+    void retire(uint8_t slot);      // Frees the slot once both sinks are settled
+    static void copyMessage(char *target, const char *message);
+};
+
+#endif // ALERTQUEUE_H
@@ -0,0 +1,238 @@
+// AtEngine.cpp
+// Implementation of the queued, non-blocking AT command engine
+
+#include "AtEngine.h"
+#include <string.h>
+
+AtEngine::AtEngine(SerialTransport &serial) : port(serial) {
+    head = 0;
+    count = 0;
+    state = AT_STATE_IDLE;
+    urcHandlerCount = 0;
+    lineLength = 0;
+    lineSpilled = false;
+    expectedSeen = false;
+    errorSeen = false;
+    errorMatch.setPattern("ERROR");
+    startTime = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool AtEngine::submit(const String &command, const String &expected, unsigned long timeout,
+                      AtCallback callback, void *context) {
+    return submitWithPayload(command, "", "", false, expected, timeout, callback, context);
+}
+
+bool AtEngine::submitWithPayload(const String &command, const String &prompt, const String &payload,
+                                 bool ctrlZ, const String &expected, unsigned long timeout,
+                                 AtCallback callback, void *context) {
+    if (count >= AT_QUEUE_SIZE) {
+        stats.rejected++;
+        return false;
+    }
+    
+    AtCommand &slot = queue[(head + count) % AT_QUEUE_SIZE];
+    slot.command = command;
+    slot.expected = expected;
+    slot.prompt = prompt;
+    slot.payload = payload;
+    slot.ctrlZ = ctrlZ;
+    slot.timeout = timeout;
+    slot.callback = callback;
+    slot.context = context;
+    count++;
+    return true;
+}
+
+bool AtEngine::addUrcHandler(const char *prefix, AtUrcCallback callback, void *context) {
+    if (urcHandlerCount >= AT_URC_HANDLERS_MAX) {
+        return false;
+    }
+    AtUrcHandler &handler = urcHandlers[urcHandlerCount++];
+    handler.prefix = prefix;
+    handler.callback = callback;
+    handler.context = context;
+    return true;
+}
+
+void AtEngine::start() {
+    AtCommand &current = queue[head];
+    
+    // A partial line is kept: it may be a URC still arriving
+    response = "";
+    expectedMatch.setPattern(current.expected.c_str());
+    promptMatch.setPattern(current.prompt.c_str());
+    resetMatchers();
+    port.println(current.command);
+    startTime = millis();
+    state = (current.prompt.length() > 0) ? AT_STATE_WAIT_PROMPT : AT_STATE_WAIT_RESPONSE;
+}
+
+void AtEngine::update() {
+    if (state == AT_STATE_IDLE) {
+        // Between commands only URCs (or late replies) arrive
+        while (port.available()) {
+            receive(port.read());
+        }
+        if (count == 0) {
+            return;
+        }
+        start();
+    }
+    
+    while (port.available()) {
+        if (receive(port.read())) {
+            return; // Command finished
+        }
+    }
+    
+    if (millis() - startTime >= queue[head].timeout) {
+        finish(AT_RESULT_TIMEOUT);
+    }
+}
+
+void AtEngine::discardInput() {
+    if (state != AT_STATE_IDLE) {
+        return; // Bytes belong to the command in flight
+    }
+    while (port.available()) {
+        receive(port.read());
+    }
+    lineLength = 0;
+    lineSpilled = false;
+}
+
+bool AtEngine::receive(char c) {
+    // Returns true once the command in flight has finished
+    if (state != AT_STATE_IDLE) {
+        expectedSeen |= expectedMatch.feed(c);
+        errorSeen |= errorMatch.feed(c);
+        
+        // Prompts do not end with a line break, so they act at once
+        if (state == AT_STATE_WAIT_PROMPT && promptMatch.feed(c)) {
+            sendPayload();
+            return false;
+        }
+    }
+    
+    if (lineLength >= AT_LINE_MAX) {
+        spillLine();
+    }
+    line[lineLength++] = c;
+    
+    if (c == '\n') {
+        return completeLine();
+    }
+    return false;
+}
+
+void AtEngine::sendPayload() {
+    AtCommand &current = queue[head];
+    port.print(current.payload);
+    if (current.ctrlZ) {
+        port.write(AT_CTRL_Z);
+    }
+    lineLength = 0;
+    lineSpilled = false;
+    response = "";
+    resetMatchers();
+    startTime = millis();
+    state = AT_STATE_WAIT_RESPONSE;
+}
+
+void AtEngine::spillLine() {
+    // Move the buffered part of an over-long line into the reply
+    if (state != AT_STATE_IDLE && response.length() < AT_RESPONSE_MAX) {
+        unsigned int room = AT_RESPONSE_MAX - response.length();
+        if (lineLength > room) {
+            lineLength = room;
+        }
+        line[lineLength] = '\0';
+        response += line;
+    }
+    lineLength = 0;
+    lineSpilled = true;
+}
+
+bool AtEngine::completeLine() {
+    bool expected = expectedSeen || expectedMatch.isEmpty();
+    bool error = errorSeen;
+    resetMatchers();
+    
+    // Over-long lines are never URCs
+    if ((!lineSpilled && dispatchUrc()) || state == AT_STATE_IDLE) {
+        lineLength = 0; // Handled, or nobody is waiting for it
+        lineSpilled = false;
+        return false;
+    }
+    spillLine();
+    lineSpilled = false;
+    
+    // Final results always end a line, so outcomes are decided here
+    if (expected && state == AT_STATE_WAIT_RESPONSE) {
+        finish(AT_RESULT_OK);
+        return true;
+    }
+    if (error) {
+        finish(AT_RESULT_ERROR);
+        return true;
+    }
+    return false;
+}
+
+void AtEngine::resetMatchers() {
+    // Tokens never span lines
+    expectedMatch.reset();
+    errorMatch.reset();
+    promptMatch.reset();
+    expectedSeen = false;
+    errorSeen = false;
+}
+
+bool AtEngine::dispatchUrc() {
+    line[lineLength] = '\0';
+    for (uint8_t i = 0; i < urcHandlerCount; i++) {
+        AtUrcHandler &handler = urcHandlers[i];
+        if (strncmp(line, handler.prefix, strlen(handler.prefix)) != 0) {
+            continue;
+        }
+        String urc = line;
+        urc.trim();
+        if (handler.callback(handler.context, urc)) {
+            stats.unsolicited++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void AtEngine::finish(AtResult result) {
+    // Pop before the callback so it can queue follow-up commands
+    AtCallback callback = queue[head].callback;
+    void *context = queue[head].context;
+    head = (head + 1) % AT_QUEUE_SIZE;
+    count--;
+    state = AT_STATE_IDLE;
+    
+    switch (result) {
+        case AT_RESULT_OK: stats.completed++; break;
+        case AT_RESULT_ERROR: stats.errors++; break;
+        case AT_RESULT_TIMEOUT: stats.timeouts++; break;
+    }
+    
+    if (callback != NULL) {
+        callback(context, result, response);
+    }
+}
+
+bool AtEngine::isIdle() {
+    return count == 0;
+}
+
+uint8_t AtEngine::pending() {
+    return count;
+}
+
+const AtEngineStats &AtEngine::getStats() {
+    return stats;
+}
@@ -0,0 +1,130 @@
+// AtEngine.h
+// Header for the queued, non-blocking AT command engine
+//
+// Commands are queued with a per-command timeout and completion callback.
+// update() sends the next command when the modem is free and feeds it the
+// reply bytes as they arrive, so nothing ever waits inside the engine.
+// Unsolicited result codes (URCs) are recognised line by line, in or out
+// of a command, and routed to registered handlers instead of the reply.
+// Replies are matched incrementally as bytes arrive; lines are collected
+// in a fixed buffer and added to the reply a line (or chunk) at a time.
+
+#ifndef ATENGINE_H
+#define ATENGINE_H
+
+#include <Arduino.h>
+#include "SerialTransport.h"
+#include "AtMatcher.h"
+
+#define AT_QUEUE_SIZE 6             // Commands waiting or in flight
+#define AT_RESPONSE_MAX 1024        // Reply bytes kept per command (HTTPREAD bodies)
+#define AT_LINE_MAX 96              // Line buffer; longer lines reach the reply in chunks
+#define AT_URC_HANDLERS_MAX 8      // Registered URC prefixes
+#define AT_CTRL_Z 26
+
+enum AtResult {
+    AT_RESULT_OK,                   // Expected response seen
+    AT_RESULT_ERROR,                // ERROR / +CME ERROR / +CMS ERROR
+    AT_RESULT_TIMEOUT
+};
+
+typedef void (*AtCallback)(void *context, AtResult result, const String &response);
+
+// Called with a complete line (line break stripped) that starts with a
+// registered prefix. Return false if the line is a solicited reply after
+// all (e.g. "+CREG: 0,1" answering AT+CREG?), which keeps it in the reply.
+typedef bool (*AtUrcCallback)(void *context, const String &line);
+
+struct AtEngineStats {
+    unsigned long completed;
+    unsigned long errors;
+    unsigned long timeouts;
+    unsigned long rejected;         // submit() with a full queue
+    unsigned long unsolicited;      // URC lines handled
+};
+
+class AtEngine {
+public:
+    AtEngine(SerialTransport &port);
+    
+    // Queue a command. The command completes on the first line containing
+    // expected (or an ERROR line), or after timeout ms. False if the queue
+    // is full.
+    bool submit(const String &command, const String &expected, unsigned long timeout,
+                AtCallback callback = NULL, void *context = NULL);
+    
+    // Same, but payload is written once prompt ("> ", "DOWNLOAD") appears,
+    // optionally followed by Ctrl+Z. The timeout restarts at that point.
+    bool submitWithPayload(const String &command, const String &prompt, const String &payload,
+                           bool ctrlZ, const String &expected, unsigned long timeout,
+                           AtCallback callback = NULL, void *context = NULL);
+    
+    // Route lines starting with prefix to callback. prefix must stay valid
+    // (a string literal). False if the handler table is full.
+    bool addUrcHandler(const char *prefix, AtUrcCallback callback, void *context);
+    
+    // Pump: never blocks
+    void update();
+    
+    // Dispatch complete URC lines waiting in the port and drop the rest.
+    // Only meaningful while idle, e.g. after a baud change.
+    void discardInput();
+    
+    bool isIdle();                  // Nothing queued or in flight
+    uint8_t pending();
+    const AtEngineStats &getStats();
+    
+private:
+    enum EngineState {
+        AT_STATE_IDLE,
+        AT_STATE_WAIT_PROMPT,
+        AT_STATE_WAIT_RESPONSE
+    };
+    
+    struct AtCommand {
+        String command;
+        String expected;
+        String prompt;
+        String payload;
+        bool ctrlZ;
+        unsigned long timeout;
+        AtCallback callback;
+        void *context;
+    };
+    
+    struct AtUrcHandler {
+        const char *prefix;
+        AtUrcCallback callback;
+        void *context;
+    };
+    
+    SerialTransport &port;
+    AtCommand queue[AT_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    EngineState state;
+    AtUrcHandler urcHandlers[AT_URC_HANDLERS_MAX];
+    uint8_t urcHandlerCount;
+    char line[AT_LINE_MAX + 1];     // Line being received
+    uint8_t lineLength;
+    bool lineSpilled;               // Part of the line already went to the reply
+    AtMatcher expectedMatch;
+    AtMatcher errorMatch;           // "ERROR", which also covers +CME / +CMS ERROR
+    AtMatcher promptMatch;
+    bool expectedSeen;              // Matches in the current line
+    bool errorSeen;
+    String response;
+    unsigned long startTime;
+    AtEngineStats stats;
+    
+    void start();
+    bool receive(char c);
+    void sendPayload();
+    void spillLine();
+    bool completeLine();
+    void resetMatchers();
+    bool dispatchUrc();
+    void finish(AtResult result);
+};
+
+#endif // ATENGINE_H
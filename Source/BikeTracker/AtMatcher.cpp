@@ -0,0 +1,59 @@
+// AtMatcher.cpp
+// Implementation of the incremental substring matcher
+
+#include "AtMatcher.h"
+
+AtMatcher::AtMatcher() {
+    length = 0;
+    matched = 0;
+}
+
+void AtMatcher::setPattern(const char *text) {
+    length = 0;
+    while (text[length] != '\0' && length < AT_MATCH_PATTERN_MAX) {
+        pattern[length] = text[length];
+        length++;
+    }
+    
+    // failure[i]: length of the longest proper prefix of pattern[0..i]
+    // that is also its suffix
+    uint8_t k = 0;
+    if (length > 0) {
+        failure[0] = 0;
+    }
+    for (uint8_t i = 1; i < length; i++) {
+        while (k > 0 && pattern[i] != pattern[k]) {
+            k = failure[k - 1];
+        }
+        if (pattern[i] == pattern[k]) {
+            k++;
+        }
+        failure[i] = k;
+    }
+    matched = 0;
+}
+
+void AtMatcher::reset() {
+    matched = 0;
+}
+
+bool AtMatcher::feed(char c) {
+    if (length == 0) {
+        return false;
+    }
+    while (matched > 0 && c != pattern[matched]) {
+        matched = failure[matched - 1];
+    }
+    if (c == pattern[matched]) {
+        matched++;
+    }
+    if (matched == length) {
+        matched = failure[length - 1]; // Allow overlapping matches
+        return true;
+    }
+    return false;
+}
+
+bool AtMatcher::isEmpty() {
+    return length == 0;
+}
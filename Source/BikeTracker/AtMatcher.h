@@ -0,0 +1,33 @@
+// AtMatcher.h
+// Incremental substring matcher for modem replies
+//
+// Knuth-Morris-Pratt: bytes are fed one at a time and the matcher keeps
+// only how much of the pattern is currently matched, so nothing is
+// buffered or rescanned. Amortised O(1) per byte.
+
+#ifndef ATMATCHER_H
+#define ATMATCHER_H
+
+#include <stdint.h>
+
+#define AT_MATCH_PATTERN_MAX 24     // Longest token matched ("+CIPPING: 1," is 12)
+
+class AtMatcher {
+public:
+    AtMatcher();
+    
+    // Copy pattern (truncated to AT_MATCH_PATTERN_MAX) and build its
+    // failure table. An empty pattern never matches.
+    void setPattern(const char *pattern);
+    void reset();                   // Forget partial progress, keep the pattern
+    bool feed(char c);              // True when this byte completes the pattern
+    bool isEmpty();
+    
+private:
+    char pattern[AT_MATCH_PATTERN_MAX];
+    uint8_t failure[AT_MATCH_PATTERN_MAX];
+    uint8_t length;
+    uint8_t matched;
+};
+
+#endif // ATMATCHER_H
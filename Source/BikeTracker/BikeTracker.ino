@@ -4,7 +4,6 @@
 // Supports both Testing/Development and Production modes
 
 #include <Arduino.h>
-#include <SoftwareSerial.h>
 
 // Project headers
 #include "ModeConfig.h"
@@ -13,10 +12,20 @@
 #include "Neo6mGPS.h"
 #include "Sim800L.h"
 #include "BikeTrackerCore.h"
+#include "SoftwareSerialTransport.h"
+#include "HardwareSerialTransport.h"
+
+#if GSM_HARDWARE_UART && CURRENT_MODE == MODE_TESTING
+    #error "GSM_HARDWARE_UART takes over the USB console, use it in production mode only"
+#endif
 
 // Hardware objects
-SoftwareSerial SerialGPS(GPS_RX_PIN, GPS_TX_PIN);
-SoftwareSerial SerialGSM(GSM_RX_PIN, GSM_TX_PIN);
+SoftwareSerialTransport SerialGPS(GPS_RX_PIN, GPS_TX_PIN, GPS_RX_BUFFER_SIZE, GPS_ISR_BUFFER_SIZE);
+#if GSM_HARDWARE_UART
+    HardwareSerialTransport SerialGSM(Serial, GSM_RX_BUFFER_SIZE, true);
+#else
+    SoftwareSerialTransport SerialGSM(GSM_RX_PIN, GSM_TX_PIN, GSM_RX_BUFFER_SIZE, GSM_ISR_BUFFER_SIZE);
+#endif
 Neo6mGPS gps(SerialGPS);
 Sim800L gsm(SerialGSM);
 BikeTrackerCore tracker(gps, gsm);
@@ -54,8 +63,10 @@ void setup() {
     
     // Initialize hardware components
     DEBUG_PRINTLN("Initializing hardware components...");
-    SerialGPS.begin(9600);
-    SerialGSM.begin(9600);
+    // Both links start at the power-up defaults; the tracker core
+    // negotiates faster rates during initialization
+    SerialGPS.begin(GPS_BAUD_DEFAULT);
+    SerialGSM.begin(GSM_BAUD_DEFAULT);
     
     // Initialize tracker core
     DEBUG_PRINTLN("Initializing BikeTracker core...");
@@ -98,6 +109,7 @@ void setup() {
             Serial.println("GPSPERF   - Test GPS performance");
             Serial.println("GPSSTATUS - Show current GPS status");
             Serial.println("GPSRAW    - Display raw NMEA data");
+            Serial.println("BAUDTEST  - Benchmark GPS/GSM links at each baud rate");
             Serial.println("");
             Serial.println("HELP      - Show this menu");
             Serial.println("NOTE: Power management fully implemented");
@@ -143,9 +155,6 @@ void loop() {
             }
         #endif
     }
-    
-    // Small delay to prevent overwhelming the system
-    delay(100);
 }
 
 void handleTestingMode() {
@@ -169,7 +178,7 @@ void handleProductionMode() {
         lastProductionLog = millis();
         
         TrackerStatus status = tracker.getStatus();
-        if (status.state == TRACKER_ALERT || status.state == TRACKER_ERROR) {
+        if (!GSM_HARDWARE_UART && (status.state == TRACKER_ALERT || status.state == TRACKER_ERROR)) {
             Serial.print("ALERT: State=");
             Serial.print(status.state);
             Serial.print(" GPS=");
@@ -314,6 +323,10 @@ void processSerialCommands() {
             Serial.println("Displaying raw NMEA data for 10 seconds...");
             gps.displayRawNMEA(10);
             
+        } else if (serialCommand == "BAUDTEST") {
+            Serial.println("Benchmarking serial links at each baud rate...");
+            tracker.runLinkBenchmark();
+            
         } else if (serialCommand == "HELP") {
             Serial.println("\n=== TESTING MODE COMMANDS ===");
             Serial.println("ARM       - Arm the tracker");
@@ -348,6 +361,7 @@ void processSerialCommands() {
             Serial.println("GPSPERF   - Test GPS performance");
             Serial.println("GPSSTATUS - Show current GPS status");
             Serial.println("GPSRAW    - Display raw NMEA data");
+            Serial.println("BAUDTEST  - Benchmark GPS/GSM links at each baud rate");
             Serial.println("");
             Serial.println("HELP      - Show this menu");
             Serial.println("NOTE: Power management fully implemented");
@@ -436,6 +450,10 @@ void printDetailedStatus() {
     Serial.print("Total Alerts: ");
     Serial.println(status.alertsCount);
     
+    Serial.print("Loop Latency (worst): ");
+    Serial.print(tracker.getSchedulerStats().maxLoopLatency / 1000);
+    Serial.println(" ms");
+    
     Serial.print("Free Memory: ");
     Serial.print(ESP.getFreeHeap());
     Serial.println(" bytes");
@@ -4,10 +4,44 @@
 #include "BikeTrackerCore.h"
 #include "PinConfig.h"
 #include "APIConfig.h"
+#include "Coordinates.h"
+#include "LocationCodec.h"
 #include <math.h>
 
+// Candidate UART rates for the GPS and GSM links, fastest first
+static const long linkBaudRates[] = LINK_BAUD_CANDIDATES;
+static const uint8_t linkBaudRateCount = sizeof(linkBaudRates) / sizeof(linkBaudRates[0]);
+
+static const SamplingParameters defaultSampling = {
+    SAMPLING_HEADING_CHANGE, SAMPLING_HEADING_MIN_SPEED, SAMPLING_DISTANCE, SAMPLING_MIN_INTERVAL,
+    HTTP_UPDATE_INTERVAL, SAMPLING_PARKED_SPEED, SAMPLING_PARKED_AFTER, SAMPLING_HEARTBEAT_INTERVAL
+};
+
+static const MotionParameters defaultMotion = {
+    MOTION_THRESHOLD, MOTION_HDOP_METRES, MOTION_MAX_HDOP, MOTION_MIN_SATELLITES, MOTION_CONFIRM_FIXES,
+    MOTION_SPEED, MOTION_SPEED_CONFIRM_FIXES, MOTION_ANCHOR_FIXES
+};
+
+// Alert names used by the web API, empty for routine reports
+static const char *apiAlertName(AlertType type) {
+    switch (type) {
+        case ALERT_NONE: return "";
+        case ALERT_MOTION_DETECTED: return "MOTION_DETECTED";
+        case ALERT_SPEED_EXCEEDED: return "SPEED_EXCEEDED";
+        case ALERT_GEOFENCE_BREACH: return "GEOFENCE_BREACH";
+        case ALERT_SYSTEM_ERROR: return "SYSTEM_ERROR";
+        case ALERT_GPS_LOST: return "GPS_LOST";
+        case ALERT_GSM_LOST: return "GSM_LOST";
+        default: return "UNKNOWN";
+    }
+}
+
 BikeTrackerCore::BikeTrackerCore(Neo6mGPS &gpsModule, Sim800L &gsmModule) 
-    : gps(gpsModule), gsm(gsmModule) {
+    : gps(gpsModule), gsm(gsmModule),
+      uploads(RetryPolicy(HTTP_RETRY_DELAY, UPLOAD_BACKOFF_MAX, UPLOAD_BREAKER_THRESHOLD, UPLOAD_BREAKER_COOLDOWN)),
+      sampling(defaultSampling),
+      alerts(SMS_ALERT_INTERVAL, ALERT_RATE_BURST, ALERT_SMS_ATTEMPTS, ALERT_SMS_RETRY_DELAY),
+      motion(defaultMotion) {
     
     // Initialize status
     status.state = TRACKER_INITIALIZING;
@@ -21,9 +55,10 @@ BikeTrackerCore::BikeTrackerCore(Neo6mGPS &gpsModule, Sim800L &gsmModule)
     // Initialize configuration
     emergencyContact = EMERGENCY_CONTACT;
     isTrackerArmed = false;
-    geofenceLat = 0.0;
-    geofenceLon = 0.0;
-    geofenceRadius = 1000.0; // 1km default
+    homeZone = -1;
+    lastExitedZone = -1;
+    geofenceCheckedAt = 0;
+    geofences.setEventCallback(onZoneEvent, this);
     speedLimit = MAX_SPEED_THRESHOLD;
     webAPIUrl = "";
     deviceId = "";
@@ -32,21 +67,48 @@ BikeTrackerCore::BikeTrackerCore(Neo6mGPS &gpsModule, Sim800L &gsmModule)
     
     // Initialize timing
     lastGPSUpdate = 0;
-    lastSMSAlert = 0;
-    lastStatusCheck = 0;
-    lastHTTPUpdate = 0;
     
     // Initialize state tracking
     motionDetected = false;
-    previousLat = 0.0;
-    previousLon = 0.0;
+    previousLat = 0;
+    previousLon = 0;
+    motionFixCount = 0;
     isInGeofence = true;
     
+    // Web API uploads
+    offlineLoadSequence = 0;
+    sampledFixCount = 0;
+    connectionCheckPending = false;
+    registrationPending = false;
+    bearerConfigured = false;
+    uploadBlinkPending = false;
+    gsmActivityPending = false;
+    
     // Initialize power management
     lowPowerMode = false;
     lastActivity = millis();
     sleepDuration = 300000; // Default 5 minutes
     shouldSleep = false;
+    sleeping = false;
+    sleepStart = 0;
+    
+    // Scheduler tasks; the background ones start in initialize()
+    blinkToggles = 0;
+    blinkOn = false;
+    fixWaitStart = 0;
+    scheduler.define(TASK_GPS, "gps", onTask, this, 0);
+    scheduler.define(TASK_GSM, "gsm", onTask, this, 0);
+    scheduler.define(TASK_GSM_CHECK, "gsm check", onTask, this, 30000);     // Every 30 seconds
+    scheduler.define(TASK_CONNECTION, "connection", onTask, this, CONNECTION_CHECK_INTERVAL);
+    scheduler.define(TASK_MONITOR, "monitor", onTask, this, MONITOR_INTERVAL);
+    scheduler.define(TASK_UPLOADS, "uploads", onTask, this, 0);
+    scheduler.define(TASK_POWER, "power", onTask, this, 5000);              // Every 5 seconds
+    scheduler.define(TASK_FIX_WAIT, "fix wait", onTask, this, 1000);
+    scheduler.define(TASK_ALERT_END, "alert end", onTask, this, 0, false);
+    scheduler.define(TASK_BLINK, "blink", onTask, this, 200);
+    scheduler.define(TASK_BUZZER, "buzzer", onTask, this, 0, false);
+    scheduler.define(TASK_STATUS_LED, "status led", onTask, this, 100);
+    scheduler.define(TASK_SLEEP, "sleep", onTask, this, 5000);              // Every 5 seconds while asleep
 }
 
 bool BikeTrackerCore::initialize() {
@@ -59,14 +121,56 @@ bool BikeTrackerCore::initialize() {
     // Signal initialization start
     blinkStatusLED(3);
     
-    // Initialize GPS
+    // Last negotiated link rates, the power-up defaults otherwise
+    linkSettings.load();
+    long gpsBaud = linkSettings.gpsBaud;
+    long gsmBaud = linkSettings.gsmBaud;
+    
+    // Reports left unsent before the last reset or deep sleep
+    if (PH_OFFLINE_STORAGE_ENABLED) {
+        if (offlineLog.begin()) {
+            offlineLoadSequence = offlineLog.first();
+            DEBUG_PRINT("Offline reports waiting: ");
+            DEBUG_PRINTLN(offlineLog.pending());
+        } else {
+            DEBUG_PRINTLN("Offline storage unavailable, reports kept in RAM only");
+        }
+    }
+    
+    // Initialize GPS at the fastest rate the link sustains
     DEBUG_PRINTLN("Initializing GPS...");
-    gps.begin(9600);
-    delay(2000);
+    if (BAUD_NEGOTIATION_ENABLED) {
+        long negotiated = gps.negotiateBaud(gpsBaud, linkBaudRates, linkBaudRateCount);
+        if (negotiated > 0) {
+            gpsBaud = negotiated;
+        }
+        DEBUG_PRINT("GPS baud: ");
+        DEBUG_PRINTLN(gpsBaud);
+    }
+    gps.begin(gpsBaud, GPS_UBX_PROTOCOL ? GPS_PROTOCOL_UBX : GPS_PROTOCOL_NMEA);
+    startTasks();
+    serviceDelay(2000);
     
-    // Initialize GSM
+    // Initialize GSM, keeping the GPS port drained while it blocks
     DEBUG_PRINTLN("Initializing GSM...");
-    gsm.begin(9600);
+    gsm.setIdleCallback(serviceIdle, this);
+    gsm.setEventCallback(onGSMEvent, this);
+    gsm.setBodyCompression(PH_CONTENT_ENCODING_ENABLED);
+    gsm.begin(gsmBaud);
+    if (BAUD_NEGOTIATION_ENABLED) {
+        long negotiated = gsm.negotiateBaud(gsmBaud, linkBaudRates, linkBaudRateCount);
+        if (negotiated > 0) {
+            gsmBaud = negotiated;
+        }
+        DEBUG_PRINT("GSM baud: ");
+        DEBUG_PRINTLN(gsmBaud);
+    }
+    
+    if (gpsBaud != linkSettings.gpsBaud || gsmBaud != linkSettings.gsmBaud) {
+        linkSettings.gpsBaud = gpsBaud;
+        linkSettings.gsmBaud = gsmBaud;
+        linkSettings.save();
+    }
     
     // Wait for GSM initialization
     for (int i = 0; i < 10; i++) {
@@ -77,7 +181,7 @@ bool BikeTrackerCore::initialize() {
         }
         DEBUG_PRINT("GSM init attempt ");
         DEBUG_PRINTLN(i + 1);
-        delay(2000);
+        serviceDelay(2000);
     }
     
     if (!status.gsmConnected) {
@@ -86,21 +190,30 @@ bool BikeTrackerCore::initialize() {
         return false;
     }
     
-    // Wait for GPS fix
+    // The first fix is waited for in the background
     DEBUG_PRINTLN("Waiting for GPS fix...");
-    unsigned long gpsStartTime = millis();
-    while (millis() - gpsStartTime < 60000) { // 1 minute timeout
-        updateGPS();
-        if (status.gpsFixed) {
-            DEBUG_PRINTLN("GPS fix acquired");
-            break;
-        }
-        blinkStatusLED(1);
-        delay(1000);
-    }
-    
+    fixWaitStart = millis();
+    scheduler.start(TASK_FIX_WAIT);
+    return true;
+}
+
+void BikeTrackerCore::startTasks() {
+    scheduler.start(TASK_GPS);
+    scheduler.start(TASK_GSM);
+    scheduler.start(TASK_GSM_CHECK, 30000);
+    scheduler.start(TASK_CONNECTION, CONNECTION_CHECK_INTERVAL);
+    scheduler.start(TASK_MONITOR);
+    scheduler.start(TASK_UPLOADS);
+    scheduler.start(TASK_POWER, 5000);
+    scheduler.start(TASK_STATUS_LED);
+}
+
+void BikeTrackerCore::waitForFix() {
     if (status.gpsFixed) {
-        status.state = TRACKER_STANDBY;
+        scheduler.stop(TASK_FIX_WAIT);
+        if (status.state == TRACKER_INITIALIZING) {
+            status.state = TRACKER_STANDBY;
+        }
         DEBUG_PRINTLN("BikeTracker initialized successfully");
         
         // Send initialization SMS in testing mode
@@ -111,110 +224,169 @@ bool BikeTrackerCore::initialize() {
         // Signal successful initialization
         blinkStatusLED(5);
         activateBuzzer(100);
-        
-        return true;
-    } else {
-        status.state = TRACKER_ERROR;
+    } else if (millis() - fixWaitStart >= GPS_FIX_WAIT_TIMEOUT) {
+        scheduler.stop(TASK_FIX_WAIT);
+        if (status.state == TRACKER_INITIALIZING) {
+            status.state = TRACKER_ERROR;
+        }
         DEBUG_PRINTLN("GPS fix not acquired - continuing without GPS");
         
         // Signal GPS error but continue
-        for (int i = 0; i < 3; i++) {
-            blinkStatusLED(2);
-            delay(500);
-        }
-        
-        return true; // Continue operation without GPS for now
+        blinkStatusLED(6);
+    } else {
+        blinkStatusLED(1);
     }
 }
 
 void BikeTrackerCore::update() {
     status.uptime = millis();
     
-    // Update modules
-    updateGPS();
-    updateGSM();
+    // One pass over the tasks; none of them blocks
+    scheduler.run();
     
-    // Enhanced connection monitoring
-    if (httpEnabled && CONNECTION_MONITORING_ENABLED) {
-        static unsigned long lastConnectionCheck = 0;
-        if (millis() - lastConnectionCheck > CONNECTION_CHECK_INTERVAL) {
-            lastConnectionCheck = millis();
+    // Check if sleep mode should be activated
+    if (shouldSleep && !sleeping && !isTrackerArmed && lowPowerMode) {
+        enterSleepMode(sleepDuration);
+    }
+}
+
+void BikeTrackerCore::onTask(void *context, uint8_t task) {
+    BikeTrackerCore *core = (BikeTrackerCore *)context;
+    
+    switch (task) {
+        case TASK_GPS:
+            core->updateGPS();
+            break;
+        
+        case TASK_GSM:
+            core->gsm.update();
+            break;
+        
+        case TASK_GSM_CHECK:
+            core->updateGSM();
+            break;
+        
+        case TASK_CONNECTION:
+            core->checkConnection();
+            break;
+        
+        case TASK_MONITOR:
+            // Security monitoring (only when armed)
+            if (core->isTrackerArmed) {
+                core->checkMotion();
+                core->checkSpeed();
+                core->checkGeofence();
+            }
+            core->processAlerts();
             
-            // Check GPRS connection health
-            if (!gsm.isGPRSConnected()) {
-                DEBUG_PRINTLN("GPRS connection lost, attempting reconnection...");
-                if (gsm.reconnectGPRS()) {
-                    DEBUG_PRINTLN("GPRS reconnection successful");
-                } else {
-                    DEBUG_PRINTLN("GPRS reconnection failed");
+            // Queue location reports for the web API (if enabled)
+            if (core->httpEnabled) {
+                core->sampleLocation();
+            }
+            break;
+        
+        case TASK_UPLOADS:
+            // Web API reports queued or waiting to retry
+            core->serviceUploads();
+            if (core->uploadBlinkPending) {
+                core->uploadBlinkPending = false;
+                core->blinkStatusLED(1); // Quick blink on successful upload
+            }
+            break;
+        
+        case TASK_POWER:
+            // Check for sleep conditions
+            if (!core->isTrackerArmed && core->lowPowerMode) {
+                if (millis() - core->lastActivity > core->sleepDuration) {
+                    core->shouldSleep = true;
                 }
             }
             
-            // Check for inactive connections
-            unsigned long inactiveTime = millis() - gsm.getLastDataActivity();
-            if (inactiveTime > CONNECTION_TIMEOUT) {
-                DEBUG_PRINTLN("Connection inactive for too long, resetting...");
-                gsm.resetConnection();
+            // Update activity tracking
+            if (core->status.gpsFixed || core->status.gsmConnected) {
+                core->updateActivityTime();
             }
-        }
-    }
-    
-    // Check system state and power management
-    if (millis() - lastStatusCheck > 5000) { // Check every 5 seconds
-        lastStatusCheck = millis();
+            break;
         
-        // Check for sleep conditions
-        if (!isTrackerArmed && lowPowerMode) {
-            unsigned long inactiveTime = millis() - lastActivity;
-            if (inactiveTime > sleepDuration) {
-                shouldSleep = true;
+        case TASK_FIX_WAIT:
+            core->waitForFix();
+            break;
+        
+        case TASK_ALERT_END:
+            // Return to tracking state after alert
+            if (core->status.state == TRACKER_ALERT) {
+                core->status.state = core->isTrackerArmed ? TRACKER_TRACKING : TRACKER_STANDBY;
             }
-        }
+            break;
         
-        // Update activity tracking
-        if (status.gpsFixed || status.gsmConnected) {
-            updateActivityTime();
-        }
-    }
-    
-    // Security monitoring (only when armed)
-    if (isTrackerArmed) {
-        checkMotion();
-        checkSpeed();
-        checkGeofence();
+        case TASK_BLINK:
+            core->blinkOn = !core->blinkOn;
+            digitalWrite(LED_STATUS_PIN, core->blinkOn ? HIGH : LOW);
+            if (--core->blinkToggles == 0) {
+                core->scheduler.stop(TASK_BLINK);
+            }
+            break;
+        
+        case TASK_BUZZER:
+            digitalWrite(BUZZER_PIN, LOW);
+            break;
+        
+        case TASK_STATUS_LED:
+            // Patterns own the LED while they run
+            if (core->scheduler.isActive(TASK_BLINK)) {
+                break;
+            }
+            if (core->status.state == TRACKER_STANDBY || core->status.state == TRACKER_TRACKING) {
+                digitalWrite(LED_STATUS_PIN, (millis() / 1000) % 2); // Slow blink when normal
+            } else if (core->status.state == TRACKER_ALERT) {
+                digitalWrite(LED_STATUS_PIN, (millis() / 200) % 2); // Fast blink when alert
+            } else {
+                digitalWrite(LED_STATUS_PIN, LOW); // Off when error
+            }
+            break;
+        
+        case TASK_SLEEP:
+            core->updateSleep();
+            break;
     }
-    
-    // Process any pending alerts
-    processAlerts();
-    
-    // Send location updates to web API (if enabled)
-    if (httpEnabled && status.gpsFixed) {
-        sendLocationToAPI();
+}
+
+void BikeTrackerCore::checkConnection() {
+    // Enhanced connection monitoring, queued behind any modem work
+    if (!httpEnabled || !CONNECTION_MONITORING_ENABLED || connectionCheckPending) {
+        return;
     }
     
-    // Check if sleep mode should be activated
-    if (shouldSleep && !isTrackerArmed && lowPowerMode) {
-        enterSleepMode(sleepDuration);
-        return; // Exit update cycle during sleep
+    // Bearer never set up (GSM was down in setWebAPI), try that first
+    if (!bearerConfigured) {
+        queueBearerSetup();
+        return;
     }
     
-    // Update status LED
-    if (status.state == TRACKER_STANDBY || status.state == TRACKER_TRACKING) {
-        digitalWrite(LED_STATUS_PIN, (millis() / 1000) % 2); // Slow blink when normal
-    } else if (status.state == TRACKER_ALERT) {
-        digitalWrite(LED_STATUS_PIN, (millis() / 200) % 2); // Fast blink when alert
+    // Check for inactive connections
+    unsigned long inactiveTime = millis() - gsm.getLastDataActivity();
+    if (inactiveTime > CONNECTION_TIMEOUT) {
+        DEBUG_PRINTLN("Connection inactive for too long, resetting...");
+        connectionCheckPending = gsm.queueConnectionReset(onConnectionChecked, this);
     } else {
-        digitalWrite(LED_STATUS_PIN, LOW); // Off when error
+        // Check GPRS connection health, reconnecting if needed
+        connectionCheckPending = gsm.queueConnectionCheck(onConnectionChecked, this);
     }
 }
 
 void BikeTrackerCore::updateGPS() {
+    // Ingest on every pass; the interval below only paces how often the
+    // tracker looks at the published fix
+    gps.poll();
+    feedMotion();
+    
     if (millis() - lastGPSUpdate > GPS_UPDATE_INTERVAL) {
         lastGPSUpdate = millis();
         
-        GPSData gpsData = gps.parseGPSData();
+        GPSData gpsData = gps.getLatestFix();
+        bool fresh = gps.getFixCount() > 0 && millis() - gps.getLatestFixTime() <= GPS_FIX_MAX_AGE;
         
-        if (gpsData.isValid) {
+        if (gpsData.isValid && fresh) {
             if (!status.gpsFixed) {
                 status.gpsFixed = true;
                 DEBUG_PRINTLN("GPS fix acquired");
@@ -222,18 +394,14 @@ void BikeTrackerCore::updateGPS() {
             }
             
             status.lastSpeed = gpsData.speed;
-            status.lastLocation = String(gpsData.latitude, 6) + "," + String(gpsData.longitude, 6);
-            
-            // Store previous position for motion detection
-            if (previousLat != 0.0 && previousLon != 0.0) {
-                float distance = calculateDistance(previousLat, previousLon, gpsData.latitude, gpsData.longitude);
-                if (distance > MOTION_THRESHOLD) {
-                    motionDetected = true;
-                }
-            }
+            char lat[COORDINATE_TEXT_SIZE];
+            char lon[COORDINATE_TEXT_SIZE];
+            formatCoordinate(gpsData.latitudeE7, lat);
+            formatCoordinate(gpsData.longitudeE7, lon);
+            status.lastLocation = String(lat) + "," + String(lon);
             
-            previousLat = gpsData.latitude;
-            previousLon = gpsData.longitude;
+            previousLat = gpsData.latitudeE7;
+            previousLon = gpsData.longitudeE7;
             
             DEBUG_PRINT("GPS: ");
             DEBUG_PRINT(status.lastLocation);
@@ -241,6 +409,9 @@ void BikeTrackerCore::updateGPS() {
             DEBUG_PRINTLN(status.lastSpeed);
             
         } else {
+            // No usable epoch: never let checkSpeed() act on a stale speed
+            status.lastSpeed = 0.0;
+            
             if (status.gpsFixed) {
                 DEBUG_PRINTLN("GPS fix lost");
                 status.gpsFixed = false;
@@ -258,31 +429,34 @@ void BikeTrackerCore::updateGPS() {
 }
 
 void BikeTrackerCore::updateGSM() {
-    // Check GSM status periodically
-    static unsigned long lastGSMCheck = 0;
+    // Runs every 30 seconds as TASK_GSM_CHECK
     static unsigned long gsmLostTime = 0;
     
-    if (millis() - lastGSMCheck > 30000) { // Check every 30 seconds
-        lastGSMCheck = millis();
-        
-        bool previousConnection = status.gsmConnected;
-        status.gsmConnected = gsm.isNetworkConnected();
+    bool previousConnection = status.gsmConnected;
+    status.gsmConnected = gsm.isNetworkConnected();
+    
+    if (!status.gsmConnected) {
+        DEBUG_PRINTLN("GSM network lost - attempting reconnection");
+        queueRegistration();
         
-        if (!status.gsmConnected) {
-            DEBUG_PRINTLN("GSM network lost - attempting reconnection");
-            gsm.initialize();
-            
-            // Track how long GSM has been lost
-            if (previousConnection) {
-                gsmLostTime = millis(); // Just lost connection
-            } else if (millis() - gsmLostTime > 600000) { // 10 minutes without GSM
-                // Can't send alert via SMS if GSM is down, but log it
-                DEBUG_PRINTLN("ALERT: GSM connection lost for extended period");
-                gsmLostTime = millis(); // Reset timer to prevent spam
-            }
-        } else {
-            gsmLostTime = 0; // Reset timer when connection is restored
+        // Track how long GSM has been lost
+        if (previousConnection) {
+            gsmLostTime = millis(); // Just lost connection
+        } else if (millis() - gsmLostTime > 600000) { // 10 minutes without GSM
+            // Can't send alert via SMS if GSM is down, but log it
+            DEBUG_PRINTLN("ALERT: GSM connection lost for extended period");
+            gsmLostTime = millis(); // Reset timer to prevent spam
         }
+    } else {
+        gsmLostTime = 0; // Reset timer when connection is restored
+    }
+}
+
+void BikeTrackerCore::queueRegistration() {
+    // Runs as a modem job, so the scheduler keeps going while the modem
+    // answers or while the job waits behind an upload
+    if (!registrationPending) {
+        registrationPending = gsm.queueRegistration(onRegistrationChecked, this);
     }
 }
 
@@ -303,13 +477,20 @@ void BikeTrackerCore::checkSpeed() {
 }
 
 void BikeTrackerCore::checkGeofence() {
-    if (status.gpsFixed && geofenceLat != 0.0 && geofenceLon != 0.0) {
-        float distance = calculateDistance(previousLat, previousLon, geofenceLat, geofenceLon);
-        bool currentlyInFence = (distance <= geofenceRadius);
+    // Once per fix; the engine only tests the zones near it
+    if (status.gpsFixed && geofences.count() > 0 && geofenceCheckedAt != lastGPSUpdate) {
+        geofenceCheckedAt = lastGPSUpdate;
+        geofences.update(previousLat, previousLon, millis());
+        bool currentlyInFence = geofences.isInsideAny();
         
         if (isInGeofence && !currentlyInFence) {
             DEBUG_PRINTLN("Geofence breach detected!");
-            triggerAlert(ALERT_GEOFENCE_BREACH, "Vehicle left safe area");
+            String message = "Vehicle left safe area";
+            if (lastExitedZone >= 0 && geofences.name(lastExitedZone)[0] != '\0') {
+                message += ": ";
+                message += geofences.name(lastExitedZone);
+            }
+            triggerAlert(ALERT_GEOFENCE_BREACH, message);
             isInGeofence = false;
         } else if (!isInGeofence && currentlyInFence) {
             DEBUG_PRINTLN("Vehicle returned to safe area");
@@ -319,54 +500,28 @@ void BikeTrackerCore::checkGeofence() {
 }
 
 void BikeTrackerCore::triggerAlert(AlertType type, const String &message) {
-    if (millis() - lastSMSAlert < SMS_ALERT_INTERVAL) {
-        return; // Prevent SMS spam
+    // Only queued here; processAlerts() sends it. Repeats of an alert that
+    // is still waiting are merged into it, and each type is rate limited.
+    int32_t lat = status.gpsFixed ? previousLat : 0;
+    int32_t lon = status.gpsFixed ? previousLon : 0;
+    AlertRaise result = alerts.raise(type, message.c_str(), lat, lon, emergencyContact.length() > 0,
+                                     httpEnabled, millis());
+    if (result != ALERT_QUEUED) {
+        return; // Counted in getAlertStats()
     }
     
     status.state = TRACKER_ALERT;
     status.alertsCount++;
-    lastSMSAlert = millis();
-    
-    String alertTypeStr;
-    switch (type) {
-        case ALERT_MOTION_DETECTED: alertTypeStr = "MOTION ALERT"; break;
-        case ALERT_SPEED_EXCEEDED: alertTypeStr = "SPEED ALERT"; break;
-        case ALERT_GEOFENCE_BREACH: alertTypeStr = "GEOFENCE ALERT"; break;
-        case ALERT_SYSTEM_ERROR: alertTypeStr = "SYSTEM ERROR"; break;
-        case ALERT_GPS_LOST: alertTypeStr = "GPS LOST"; break;
-        case ALERT_GSM_LOST: alertTypeStr = "GSM LOST"; break;
-        default: alertTypeStr = "GENERAL ALERT"; break;
-    }
     
     DEBUG_PRINT("ALERT: ");
-    DEBUG_PRINTLN(alertTypeStr);
+    DEBUG_PRINTLN(AlertQueue::typeName(type));
     DEBUG_PRINTLN(message);
     
-    // Send SMS alert
-    if (status.gsmConnected) {
-        String fullMessage = alertTypeStr;
-        if (message.length() > 0) {
-            fullMessage += "\n" + message;
-        }
-        fullMessage += "\nLocation: " + getCurrentLocation();
-        fullMessage += "\nTime: " + String(millis() / 1000) + "s uptime";
-        
-        gsm.sendSMS(emergencyContact, fullMessage);
-    }
-    
-    // Send alert to web API
-    sendAlertToAPI(type, message);
-    
     // Activate buzzer
     activateBuzzer(1000);
     
-    // Return to tracking state after alert
-    delay(2000);
-    if (isTrackerArmed) {
-        status.state = TRACKER_TRACKING;
-    } else {
-        status.state = TRACKER_STANDBY;
-    }
+    // Return to tracking state after alert (TASK_ALERT_END)
+    scheduler.start(TASK_ALERT_END, 2000);
 }
 
 void BikeTrackerCore::armTracker() {
@@ -374,8 +529,9 @@ void BikeTrackerCore::armTracker() {
     status.state = TRACKER_STANDBY;
     DEBUG_PRINTLN("Tracker ARMED");
     
-    // Reset motion detection baseline
+    // Reset motion detection baseline; the next fixes build a new anchor
     motionDetected = false;
+    motion.reset();
     
     // Send confirmation
     if (CURRENT_MODE == MODE_TESTING && status.gsmConnected) {
@@ -412,20 +568,69 @@ void BikeTrackerCore::setEmergencyContact(const String &number) {
     DEBUG_PRINTLN(emergencyContact);
 }
 
-void BikeTrackerCore::setGeofenceCenter(float lat, float lon, float radius) {
-    geofenceLat = lat;
-    geofenceLon = lon;
-    geofenceRadius = radius;
-    isInGeofence = true; // Assume we start inside the fence
+void BikeTrackerCore::setGeofenceCenter(int32_t latE7, int32_t lonE7, float radius) {
+    if (homeZone >= 0) {
+        geofences.remove(homeZone);
+    }
+    homeZone = addGeofenceCircle("home", latE7, lonE7, radius);
     
+    char coordinate[COORDINATE_TEXT_SIZE];
     DEBUG_PRINT("Geofence set: ");
-    DEBUG_PRINT(String(lat, 6));
+    formatCoordinate(latE7, coordinate);
+    DEBUG_PRINT(coordinate);
     DEBUG_PRINT(", ");
-    DEBUG_PRINT(String(lon, 6));
+    formatCoordinate(lonE7, coordinate);
+    DEBUG_PRINT(coordinate);
     DEBUG_PRINT(" radius: ");
     DEBUG_PRINTLN(radius);
 }
 
+int8_t BikeTrackerCore::addGeofenceCircle(const char *name, int32_t latE7, int32_t lonE7, float radius,
+                                          unsigned long dwellTime) {
+    if (geofences.count() == 0) {
+        isInGeofence = true; // Assume we start inside the fence
+    }
+    int8_t zone = geofences.addCircle(name, latE7, lonE7, radius, dwellTime);
+    if (zone < 0) {
+        DEBUG_PRINTLN("Geofence table full, zone not added");
+    }
+    return zone;
+}
+
+int8_t BikeTrackerCore::addGeofencePolygon(const char *name, const int32_t *latsE7, const int32_t *lonsE7,
+                                           uint8_t count, unsigned long dwellTime) {
+    if (geofences.count() == 0) {
+        isInGeofence = true;
+    }
+    int8_t zone = geofences.addPolygon(name, latsE7, lonsE7, count, dwellTime);
+    if (zone < 0) {
+        DEBUG_PRINTLN("Geofence table or vertex pool full, zone not added");
+    }
+    return zone;
+}
+
+bool BikeTrackerCore::removeGeofence(uint8_t zone) {
+    if (zone == homeZone) {
+        homeZone = -1;
+    }
+    return geofences.remove(zone);
+}
+
+const GeofenceStats &BikeTrackerCore::getGeofenceStats() {
+    return geofences.getStats();
+}
+
+void BikeTrackerCore::onZoneEvent(void *context, uint8_t zone, ZoneEventType event) {
+    BikeTrackerCore *core = (BikeTrackerCore *)context;
+    if (event == ZONE_EXIT) {
+        core->lastExitedZone = zone;
+    }
+    DEBUG_PRINT("Zone ");
+    DEBUG_PRINT(core->geofences.name(zone));
+    DEBUG_PRINT(": ");
+    DEBUG_PRINTLN(GeofenceEngine::eventName(event));
+}
+
 void BikeTrackerCore::setSpeedLimit(float maxSpeed) {
     speedLimit = maxSpeed;
     DEBUG_PRINT("Speed limit set to: ");
@@ -483,6 +688,114 @@ void BikeTrackerCore::runDiagnostics() {
     DEBUG_PRINTLN(status.gsmConnected ? "OK" : "FAIL");
     DEBUG_PRINT("Signal Strength: ");
     DEBUG_PRINTLN(gsm.getSignalStrength());
+    const SerialTransportStats &gsmLink = gsm.getLinkStats();
+    DEBUG_PRINT("GSM link: ");
+    DEBUG_PRINT(gsmLink.bytesReceived);
+    DEBUG_PRINT(" B in, ");
+    DEBUG_PRINT(gsmLink.bytesSent);
+    DEBUG_PRINT(" B out, overflows: ");
+    DEBUG_PRINTLN(gsmLink.overflows);
+    const GSMBearerStats &bearer = gsm.getBearerStats();
+    DEBUG_PRINT("GPRS bearer probes: ");
+    DEBUG_PRINT(bearer.probes);
+    DEBUG_PRINT(", answered from cache: ");
+    DEBUG_PRINTLN(bearer.probesAvoided);
+    const UploadQueueStats &uploadStats = uploads.getStats();
+    DEBUG_PRINT("Upload queue: ");
+    DEBUG_PRINT(uploads.count());
+    DEBUG_PRINT(" waiting, ");
+    DEBUG_PRINT(uploadStats.sent);
+    DEBUG_PRINT(" sent, ");
+    DEBUG_PRINT(uploadStats.dropped + uploadStats.evicted);
+    DEBUG_PRINT(" lost, breaker ");
+    DEBUG_PRINTLN(uploads.getPolicy().getState() == BREAKER_CLOSED ? "closed" : "open");
+    if (offlineLog.isReady()) {
+        const OfflineLogStats &logStats = offlineLog.getStats();
+        DEBUG_PRINT("Offline log: ");
+        DEBUG_PRINT(offlineLog.pending());
+        DEBUG_PRINT(" pending, ");
+        DEBUG_PRINT(logStats.overwritten);
+        DEBUG_PRINT(" overwritten, ");
+        DEBUG_PRINT(logStats.corrupted);
+        DEBUG_PRINT(" corrupted, ");
+        DEBUG_PRINT(logStats.reloads);
+        DEBUG_PRINT(" reloaded, ");
+        DEBUG_PRINT(logStats.abandoned);
+        DEBUG_PRINTLN(" abandoned");
+    }
+    const SamplingStats &sampleStats = sampling.getStats();
+    DEBUG_PRINT("Sampling: ");
+    DEBUG_PRINT(sampleStats.evaluated);
+    DEBUG_PRINT(" fixes,");
+    for (int reason = SAMPLE_FIRST; reason < SAMPLE_REASONS; reason++) {
+        DEBUG_PRINT(" ");
+        DEBUG_PRINT(SamplingPolicy::reasonName((SampleReason)reason));
+        DEBUG_PRINT(" ");
+        DEBUG_PRINT(sampleStats.recorded[reason]);
+    }
+    DEBUG_PRINT(", parked ");
+    DEBUG_PRINT(sampleStats.parkedPeriods);
+    DEBUG_PRINTLN(sampling.isParked() ? " times (now parked)" : " times");
+    const MotionStats &motionStats = motion.getStats();
+    DEBUG_PRINT("Motion: ");
+    DEBUG_PRINT(motionStats.fixes);
+    DEBUG_PRINT(" fixes, ");
+    DEBUG_PRINT(motionStats.rejected);
+    DEBUG_PRINT(" rejected, ");
+    DEBUG_PRINT(motionStats.displaced);
+    DEBUG_PRINT(" displaced, ");
+    DEBUG_PRINT(motionStats.detections);
+    DEBUG_PRINT(" detections (");
+    DEBUG_PRINT(motionStats.corroborated);
+    DEBUG_PRINTLN(" by speed)");
+    const AlertQueueStats &alertStats = alerts.getStats();
+    DEBUG_PRINT("Alerts: ");
+    DEBUG_PRINT(alerts.count());
+    DEBUG_PRINT(" queued, ");
+    DEBUG_PRINT(alertStats.smsMessages);
+    DEBUG_PRINT(" SMS sent, ");
+    DEBUG_PRINT(alertStats.coalesced);
+    DEBUG_PRINTLN(" alerts coalesced");
+    for (int type = ALERT_MOTION_DETECTED; type < ALERT_TYPES; type++) {
+        const AlertTypeStats &typeStats = alertStats.types[type];
+        if (typeStats.raised == 0) {
+            continue;
+        }
+        DEBUG_PRINT("  ");
+        DEBUG_PRINT(AlertQueue::typeName((AlertType)type));
+        DEBUG_PRINT(": raised ");
+        DEBUG_PRINT(typeStats.raised);
+        DEBUG_PRINT(", merged ");
+        DEBUG_PRINT(typeStats.merged);
+        DEBUG_PRINT(", limited/dropped ");
+        DEBUG_PRINT(typeStats.rateLimited + typeStats.dropped);
+        DEBUG_PRINT(", SMS ");
+        DEBUG_PRINT(typeStats.smsSent);
+        DEBUG_PRINT("/");
+        DEBUG_PRINT(typeStats.smsFailed);
+        DEBUG_PRINT(" sent/failed, API ");
+        DEBUG_PRINT(typeStats.apiSent);
+        DEBUG_PRINT("/");
+        DEBUG_PRINTLN(typeStats.apiFailed);
+    }
+    const GeofenceStats &fenceStats = geofences.getStats();
+    DEBUG_PRINT("Geofence: ");
+    DEBUG_PRINT(geofences.count());
+    DEBUG_PRINT(" zones, ");
+    DEBUG_PRINT(fenceStats.updates);
+    DEBUG_PRINT(" fixes tested, ");
+    DEBUG_PRINT(fenceStats.updates > 0 ? String((float)fenceStats.zoneTests / fenceStats.updates, 1) : String("0"));
+    DEBUG_PRINT(" zones per fix, ");
+    DEBUG_PRINT(fenceStats.events);
+    DEBUG_PRINTLN(" events");
+    const SchedulerStats &schedulerStats = scheduler.getStats();
+    DEBUG_PRINT("Loop latency (worst): ");
+    DEBUG_PRINT(schedulerStats.maxLoopLatency / 1000);
+    DEBUG_PRINT(" ms, slowest task: ");
+    DEBUG_PRINT(scheduler.taskName(schedulerStats.slowestTask));
+    DEBUG_PRINT(" ");
+    DEBUG_PRINT(schedulerStats.maxTaskTime / 1000);
+    DEBUG_PRINTLN(" ms");
     
     // Test components
     DEBUG_PRINTLN("Testing LED...");
@@ -501,40 +814,155 @@ void BikeTrackerCore::simulateAlert(AlertType type) {
     triggerAlert(type, "Test alert - ignore");
 }
 
-void BikeTrackerCore::processAlerts() {
-    // Process any pending alerts or state changes
-    // This function can be expanded for more complex alert handling
-}
-
-float BikeTrackerCore::calculateDistance(float lat1, float lon1, float lat2, float lon2) {
-    // Haversine formula for calculating distance between two GPS coordinates
-    const float R = 6371000; // Earth's radius in meters
+void BikeTrackerCore::runLinkBenchmark() {
+    if (CURRENT_MODE != MODE_TESTING) return;
     
-    float dLat = (lat2 - lat1) * PI / 180.0;
-    float dLon = (lon2 - lon1) * PI / 180.0;
+    DEBUG_PRINTLN("=== LINK BENCHMARK START ===");
     
-    float a = sin(dLat / 2) * sin(dLat / 2) +
-              cos(lat1 * PI / 180.0) * cos(lat2 * PI / 180.0) *
-              sin(dLon / 2) * sin(dLon / 2);
+    for (uint8_t i = 0; i < linkBaudRateCount; i++) {
+        long rate = linkBaudRates[i];
+        DEBUG_PRINT("--- ");
+        DEBUG_PRINT(rate);
+        DEBUG_PRINTLN(" baud ---");
+        
+        // GSM: mean AT round trip
+        DEBUG_PRINT("GSM AT latency: ");
+        if (gsm.setModemBaud(rate) && gsm.verifyBaud(GSM_BAUD_VERIFY_ROUNDS)) {
+            DEBUG_PRINT(gsm.measureATLatency(20));
+            DEBUG_PRINTLN(" us");
+        } else {
+            DEBUG_PRINTLN("FAIL (link unreliable)");
+            gsm.findBaud(linkSettings.gsmBaud, linkBaudRates, linkBaudRateCount);
+        }
+        
+        // GPS: NMEA/UBX throughput and how much of each second the line is busy
+        unsigned long duration = 5000;
+        unsigned long bytes, frames, errors;
+        gps.setReceiverBaud(rate);
+        gps.measureLink(duration, bytes, frames, errors);
+        DEBUG_PRINT("GPS throughput: ");
+        DEBUG_PRINT(bytes * 1000 / duration);
+        DEBUG_PRINT(" B/s, ");
+        DEBUG_PRINT(String(frames * 1000.0 / duration, 1));
+        DEBUG_PRINT(" sentences/s, errors: ");
+        DEBUG_PRINT(errors);
+        DEBUG_PRINT(", line busy: ");
+        DEBUG_PRINT(bytes * 10 * 1000 / rate / (duration / 1000));
+        DEBUG_PRINTLN(" ms/s");
+    }
+    
+    // Back to the negotiated rates
+    if (!gsm.setModemBaud(linkSettings.gsmBaud) || !gsm.verifyBaud(GSM_BAUD_VERIFY_ROUNDS)) {
+        gsm.findBaud(linkSettings.gsmBaud, linkBaudRates, linkBaudRateCount);
+    }
+    gps.setReceiverBaud(linkSettings.gpsBaud);
     
-    float c = 2 * atan2(sqrt(a), sqrt(1 - a));
+    DEBUG_PRINTLN("=== LINK BENCHMARK END ===");
+}
+
+void BikeTrackerCore::processAlerts() {
+    // SMS sink: one message at a time, coalescing what is waiting
+    if (status.gsmConnected) {
+        AlertEvent *batch[ALERT_QUEUE_SIZE];
+        uint8_t count = alerts.takeSMS(batch, ALERT_QUEUE_SIZE, millis());
+        if (count > 0 && !gsm.queueSMS(emergencyContact, formatAlertSMS(batch, count), onAlertSMSDone, this)) {
+            // Job queue full, count it as a failed attempt
+            alerts.completeSMS(false, millis());
+        }
+    }
     
-    return R * c; // Distance in meters
+    // API sink: handed to the upload queue, settled in onUploadDone()
+    for (AlertEvent *event = alerts.takeAPI(); event != NULL; event = alerts.takeAPI()) {
+        if (!httpEnabled) {
+            alerts.completeAPI(event->id, DELIVERY_FAILED);
+            continue;
+        }
+        DEBUG_PRINT("Sending alert to web API: ");
+        DEBUG_PRINTLN(apiAlertName(event->type));
+        queueReport(event->latitudeE7, event->longitudeE7, event->type, event->id);
+    }
+}
+
+String BikeTrackerCore::formatAlertSMS(AlertEvent **batch, uint8_t count) {
+    // Every alert's heading and detail, then the latest position once
+    AlertEvent *latest = batch[0];
+    String text = "";
+    for (uint8_t i = 0; i < count; i++) {
+        AlertEvent *event = batch[i];
+        if (i > 0) {
+            text += "\n";
+        }
+        text += AlertQueue::typeName(event->type);
+        if (event->occurrences > 1) {
+            text += " (x" + String(event->occurrences) + ")";
+        }
+        if (event->message[0] != '\0') {
+            text += "\n";
+            text += event->message;
+        }
+        if ((long)(event->lastRaisedAt - latest->lastRaisedAt) > 0) {
+            latest = event;
+        }
+    }
+    
+    text += "\nLocation: ";
+    if (latest->latitudeE7 != 0 || latest->longitudeE7 != 0) {
+        char coordinate[COORDINATE_TEXT_SIZE];
+        formatCoordinate(latest->latitudeE7, coordinate);
+        text += coordinate;
+        text += ",";
+        formatCoordinate(latest->longitudeE7, coordinate);
+        text += coordinate;
+    } else {
+        text += "GPS fix not available";
+    }
+    text += "\nTime: " + String(latest->lastRaisedAt / 1000) + "s uptime";
+    return text;
+}
+
+const AlertQueueStats &BikeTrackerCore::getAlertStats() {
+    return alerts.getStats();
 }
 
 void BikeTrackerCore::blinkStatusLED(int times) {
-    for (int i = 0; i < times; i++) {
-        digitalWrite(LED_STATUS_PIN, HIGH);
-        delay(200);
-        digitalWrite(LED_STATUS_PIN, LOW);
-        delay(200);
+    // 200 ms on, 200 ms off, driven by TASK_BLINK; replaces any running pattern
+    if (times <= 0) {
+        return;
+    }
+    blinkOn = true;
+    blinkToggles = times * 2 - 1;
+    digitalWrite(LED_STATUS_PIN, HIGH);
+    if (blinkToggles > 0) {
+        scheduler.start(TASK_BLINK, 200);
+    }
+}
+
+void BikeTrackerCore::serviceDelay(unsigned long durationMs) {
+    // Like delay(), but keeps draining the GPS port so sentences are not
+    // dropped while we wait, and keeps queued modem jobs moving. The
+    // scheduler keeps running too, so LED and buzzer patterns and timers
+    // stay on time while the caller waits.
+    unsigned long startTime = millis();
+    while (millis() - startTime < durationMs) {
+        gps.poll();
+        gsm.update();
+        scheduler.run();
+        delay(durationMs < 10 ? durationMs : 10);
     }
 }
 
+const SchedulerStats &BikeTrackerCore::getSchedulerStats() {
+    return scheduler.getStats();
+}
+
+void BikeTrackerCore::serviceIdle(void *context) {
+    static_cast<BikeTrackerCore *>(context)->gps.poll();
+}
+
 void BikeTrackerCore::activateBuzzer(int duration) {
+    // Switched off again by TASK_BUZZER
     digitalWrite(BUZZER_PIN, HIGH);
-    delay(duration);
-    digitalWrite(BUZZER_PIN, LOW);
+    scheduler.start(TASK_BUZZER, duration);
 }
 
 void BikeTrackerCore::setWebAPI(const String &url, const String &deviceIdentifier, const String &apn) {
@@ -552,231 +980,437 @@ void BikeTrackerCore::setWebAPI(const String &url, const String &deviceIdentifie
         DEBUG_PRINT("APN: ");
         DEBUG_PRINTLN(apnName);
         
-        // Initialize GPRS connection with enhanced settings
+        // Enable automatic time sync for accurate timestamps. These two
+        // short AT commands are the only wait left; call from setup().
         if (status.gsmConnected) {
-            DEBUG_PRINTLN("Initializing GPRS connection...");
-            
-            // Enable automatic time sync for accurate timestamps
             gsm.enableAutoTimeSync();
-            
-            // Initialize GPRS with retry logic
-            bool gprsSuccess = false;
-            for (int attempt = 0; attempt < GPRS_RETRY_ATTEMPTS; attempt++) {
-                DEBUG_PRINT("GPRS connection attempt ");
-                DEBUG_PRINTLN(attempt + 1);
-                
-                gprsSuccess = gsm.initializeGPRS(apnName, APN_USERNAME, APN_PASSWORD);
-                
-                if (gprsSuccess) {
-                    DEBUG_PRINTLN("GPRS initialization: SUCCESS");
-                    
-                    // Test internet connectivity
-                    if (gsm.checkInternetConnectivity()) {
-                        DEBUG_PRINTLN("Internet connectivity: VERIFIED");
-                        DEBUG_PRINT("Local IP: ");
-                        DEBUG_PRINTLN(gsm.getLocalIP());
-                    } else {
-                        DEBUG_PRINTLN("Internet connectivity: FAILED");
-                    }
-                    break;
-                } else {
-                    DEBUG_PRINTLN("GPRS initialization: FAILED");
-                    if (attempt < GPRS_RETRY_ATTEMPTS - 1) {
-                        delay(GPRS_RETRY_DELAY);
-                    }
-                }
-            }
-            
-            if (!gprsSuccess) {
-                DEBUG_PRINTLN("GPRS initialization failed after all attempts");
-                httpEnabled = false; // Disable HTTP if GPRS fails
-            }
         }
+        
+        // Bring up GPRS as a modem job; TASK_CONNECTION retries it if GSM
+        // is not registered yet
+        queueBearerSetup();
+    }
+}
+
+void BikeTrackerCore::queueBearerSetup() {
+    // The GPRS job retries the bearer itself and stores the APN, so later
+    // connection checks reconnect with it
+    if (!status.gsmConnected || connectionCheckPending) {
+        return;
     }
+    DEBUG_PRINTLN("Initializing GPRS connection...");
+    connectionCheckPending = gsm.queueGPRS(apnName, APN_USERNAME, APN_PASSWORD, onConnectionChecked, this);
+    bearerConfigured = connectionCheckPending;
 }
 
 void BikeTrackerCore::sendLocationToAPI() {
-    if (!httpEnabled || !status.gsmConnected || !status.gpsFixed) {
+    // Queued even while GSM is down; serviceUploads() sends it later
+    if (!httpEnabled || !status.gpsFixed) {
         return;
     }
     
-    // Check if enough time has passed since last HTTP update
-    if (millis() - lastHTTPUpdate < HTTP_UPDATE_INTERVAL) {
+    // Last fix position, already in fixed point
+    int32_t lat = previousLat;
+    int32_t lon = previousLon;
+    
+    // Validate coordinates
+    if (lat == 0 && lon == 0) {
+        DEBUG_PRINTLN("Invalid GPS coordinates, skipping API call");
         return;
     }
     
-    // Check connection health
-    if (CONNECTION_MONITORING_ENABLED) {
-        if (!gsm.maintainConnection()) {
-            DEBUG_PRINTLN("Failed to maintain GPRS connection");
-            return;
-        }
+    DEBUG_PRINTLN("Queueing location for web API...");
+    queueReport(lat, lon, ALERT_NONE);
+}
+
+void BikeTrackerCore::feedMotion() {
+    // The detector averages its anchor over consecutive fixes, so it sees
+    // every published fix, independent of GPS_UPDATE_INTERVAL
+    unsigned long fixCount = gps.getFixCount();
+    if (fixCount == motionFixCount) {
+        return;
     }
+    motionFixCount = fixCount;
     
-    lastHTTPUpdate = millis();
+    GPSData fix = gps.getLatestFix();
+    if (!fix.isValid || millis() - gps.getLatestFixTime() > GPS_FIX_MAX_AGE ||
+        (fix.latitudeE7 == 0 && fix.longitudeE7 == 0)) {
+        return;
+    }
     
-    DEBUG_PRINTLN("Sending location to web API...");
+    if (motion.update(fix)) {
+        motionDetected = true;
+    }
+}
+
+void BikeTrackerCore::sampleLocation() {
+    // Every published fix is offered once, independent of GPS_UPDATE_INTERVAL
+    unsigned long fixCount = gps.getFixCount();
+    if (fixCount == sampledFixCount) {
+        return;
+    }
+    sampledFixCount = fixCount;
     
-    // Extract latitude and longitude from current location
-    int commaIndex = status.lastLocation.indexOf(',');
-    if (commaIndex > 0) {
-        float lat = status.lastLocation.substring(0, commaIndex).toFloat();
-        float lon = status.lastLocation.substring(commaIndex + 1).toFloat();
-        
-        // Validate coordinates
-        if (lat == 0.0 && lon == 0.0) {
-            DEBUG_PRINTLN("Invalid GPS coordinates, skipping API call");
+    GPSData fix = gps.getLatestFix();
+    if (!fix.isValid || millis() - gps.getLatestFixTime() > GPS_FIX_MAX_AGE ||
+        (fix.latitudeE7 == 0 && fix.longitudeE7 == 0)) {
+        return;
+    }
+    
+    SampleReason reason = sampling.evaluate(fix.latitudeE7, fix.longitudeE7, fix.speed, fix.course, millis());
+    if (reason == SAMPLE_NONE) {
+        return;
+    }
+    DEBUG_PRINT("Queueing location for web API (");
+    DEBUG_PRINT(SamplingPolicy::reasonName(reason));
+    DEBUG_PRINTLN(")");
+    queueReport(fix.latitudeE7, fix.longitudeE7, ALERT_NONE);
+}
+
+void BikeTrackerCore::setSamplingParameters(const SamplingParameters &parameters) {
+    sampling.setParameters(parameters);
+}
+
+const SamplingParameters &BikeTrackerCore::getSamplingParameters() {
+    return sampling.getParameters();
+}
+
+const SamplingStats &BikeTrackerCore::getSamplingStats() {
+    return sampling.getStats();
+}
+
+const MotionStats &BikeTrackerCore::getMotionStats() {
+    return motion.getStats();
+}
+
+void BikeTrackerCore::queueReport(int32_t latE7, int32_t lonE7, AlertType type, uint16_t alertId) {
+    if (offlineLog.isReady()) {
+        OfflineRecord record;
+        record.latitudeE7 = latE7;
+        record.longitudeE7 = lonE7;
+        record.capturedAt = millis();
+        record.alertType = type;
+        if (offlineLog.append(record)) {
+            // Routine reports are loaded from the log in order; alerts go
+            // straight to the queue so a backlog does not hold them up
+            if (type != ALERT_NONE &&
+                !uploads.push(latE7, lonE7, apiAlertName(type), UPLOAD_ALERT_ATTEMPTS,
+                              record.capturedAt, record.sequence, alertId)) {
+                offlineLoadSequence = offlineLog.first(); // Evicted report is still in flash
+            }
             return;
         }
-        
-        bool success = false;
-        
-        // Retry logic for API calls
-        for (int attempt = 0; attempt < HTTP_RETRY_ATTEMPTS; attempt++) {
-            if (DETAILED_LOGGING_ENABLED && attempt > 0) {
-                DEBUG_PRINT("HTTP retry attempt ");
-                DEBUG_PRINTLN(attempt + 1);
-            }
-            
-            success = gsm.sendLocationHTTP(webAPIUrl, deviceId, lat, lon, "");
-            
-            if (success) {
-                break;
-            }
-            
-            // Wait before retry
-            if (attempt < HTTP_RETRY_ATTEMPTS - 1) {
-                delay(HTTP_RETRY_DELAY);
-            }
+        DEBUG_PRINTLN("Offline log write failed, report kept in RAM only");
+    }
+    
+    uint8_t attempts = (type == ALERT_NONE) ? HTTP_RETRY_ATTEMPTS : UPLOAD_ALERT_ATTEMPTS;
+    if (!uploads.push(latE7, lonE7, apiAlertName(type), attempts, millis(), 0, alertId)) {
+        DEBUG_PRINTLN("Upload queue full, oldest report dropped");
+    }
+}
+
+void BikeTrackerCore::loadOfflineReports() {
+    if (!offlineLog.isReady()) {
+        return;
+    }
+    if (offlineLoadSequence < offlineLog.first()) {
+        offlineLoadSequence = offlineLog.first();
+    }
+    
+    // Oldest unacknowledged first, skipping those already queued or sent
+    while (!uploads.isFull() && offlineLoadSequence < offlineLog.end()) {
+        uint32_t sequence = offlineLoadSequence++;
+        if (offlineLog.isAcknowledged(sequence) || uploads.contains(sequence)) {
+            continue;
         }
-        
-        DEBUG_PRINT("HTTP POST result: ");
-        DEBUG_PRINTLN(success ? "SUCCESS" : "FAILED");
-        
-        if (success) {
-            blinkStatusLED(1); // Quick blink on successful upload
-        } else {
-            DEBUG_PRINTLN("All HTTP attempts failed");
-            
-            // Try to reset connection on persistent failures
-            if (AUTO_RECONNECT_ENABLED) {
-                DEBUG_PRINTLN("Attempting connection reset...");
-                gsm.resetConnection();
-            }
+        OfflineRecord record;
+        if (!offlineLog.read(sequence, record)) {
+            offlineLog.acknowledge(sequence); // Unreadable, nothing to send
+            continue;
         }
+        AlertType type = (AlertType)record.alertType;
+        uploads.push(record.latitudeE7, record.longitudeE7, apiAlertName(type),
+                     type == ALERT_NONE ? HTTP_RETRY_ATTEMPTS : UPLOAD_ALERT_ATTEMPTS,
+                     record.capturedAt, sequence);
     }
 }
 
-void BikeTrackerCore::sendAlertToAPI(AlertType type, const String &message) {
-    if (!httpEnabled || !status.gsmConnected) {
+void BikeTrackerCore::serviceUploads() {
+    // One send at a time, and only while the modem can carry it
+    if (uploads.isBusy() || !status.gsmConnected || !gsm.isNetworkConnected()) {
         return;
     }
+    loadOfflineReports();
+    uint8_t count = uploads.begin(PH_BATCH_UPDATES_ENABLED ? PH_MAX_BATCH_SIZE : 1, PH_BATCH_MAX_AGE);
+    if (count == 0) {
+        return; // Nothing ready, or the breaker is open
+    }
+    UploadMessage *message = uploads.current();
     
-    String alertTypeStr = "";
-    switch (type) {
-        case ALERT_MOTION_DETECTED:
-            alertTypeStr = "MOTION_DETECTED";
-            break;
-        case ALERT_SPEED_EXCEEDED:
-            alertTypeStr = "SPEED_EXCEEDED";
-            break;
-        case ALERT_GEOFENCE_BREACH:
-            alertTypeStr = "GEOFENCE_BREACH";
-            break;
-        case ALERT_SYSTEM_ERROR:
-            alertTypeStr = "SYSTEM_ERROR";
-            break;
-        case ALERT_GPS_LOST:
-            alertTypeStr = "GPS_LOST";
-            break;
-        case ALERT_GSM_LOST:
-            alertTypeStr = "GSM_LOST";
-            break;
-        default:
-            alertTypeStr = "UNKNOWN";
-            break;
+    if (DETAILED_LOGGING_ENABLED && message->attempts > 1) {
+        DEBUG_PRINT("HTTP retry attempt ");
+        DEBUG_PRINTLN(message->attempts);
     }
     
-    DEBUG_PRINT("Sending alert to web API: ");
-    DEBUG_PRINTLN(alertTypeStr);
+    // The job checks (and if needed restores) the bearer itself
+    bool queued;
+    if (PH_DATA_COMPRESSION_ENABLED) {
+        queued = queueBinaryUpload(count);
+    } else if (count == 1) {
+        queued = gsm.queueLocationHTTP(webAPIUrl, deviceId, message->latitudeE7, message->longitudeE7,
+                                       message->alertType, message->capturedAt, onUploadDone, this);
+    } else {
+        // Routine reports share one POST
+        String fixes = "";
+        for (uint8_t i = 0; i < count; i++) {
+            UploadMessage *fix = uploads.current(i);
+            Sim800L::appendLocationFix(fixes, fix->latitudeE7, fix->longitudeE7, fix->capturedAt);
+        }
+        queued = gsm.queueLocationBatchHTTP(webAPIUrl, deviceId, fixes, onUploadDone, this);
+    }
+    if (!queued) {
+        // Job queue full, count it as a failed attempt
+        onUploadDone(this, false, "");
+    }
+}
+
+bool BikeTrackerCore::queueBinaryUpload(uint8_t count) {
+    LocationHeader header;
+    strncpy(header.deviceId, deviceId.c_str(), LOCATION_CODEC_ID_MAX);
+    header.deviceId[LOCATION_CODEC_ID_MAX] = '\0';
+    header.imei[0] = '\0';
+    if (INCLUDE_IMEI_IN_PAYLOAD) {
+        strncpy(header.imei, gsm.getIMEI().c_str(), LOCATION_CODEC_IMEI_MAX);
+        header.imei[LOCATION_CODEC_IMEI_MAX] = '\0';
+    }
+    header.signalStrength = gsm.getLastSignalStrength();
+    header.alertType = locationAlertCode(uploads.current()->alertType.c_str());
+    
+    uint8_t buffer[LOCATION_CODEC_HEADER_MAX + PH_MAX_BATCH_SIZE * LOCATION_CODEC_FIX_MAX];
+    LocationEncoder encoder(buffer, sizeof(buffer));
+    encoder.begin(header);
+    for (uint8_t i = 0; i < count; i++) {
+        UploadMessage *report = uploads.current(i);
+        LocationFix fix;
+        fix.latitudeE7 = report->latitudeE7;
+        fix.longitudeE7 = report->longitudeE7;
+        fix.timestamp = report->capturedAt;
+        encoder.add(fix);
+    }
+    if (encoder.failed()) {
+        DEBUG_PRINTLN("Binary payload did not fit, report not sent");
+        return false;
+    }
     
-    // For alerts, ensure immediate connectivity
-    if (!gsm.maintainConnection()) {
-        DEBUG_PRINTLN("Failed to maintain connection for alert");
+    String payload = "";
+    payload.reserve(encoder.size());
+    for (size_t i = 0; i < encoder.size(); i++) {
+        payload.concat((char)buffer[i]);
+    }
+    return gsm.queueBinaryHTTP(webAPIUrl, LOCATION_CODEC_CONTENT_TYPE, payload, onUploadDone, this);
+}
+
+void BikeTrackerCore::onUploadDone(void *context, bool success, const String &response) {
+    BikeTrackerCore *core = (BikeTrackerCore *)context;
+    UploadMessage *message = core->uploads.current();
+    if (message == NULL) {
         return;
     }
-    
-    // Extract latitude and longitude from current location
-    int commaIndex = status.lastLocation.indexOf(',');
-    if (commaIndex > 0) {
-        float lat = status.lastLocation.substring(0, commaIndex).toFloat();
-        float lon = status.lastLocation.substring(commaIndex + 1).toFloat();
-        
-        bool success = false;
-        
-        // For alerts, use more aggressive retry logic
-        for (int attempt = 0; attempt < (HTTP_RETRY_ATTEMPTS + 2); attempt++) {
-            if (attempt > 0) {
-                DEBUG_PRINT("Alert retry attempt ");
-                DEBUG_PRINTLN(attempt + 1);
-            }
-            
-            success = gsm.sendLocationHTTP(webAPIUrl, deviceId, lat, lon, alertTypeStr);
-            
+    bool alert = message->alertType.length() > 0;
+    uint16_t alertId = message->alertId;    // Alerts always go alone
+    RetryPolicy &policy = core->uploads.getPolicy();
+    BreakerState breakerBefore = policy.getState();
+    
+    // Every report in the send, acknowledged in the offline log on success
+    uint8_t count = 0;
+    uint32_t sequences[UPLOAD_QUEUE_SIZE];
+    uint8_t logged = 0;
+    for (UploadMessage *report = message; report != NULL; report = core->uploads.current(++count)) {
+        if (report->sequence != 0) {
+            sequences[logged++] = report->sequence;
             if (success) {
-                break;
-            }
-            
-            // Shorter retry delay for alerts
-            if (attempt < HTTP_RETRY_ATTEMPTS + 1) {
-                delay(HTTP_RETRY_DELAY / 2);
+                core->offlineLog.acknowledge(report->sequence);
             }
         }
+    }
+    bool stored = false;
+    
+    UploadOutcome outcome = core->uploads.complete(success);
+    switch (outcome) {
+        case UPLOAD_SENT:
+            DEBUG_PRINT(alert ? "Alert HTTP POST result: " : "HTTP POST result: ");
+            if (count > 1) {
+                DEBUG_PRINT(count);
+                DEBUG_PRINT(" fixes, ");
+            }
+            DEBUG_PRINTLN("SUCCESS");
+            if (!alert) {
+                core->uploadBlinkPending = true; // Blink from update(), not from here
+            }
+            break;
         
-        DEBUG_PRINT("Alert HTTP POST result: ");
-        DEBUG_PRINTLN(success ? "SUCCESS" : "FAILED");
+        case UPLOAD_DEFERRED:
+            if (DETAILED_LOGGING_ENABLED) {
+                DEBUG_PRINTLN(count > 1 ? "HTTP POST failed, batch queued for retry" :
+                                          "HTTP POST failed, report queued for retry");
+            }
+            break;
         
-        if (!success) {
-            DEBUG_PRINTLN("CRITICAL: Alert failed to send to API");
+        case UPLOAD_DROPPED:
+            DEBUG_PRINT(alert ? "Alert HTTP POST result: " : "HTTP POST result: ");
+            DEBUG_PRINTLN("FAILED");
+            // Logged reports are still in flash and are loaded again once
+            // the queue has room, up to OFFLINE_LOG_MAX_RELOADS times
+            for (uint8_t i = 0; i < logged; i++) {
+                if (core->offlineLog.retry(sequences[i])) {
+                    stored = true;
+                }
+            }
+            if (stored) {
+                DEBUG_PRINTLN("Report kept in offline log");
+                core->offlineLoadSequence = core->offlineLog.first();
+            } else if (logged > 0) {
+                DEBUG_PRINTLN("Report abandoned after repeated failures");
+            } else {
+                DEBUG_PRINTLN(alert ? "CRITICAL: Alert failed to send to API" : "All HTTP attempts failed");
+            }
+            break;
+    }
+    
+    // Delivery status of the alert this report carried
+    if (alertId != 0 && outcome == UPLOAD_SENT) {
+        core->alerts.completeAPI(alertId, DELIVERY_SENT);
+    } else if (alertId != 0 && outcome == UPLOAD_DROPPED) {
+        core->alerts.completeAPI(alertId, stored ? DELIVERY_STORED : DELIVERY_FAILED);
+    }
+    
+    // Persistent failures: hold uploads and try to reset the connection
+    if (breakerBefore != BREAKER_OPEN && policy.getState() == BREAKER_OPEN) {
+        DEBUG_PRINT("Uploads paused for ");
+        DEBUG_PRINT(policy.getCooldownRemaining() / 1000);
+        DEBUG_PRINTLN(" s after repeated failures");
+        if (AUTO_RECONNECT_ENABLED && !core->connectionCheckPending) {
+            DEBUG_PRINTLN("Attempting connection reset...");
+            core->connectionCheckPending = core->gsm.queueConnectionReset(onConnectionChecked, core);
         }
     }
 }
 
+void BikeTrackerCore::onAlertSMSDone(void *context, bool success, const String &response) {
+    BikeTrackerCore *core = (BikeTrackerCore *)context;
+    core->alerts.completeSMS(success, millis());
+    DEBUG_PRINTLN(success ? "Alert SMS sent" : "Alert SMS failed");
+}
+
+void BikeTrackerCore::onConnectionChecked(void *context, bool success, const String &response) {
+    BikeTrackerCore *core = (BikeTrackerCore *)context;
+    core->connectionCheckPending = false;
+    DEBUG_PRINTLN(success ? "GPRS connection OK" : "GPRS reconnection failed");
+}
+
+void BikeTrackerCore::onRegistrationChecked(void *context, bool success, const String &response) {
+    BikeTrackerCore *core = (BikeTrackerCore *)context;
+    core->registrationPending = false;
+    core->status.gsmConnected = success;
+    DEBUG_PRINTLN(success ? "GSM network registered" : "GSM registration failed");
+}
+
+void BikeTrackerCore::onGSMEvent(void *context, GSMEvent event, int value) {
+    BikeTrackerCore *core = (BikeTrackerCore *)context;
+    
+    switch (event) {
+        case GSM_EVENT_SMS_RECEIVED:
+            DEBUG_PRINT("SMS received, index ");
+            DEBUG_PRINTLN(value);
+            core->gsmActivityPending = true;
+            break;
+        case GSM_EVENT_CALL_RING:
+            DEBUG_PRINTLN("Incoming call");
+            core->gsmActivityPending = true;
+            break;
+        case GSM_EVENT_BEARER_LOST:
+            DEBUG_PRINTLN("GPRS bearer dropped by the network");
+            // Bring it back now rather than on the next upload
+            if (core->httpEnabled && AUTO_RECONNECT_ENABLED && !core->connectionCheckPending) {
+                core->connectionCheckPending = core->gsm.queueConnectionCheck(onConnectionChecked, core);
+            }
+            break;
+        case GSM_EVENT_REGISTRATION:
+            core->status.gsmConnected = (value != 0);
+            DEBUG_PRINTLN(value ? "GSM network registered" : "GSM network registration lost");
+            break;
+        case GSM_EVENT_NETWORK_TIME:
+            DEBUG_PRINT("Network time: ");
+            DEBUG_PRINTLN(core->gsm.getNetworkTime());
+            break;
+    }
+}
+
 // =============================================================================
 // POWER MANAGEMENT IMPLEMENTATION
 // =============================================================================
 
 void BikeTrackerCore::enterSleepMode(unsigned long durationMs) {
+    // Light sleep is a scheduler state: the routine tasks are held and
+    // TASK_SLEEP checks the wake conditions every 5 seconds, so this
+    // returns at once and GPS and modem jobs keep running
+    if (sleeping) {
+        return;
+    }
     DEBUG_PRINTLN("Entering sleep mode...");
     
     sleepDuration = durationMs;
     prepareForSleep();
+    sleeping = true;
+    shouldSleep = false;
+    sleepStart = millis();
+    holdTasks(true);
+    scheduler.start(TASK_SLEEP, 5000);
     
     // Light sleep - maintains WiFi/GSM connections but reduces power
     DEBUG_PRINT("Sleeping for ");
     DEBUG_PRINT(durationMs / 1000);
     DEBUG_PRINTLN(" seconds");
-    
-    // Reduce update frequencies during sleep
-    unsigned long sleepStart = millis();
-    while (millis() - sleepStart < durationMs) {
-        // Check for wake conditions every 5 seconds
-        if (checkWakeConditions()) {
-            DEBUG_PRINTLN("Wake condition detected, exiting sleep");
-            break;
-        }
-        
-        // Minimal operations during sleep
-        delay(5000);
-        
-        // Flash LED slowly to indicate sleep mode
-        digitalWrite(LED_STATUS_PIN, (millis() / 5000) % 2);
+}
+
+void BikeTrackerCore::updateSleep() {
+    // Runs every 5 seconds as TASK_SLEEP
+    if (checkWakeConditions()) {
+        DEBUG_PRINTLN("Wake condition detected, exiting sleep");
+        leaveSleepMode();
+        return;
+    }
+    if (millis() - sleepStart >= sleepDuration) {
+        leaveSleepMode();
+        return;
     }
     
+    // Flash LED slowly to indicate sleep mode
+    digitalWrite(LED_STATUS_PIN, (millis() / 5000) % 2);
+}
+
+void BikeTrackerCore::leaveSleepMode() {
+    scheduler.stop(TASK_SLEEP);
+    holdTasks(false);
+    sleeping = false;
     restoreFromSleep();
     DEBUG_PRINTLN("Waking from sleep mode");
 }
 
+void BikeTrackerCore::holdTasks(bool hold) {
+    // Routine work paused during light sleep; GPS and modem jobs keep going
+    static const uint8_t held[] = {
+        TASK_GSM_CHECK, TASK_CONNECTION, TASK_MONITOR, TASK_UPLOADS, TASK_POWER, TASK_STATUS_LED
+    };
+    for (uint8_t i = 0; i < sizeof(held); i++) {
+        if (hold) {
+            scheduler.stop(held[i]);
+        } else {
+            scheduler.start(held[i]);
+        }
+    }
+}
+
 void BikeTrackerCore::enterDeepSleep(unsigned long durationMs) {
     DEBUG_PRINTLN("Entering deep sleep mode...");
     
@@ -786,10 +1420,9 @@ void BikeTrackerCore::enterDeepSleep(unsigned long durationMs) {
     if (status.gsmConnected && emergencyContact.length() > 0) {
         String sleepMsg = "Tracker entering deep sleep for " + String(durationMs / 60000) + " minutes";
         gsm.sendSMS(emergencyContact, sleepMsg);
-        delay(2000); // Allow SMS to send
     }
     
-    // Power down modules
+    // Power down modules (queued SMS are sent first)
     gsm.powerOff();
     
     // Turn off LEDs
@@ -820,6 +1453,10 @@ bool BikeTrackerCore::isInLowPowerMode() {
 void BikeTrackerCore::wakeFromSleep() {
     DEBUG_PRINTLN("Wake up requested");
     shouldSleep = false;
+    if (sleeping) {
+        leaveSleepMode();
+        return;
+    }
     updateActivityTime();
     restoreFromSleep();
 }
@@ -827,8 +1464,12 @@ void BikeTrackerCore::wakeFromSleep() {
 void BikeTrackerCore::prepareForSleep() {
     DEBUG_PRINTLN("Preparing for sleep...");
     
-    // Save current state
+    // Save current state; deep sleep ends in a reset
+    offlineLog.flush();
+    
     // Turn off unnecessary components
+    scheduler.stop(TASK_BUZZER);
+    scheduler.stop(TASK_BLINK);
     digitalWrite(BUZZER_PIN, LOW);
     
     // Reduce GPS update frequency
@@ -843,9 +1484,9 @@ void BikeTrackerCore::restoreFromSleep() {
     // Restore normal operations
     updateActivityTime();
     
-    // Re-initialize connections if needed
+    // Re-register in the background if needed
     if (!status.gsmConnected) {
-        gsm.initialize();
+        queueRegistration();
     }
     
     // Resume normal LED operation
@@ -870,8 +1511,9 @@ bool BikeTrackerCore::checkWakeConditions() {
         }
     }
     
-    // Check for incoming GSM activity
-    if (gsm.available()) {
+    // Check for incoming GSM activity (SMS or call URCs)
+    if (gsmActivityPending) {
+        gsmActivityPending = false;
         DEBUG_PRINTLN("Wake: GSM activity detected");
         return true;
     }
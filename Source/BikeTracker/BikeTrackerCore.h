@@ -8,6 +8,14 @@
 #include "Neo6mGPS.h"
 #include "Sim800L.h"
 #include "ModeConfig.h"
+#include "LinkSettings.h"
+#include "UploadQueue.h"
+#include "OfflineLog.h"
+#include "SamplingPolicy.h"
+#include "TaskScheduler.h"
+#include "AlertQueue.h"
+#include "GeofenceEngine.h"
+#include "MotionDetector.h"
 
 enum TrackerState {
     TRACKER_INITIALIZING,
@@ -17,14 +25,22 @@ enum TrackerState {
     TRACKER_ERROR
 };
 
-enum AlertType {
-    ALERT_NONE,
-    ALERT_MOTION_DETECTED,     // ✅ Works with GPS
-    ALERT_SPEED_EXCEEDED,      // ✅ Works with GPS
-    ALERT_GEOFENCE_BREACH,     // ✅ Works with GPS
-    ALERT_SYSTEM_ERROR,        // ✅ Works with software monitoring
-    ALERT_GPS_LOST,            // ✅ GPS fix lost alert
-    ALERT_GSM_LOST             // ✅ GSM connection lost alert
+// Scheduler tasks run by the core, in the order they are checked each pass
+enum CoreTask {
+    TASK_GPS,                       // Drain the GPS port, look at the fix
+    TASK_GSM,                       // Advance queued modem jobs
+    TASK_GSM_CHECK,                 // Network registration
+    TASK_CONNECTION,                // GPRS connection health
+    TASK_MONITOR,                   // Security checks, alerts, sampling
+    TASK_UPLOADS,
+    TASK_POWER,                     // Sleep conditions
+    TASK_FIX_WAIT,                  // First fix after initialize()
+    TASK_ALERT_END,                 // Leave TRACKER_ALERT
+    TASK_BLINK,                     // LED pattern
+    TASK_BUZZER,                    // Buzzer off
+    TASK_STATUS_LED,                // LED state indication between patterns
+    TASK_SLEEP,                     // Wake checks during light sleep
+    CORE_TASKS
 };
 
 struct TrackerStatus {
@@ -51,13 +67,24 @@ public:
     void disarmTracker();
     bool isArmed();
     
-    // Alert functions
+    // Alert functions. Alerts are queued and sent by processAlerts(),
+    // see AlertQueue.h
     void triggerAlert(AlertType type, const String &message = "");
     void clearAlerts();
+    const AlertQueueStats &getAlertStats();
     
     // Configuration
     void setEmergencyContact(const String &number);
-    void setGeofenceCenter(float lat, float lon, float radius);
+    void setGeofenceCenter(int32_t latE7, int32_t lonE7, float radius);  // Replaces the "home" zone
+    
+    // Safe zones, see GeofenceEngine.h. Leaving the last zone the bike is
+    // in raises ALERT_GEOFENCE_BREACH. Returns the zone id, -1 if full.
+    int8_t addGeofenceCircle(const char *name, int32_t latE7, int32_t lonE7, float radius,
+                             unsigned long dwellTime = 0);
+    int8_t addGeofencePolygon(const char *name, const int32_t *latsE7, const int32_t *lonsE7, uint8_t count,
+                              unsigned long dwellTime = 0);
+    bool removeGeofence(uint8_t zone);
+    const GeofenceStats &getGeofenceStats();
     void setSpeedLimit(float maxSpeed);
     void setWebAPI(const String &url, const String &deviceId, const String &apn);
     
@@ -65,11 +92,18 @@ public:
     void requestLocationUpdate();
     String getCurrentLocation();
     void sendStatusSMS();
-    void sendLocationToAPI();
+    void sendLocationToAPI();       // Report the last fix now, bypassing sampling
+    
+    // Adaptive reporting of routine fixes, see SamplingPolicy.h
+    void setSamplingParameters(const SamplingParameters &parameters);
+    const SamplingParameters &getSamplingParameters();
+    const SamplingStats &getSamplingStats();
+    const MotionStats &getMotionStats();
     
     // Testing functions (only available in testing mode)
     void runDiagnostics();
     void simulateAlert(AlertType type);
+    void runLinkBenchmark();
     
     // Power management functions
     void enterSleepMode(unsigned long durationMs = 300000); // Default 5 minutes
@@ -78,6 +112,10 @@ public:
     bool isInLowPowerMode();
     void wakeFromSleep();
     
+    // Delay that keeps ingesting GPS data and pumping modem jobs
+    void serviceDelay(unsigned long durationMs);
+    const SchedulerStats &getSchedulerStats();  // Worst-case loop latency and task time
+    
 private:
     Neo6mGPS &gps;
     Sim800L &gsm;
@@ -86,22 +124,40 @@ private:
     // Configuration
     String emergencyContact;
     bool isTrackerArmed;
-    float geofenceLat, geofenceLon, geofenceRadius;
+    GeofenceEngine geofences;
+    int8_t homeZone;                // Zone set by setGeofenceCenter(), -1 if none
+    int8_t lastExitedZone;
+    unsigned long geofenceCheckedAt;    // lastGPSUpdate of the fix last tested
     float speedLimit;
     String webAPIUrl;
     String deviceId;
     String apnName;
     bool httpEnabled;
+    LinkSettings linkSettings;      // Negotiated GPS/GSM baud rates
+    UploadQueue uploads;            // Web API reports waiting or in flight
+    OfflineLog offlineLog;          // Reports kept in flash until acknowledged
+    uint32_t offlineLoadSequence;   // Next logged report to load into uploads
+    SamplingPolicy sampling;        // Decides which fixes become reports
+    AlertQueue alerts;              // Raised alerts waiting for SMS and API
+    unsigned long sampledFixCount;  // gps.getFixCount() last offered to sampling
+    bool connectionCheckPending;
+    bool registrationPending;       // Re-registration job queued on the modem
+    bool bearerConfigured;          // APN handed to the modem by queueBearerSetup()
+    bool uploadBlinkPending;
+    bool gsmActivityPending;        // SMS or call arrived, wakes light sleep
+    TaskScheduler scheduler;
+    uint8_t blinkToggles;           // LED changes left in the current pattern
+    bool blinkOn;
+    unsigned long fixWaitStart;
     
     // Timing
     unsigned long lastGPSUpdate;
-    unsigned long lastSMSAlert;
-    unsigned long lastStatusCheck;
-    unsigned long lastHTTPUpdate;
     
     // State tracking
     bool motionDetected;
-    float previousLat, previousLon;
+    int32_t previousLat, previousLon;   // Last fix, 1e-7 degrees
+    MotionDetector motion;              // Averaged parked position, see MotionDetector.h
+    unsigned long motionFixCount;       // gps.getFixCount() last offered to motion
     bool isInGeofence;
     
     // Power management
@@ -109,23 +165,46 @@ private:
     unsigned long lastActivity;
     unsigned long sleepDuration;
     bool shouldSleep;
+    bool sleeping;                  // In light sleep, see enterSleepMode()
+    unsigned long sleepStart;
     
     // Internal functions
     void checkMotion();
     void checkSpeed();
     void checkGeofence();
     void updateGPS();
+    void feedMotion();
     void updateGSM();
+    void queueRegistration();
+    void queueBearerSetup();
+    void checkConnection();
+    void waitForFix();
     void processAlerts();
-    void sendAlertToAPI(AlertType type, const String &message);
-    float calculateDistance(float lat1, float lon1, float lat2, float lon2);
+    void sampleLocation();
+    String formatAlertSMS(AlertEvent **batch, uint8_t count);
+    void queueReport(int32_t latE7, int32_t lonE7, AlertType type, uint16_t alertId = 0);
+    void loadOfflineReports();
+    void serviceUploads();
+    bool queueBinaryUpload(uint8_t count);
+    static void onUploadDone(void *context, bool success, const String &response);
+    static void onAlertSMSDone(void *context, bool success, const String &response);
+    static void onConnectionChecked(void *context, bool success, const String &response);
+    static void onRegistrationChecked(void *context, bool success, const String &response);
+    static void onGSMEvent(void *context, GSMEvent event, int value);
+    static void onZoneEvent(void *context, uint8_t zone, ZoneEventType event);
     String formatLocationMessage(const String &alertType = "");
     void blinkStatusLED(int times);
     void activateBuzzer(int duration);
+    static void serviceIdle(void *context);
+    static void onTask(void *context, uint8_t task);
+    void startTasks();
     
     // Power management helpers
     void prepareForSleep();
     void restoreFromSleep();
+    void holdTasks(bool hold);
+    void updateSleep();
+    void leaveSleepMode();
     bool checkWakeConditions();
     void updateActivityTime();
 };
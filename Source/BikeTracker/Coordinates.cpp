@@ -0,0 +1,14 @@
+// Coordinates.cpp
+// Implementation of the fixed-point coordinate helpers
+
+#include "Coordinates.h"
+#include <stdio.h>
+
+size_t formatCoordinate(int32_t valueE7, char *buffer) {
+    // Work on the magnitude so -0.5 degrees keeps its sign
+    uint32_t magnitude = valueE7 < 0 ? (uint32_t)(-(int64_t)valueE7) : (uint32_t)valueE7;
+    unsigned long degrees = magnitude / COORDINATE_SCALE;
+    unsigned long fraction = magnitude % COORDINATE_SCALE;
+
+    return sprintf(buffer, "%s%lu.%07lu", valueE7 < 0 ? "-" : "", degrees, fraction);
+}
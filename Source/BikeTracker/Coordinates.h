@@ -0,0 +1,17 @@
+// Coordinates.h
+// Fixed-point coordinate helpers (1e-7 degree units)
+
+#ifndef COORDINATES_H
+#define COORDINATES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define COORDINATE_SCALE 10000000L      // Units per degree
+#define COORDINATE_TEXT_SIZE 13         // "-180.0000000" plus terminator
+
+// Write a coordinate as signed decimal degrees with 7 decimals.
+// Returns the number of characters written.
+size_t formatCoordinate(int32_t valueE7, char *buffer);
+
+#endif // COORDINATES_H
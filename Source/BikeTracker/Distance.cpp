@@ -0,0 +1,67 @@
+// Distance.cpp
+// Implementation of the distance kernels
+
+#include "Distance.h"
+#include "Coordinates.h"
+#include <math.h>
+
+static const float E7_TO_RAD = 3.14159265358979f / 180.0f / COORDINATE_SCALE;
+
+// Longitude difference in 1e-7 degrees, taken the short way round
+static int64_t longitudeDelta(int32_t from, int32_t to) {
+    int64_t delta = (int64_t)to - from;
+    if (delta > 1800000000LL) {
+        delta -= 3600000000LL;
+    } else if (delta < -1800000000LL) {
+        delta += 3600000000LL;
+    }
+    return delta;
+}
+
+void setDistanceReference(DistanceReference &reference, int32_t latitudeE7, int32_t longitudeE7) {
+    reference.latitudeE7 = latitudeE7;
+    reference.longitudeE7 = longitudeE7;
+    reference.cosLatitude = cos(latitudeE7 * E7_TO_RAD);
+    reference.sinLatitude = sin(latitudeE7 * E7_TO_RAD);
+}
+
+float distanceFrom(const DistanceReference &reference, int32_t latitudeE7, int32_t longitudeE7) {
+    int64_t dLat = (int64_t)latitudeE7 - reference.latitudeE7;
+    int64_t dLon = longitudeDelta(reference.longitudeE7, longitudeE7);
+    if (dLat > DISTANCE_FLAT_SPAN || dLat < -DISTANCE_FLAT_SPAN ||
+        dLon > DISTANCE_FLAT_SPAN || dLon < -DISTANCE_FLAT_SPAN) {
+        return haversineMetres(reference.latitudeE7, reference.longitudeE7, latitudeE7, longitudeE7);
+    }
+    return equirectangularMetres(reference, latitudeE7, longitudeE7);
+}
+
+float distanceMetres(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2) {
+    DistanceReference reference;
+    setDistanceReference(reference, lat1, lon1);
+    return distanceFrom(reference, lat2, lon2);
+}
+
+float equirectangularMetres(const DistanceReference &reference, int32_t latitudeE7, int32_t longitudeE7) {
+    // Differences are taken in fixed point first, so nearby points keep
+    // full precision instead of cancelling in float
+    float dLat = (float)((int64_t)latitudeE7 - reference.latitudeE7) * E7_TO_RAD;
+    float dLon = (float)longitudeDelta(reference.longitudeE7, longitudeE7) * E7_TO_RAD;
+    
+    // cos(reference + dLat/2) to second order, from the cached cos and sin
+    float cosMean = reference.cosLatitude * (1.0f - dLat * dLat * 0.125f) - reference.sinLatitude * dLat * 0.5f;
+    float x = dLon * cosMean;
+    return DISTANCE_EARTH_RADIUS * sqrtf(x * x + dLat * dLat);
+}
+
+float haversineMetres(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2) {
+    float dLat = (float)((int64_t)lat2 - lat1) * E7_TO_RAD;
+    float dLon = (float)longitudeDelta(lon1, lon2) * E7_TO_RAD;
+    
+    float a = sin(dLat / 2) * sin(dLat / 2) +
+              cos(lat1 * E7_TO_RAD) * cos(lat2 * E7_TO_RAD) *
+              sin(dLon / 2) * sin(dLon / 2);
+    
+    float c = 2 * atan2(sqrt(a), sqrt(1 - a));
+    
+    return DISTANCE_EARTH_RADIUS * c;
+}
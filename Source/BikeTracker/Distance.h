@@ -0,0 +1,40 @@
+// Distance.h
+// Ground distance between 1e-7 degree coordinates
+//
+// Tracker distances are short, so the default kernel is equirectangular:
+// the cosine and sine of a reference point's latitude are computed once,
+// when the reference is set, and each distance from it is a handful of
+// multiplies and one sqrt. The cosine is corrected to the mean latitude of
+// the two points, which keeps the result within centimetres of haversine
+// up to DISTANCE_FLAT_SPAN (test/bench_distance.cpp measures it). Longer
+// spans fall back to haversine.
+
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include <stdint.h>
+
+#define DISTANCE_EARTH_RADIUS 6371000.0f    // Metres, as used throughout the tracker
+#define DISTANCE_FLAT_SPAN 1000000L         // 1e-7 degrees (0.1 degree, about 11 km)
+
+struct DistanceReference {
+    int32_t latitudeE7;
+    int32_t longitudeE7;
+    float cosLatitude;
+    float sinLatitude;
+};
+
+// Cache the constants for distances from one point (two trig calls)
+void setDistanceReference(DistanceReference &reference, int32_t latitudeE7, int32_t longitudeE7);
+
+// Metres from the reference; the kernel is picked by span
+float distanceFrom(const DistanceReference &reference, int32_t latitudeE7, int32_t longitudeE7);
+
+// Metres between two points without a cached reference
+float distanceMetres(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2);
+
+// The kernels themselves, for comparison
+float equirectangularMetres(const DistanceReference &reference, int32_t latitudeE7, int32_t longitudeE7);
+float haversineMetres(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2);
+
+#endif // DISTANCE_H
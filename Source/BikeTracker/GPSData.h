@@ -0,0 +1,27 @@
+// GPSData.h
+// Position fix record shared by the GPS module and its parsers
+
+#ifndef GPSDATA_H
+#define GPSDATA_H
+
+#include <stdint.h>
+
+#define GPS_TIMESTAMP_SIZE 20   // "hhmmss.ss ddmmyy" plus terminator
+
+struct GPSData {
+    bool isValid;
+    int32_t latitudeE7;         // 1e-7 degrees, see Coordinates.h
+    int32_t longitudeE7;
+    float altitude;
+    float speed;                // km/h
+    float course;               // Degrees from true north
+    int satellites;
+    float hdop;
+    float pdop;
+    float vdop;
+    float accuracy;             // Horizontal accuracy estimate in metres (UBX mode only)
+    uint8_t fixMode;            // 1 = no fix, 2 = 2D, 3 = 3D (from GSA)
+    char timestamp[GPS_TIMESTAMP_SIZE];
+};
+
+#endif // GPSDATA_H
@@ -0,0 +1,99 @@
+// GPSEpoch.cpp
+// Implementation of the per-epoch fix assembler
+
+#include "GPSEpoch.h"
+#include <string.h>
+
+GPSEpochAssembler::GPSEpochAssembler() {
+    memset(&working, 0, sizeof(working));
+    memset(&published, 0, sizeof(published));
+    memset(&stats, 0, sizeof(stats));
+    required = 0;
+    received = 0;
+    currentKey = 0;
+    epochOpen = false;
+    epochPublished = false;
+    updated = false;
+    previousIncomplete = false;
+}
+
+void GPSEpochAssembler::begin(uint8_t requiredParts) {
+    required = requiredParts;
+    received = 0;
+    epochOpen = false;
+    epochPublished = false;
+}
+
+uint8_t GPSEpochAssembler::getRequiredParts() {
+    return required;
+}
+
+GPSData &GPSEpochAssembler::beginPart(uint32_t epochKey, bool hasKey) {
+    if (hasKey && (!epochOpen || epochKey != currentKey)) {
+        startEpoch(epochKey);
+    }
+    return working;
+}
+
+void GPSEpochAssembler::startEpoch(uint32_t epochKey) {
+    // The epoch being replaced never got all of its parts
+    previousIncomplete = epochOpen && !epochPublished;
+    if (previousIncomplete) {
+        stats.incomplete++;
+    }
+
+    // Start from a blank record so nothing carries over from the last epoch
+    memset(&working, 0, sizeof(working));
+    currentKey = epochKey;
+    received = 0;
+    epochOpen = true;
+    epochPublished = false;
+}
+
+bool GPSEpochAssembler::completePart(uint8_t part) {
+    updated = false;
+    if (!epochOpen) {
+        return false; // Untimed part before the first timed one
+    }
+
+    received |= (1 << part);
+    if (epochPublished) {
+        // Same epoch, so its fields (fix mode, DOPs) belong to this fix
+        publish();
+        updated = true;
+        return false;
+    }
+    if ((received & required) != required) {
+        return false;
+    }
+
+    publish();
+    epochPublished = true;
+    stats.published++;
+    return true;
+}
+
+bool GPSEpochAssembler::fixUpdated() {
+    return updated;
+}
+
+void GPSEpochAssembler::publish() {
+    // Without a position fix the motion fields mean nothing
+    if (!working.isValid) {
+        working.speed = 0.0;
+        working.course = 0.0;
+    }
+    published = working;
+}
+
+const GPSData &GPSEpochAssembler::getFix() {
+    return published;
+}
+
+const GPSEpochStats &GPSEpochAssembler::getStats() {
+    return stats;
+}
+
+bool GPSEpochAssembler::lastEpochIncomplete() {
+    return previousIncomplete;
+}
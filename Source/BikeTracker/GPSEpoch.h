@@ -0,0 +1,57 @@
+// GPSEpoch.h
+// Assembles per-epoch GPS fixes from the individual sentences or frames
+
+#ifndef GPSEPOCH_H
+#define GPSEPOCH_H
+
+#include <stdint.h>
+#include "GPSData.h"
+
+struct GPSEpochStats {
+    unsigned long published;
+    unsigned long incomplete;   // Epochs superseded before every required part arrived
+};
+
+// The receiver reports one navigation solution per epoch spread over
+// several sentences (RMC, GGA...) or frames (POSLLH, VELNED...). Parts are
+// decoded into a working record that is cleared whenever the epoch key
+// (UTC time or iTOW) changes, and the record is published only once every
+// required part of the same epoch has been seen. A published fix can never
+// mix a position from one second with a speed from another.
+class GPSEpochAssembler {
+public:
+    GPSEpochAssembler();
+    void begin(uint8_t requiredParts);
+    uint8_t getRequiredParts();
+
+    // Returns the record the next part should be decoded into. Parts that
+    // carry no time (VTG, GSA) pass hasKey = false and join the open epoch.
+    GPSData &beginPart(uint32_t epochKey, bool hasKey);
+
+    // Mark a part decoded. Returns true when this completes the epoch.
+    // Parts that arrive after that (GSA follows GGA and RMC) are folded
+    // into the published fix, and fixUpdated() reports it.
+    bool completePart(uint8_t part);
+    bool fixUpdated();
+
+    const GPSData &getFix();
+    const GPSEpochStats &getStats();
+    bool lastEpochIncomplete();
+
+private:
+    GPSData working;
+    GPSData published;
+    uint8_t required;
+    uint8_t received;
+    uint32_t currentKey;
+    bool epochOpen;
+    bool epochPublished;
+    bool updated;               // The last part changed an already published fix
+    bool previousIncomplete;
+    GPSEpochStats stats;
+
+    void startEpoch(uint32_t epochKey);
+    void publish();
+};
+
+#endif // GPSEPOCH_H
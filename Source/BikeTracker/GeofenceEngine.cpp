@@ -0,0 +1,326 @@
+// GeofenceEngine.cpp
+// Implementation of the multi-zone geofence engine
+
+#include "GeofenceEngine.h"
+#include "Distance.h"
+#include <string.h>
+
+// Decimetres per 1e-7 degree of latitude (R = 6371 km), Q24
+static const int32_t DM_PER_E7_Q24 = 1865563;
+
+GeofenceEngine::GeofenceEngine() {
+    eventCallback = NULL;
+    eventContext = NULL;
+    memset(&stats, 0, sizeof(stats));
+    clear();
+}
+
+void GeofenceEngine::clear() {
+    for (uint8_t i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        used[i] = false;
+    }
+    memset(inside, 0, sizeof(inside));
+    vertexCount = 0;
+    haveOrigin = false;
+    rebuildIndex();
+}
+
+int8_t GeofenceEngine::addCircle(const char *name, int32_t latitudeE7, int32_t longitudeE7, float radius,
+                                 unsigned long dwellTime) {
+    if (!haveOrigin) {
+        setOrigin(latitudeE7, longitudeE7);
+    }
+    int8_t id = newZone(name, ZONE_CIRCLE, dwellTime);
+    if (id < 0) {
+        return -1;
+    }
+    Zone &zone = zones[id];
+    project(latitudeE7, longitudeE7, zone.centerX, zone.centerY);
+    int32_t radiusDm = (int32_t)(radius * 10.0 + 0.5);
+    zone.radiusSquared = (int64_t)radiusDm * radiusDm;
+    zone.minX = zone.centerX - radiusDm;
+    zone.maxX = zone.centerX + radiusDm;
+    zone.minY = zone.centerY - radiusDm;
+    zone.maxY = zone.centerY + radiusDm;
+    used[id] = true;
+    rebuildIndex();
+    return id;
+}
+
+int8_t GeofenceEngine::addPolygon(const char *name, const int32_t *latitudesE7, const int32_t *longitudesE7,
+                                  uint8_t count, unsigned long dwellTime) {
+    if (count < 3 || vertexCount + count > GEOFENCE_MAX_VERTICES) {
+        return -1;
+    }
+    if (!haveOrigin) {
+        setOrigin(latitudesE7[0], longitudesE7[0]);
+    }
+    int8_t id = newZone(name, ZONE_POLYGON, dwellTime);
+    if (id < 0) {
+        return -1;
+    }
+    Zone &zone = zones[id];
+    zone.firstVertex = vertexCount;
+    zone.vertexCount = count;
+    for (uint8_t i = 0; i < count; i++) {
+        int32_t x, y;
+        project(latitudesE7[i], longitudesE7[i], x, y);
+        vertexX[vertexCount] = x;
+        vertexY[vertexCount] = y;
+        vertexCount++;
+        if (i == 0 || x < zone.minX) zone.minX = x;
+        if (i == 0 || x > zone.maxX) zone.maxX = x;
+        if (i == 0 || y < zone.minY) zone.minY = y;
+        if (i == 0 || y > zone.maxY) zone.maxY = y;
+    }
+    used[id] = true;
+    rebuildIndex();
+    return id;
+}
+
+int8_t GeofenceEngine::newZone(const char *name, ZoneShape shape, unsigned long dwellTime) {
+    for (uint8_t i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        if (used[i]) {
+            continue;
+        }
+        Zone &zone = zones[i];
+        strncpy(zone.name, name != NULL ? name : "", GEOFENCE_NAME_SIZE - 1);
+        zone.name[GEOFENCE_NAME_SIZE - 1] = '\0';
+        zone.shape = shape;
+        zone.dwellTime = dwellTime;
+        zone.enteredAt = 0;
+        zone.dwelt = false;
+        zone.vertexCount = 0;
+        inside[i / 32] &= ~(1UL << (i % 32));
+        return i;
+    }
+    return -1;
+}
+
+bool GeofenceEngine::remove(uint8_t zone) {
+    if (zone >= GEOFENCE_MAX_ZONES || !used[zone]) {
+        return false;
+    }
+    used[zone] = false;
+    inside[zone / 32] &= ~(1UL << (zone % 32));
+
+    // Close the gap in the vertex pool
+    Zone &removed = zones[zone];
+    if (removed.shape == ZONE_POLYGON) {
+        uint16_t first = removed.firstVertex;
+        uint8_t count = removed.vertexCount;
+        for (uint16_t i = first; i + count < vertexCount; i++) {
+            vertexX[i] = vertexX[i + count];
+            vertexY[i] = vertexY[i + count];
+        }
+        vertexCount -= count;
+        for (uint8_t i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+            if (used[i] && zones[i].shape == ZONE_POLYGON && zones[i].firstVertex > first) {
+                zones[i].firstVertex -= count;
+            }
+        }
+    }
+
+    if (count() == 0) {
+        clear(); // The next zone sets a new origin
+    } else {
+        rebuildIndex();
+    }
+    return true;
+}
+
+uint8_t GeofenceEngine::update(int32_t latitudeE7, int32_t longitudeE7, unsigned long now) {
+    stats.updates++;
+    int32_t x, y;
+    project(latitudeE7, longitudeE7, x, y);
+
+    // Zones near the fix, plus the ones we are inside so exits are seen
+    uint32_t candidates[GEOFENCE_MASK_WORDS];
+    memcpy(candidates, inside, sizeof(candidates));
+    if (!gridEmpty && x >= gridMinX && y >= gridMinY) {
+        int32_t column = (x - gridMinX) / cellWidth;
+        int32_t row = (y - gridMinY) / cellHeight;
+        if (column < GEOFENCE_GRID_SIZE && row < GEOFENCE_GRID_SIZE) {
+            const uint32_t *cell = cells[row * GEOFENCE_GRID_SIZE + column];
+            for (uint8_t w = 0; w < GEOFENCE_MASK_WORDS; w++) {
+                candidates[w] |= cell[w];
+            }
+        }
+    }
+
+    uint8_t events = 0;
+    for (uint8_t w = 0; w < GEOFENCE_MASK_WORDS; w++) {
+        for (uint32_t bits = candidates[w]; bits != 0; bits &= bits - 1) {
+            uint8_t id = w * 32 + __builtin_ctzl(bits);
+            Zone &zone = zones[id];
+            uint32_t bit = 1UL << (id % 32);
+            bool wasInside = (inside[w] & bit) != 0;
+            stats.zoneTests++;
+            bool nowInside = containsPoint(zone, x, y);
+
+            if (nowInside && !wasInside) {
+                inside[w] |= bit;
+                zone.enteredAt = now;
+                zone.dwelt = false;
+                emit(id, ZONE_ENTER);
+                events++;
+            } else if (!nowInside && wasInside) {
+                inside[w] &= ~bit;
+                emit(id, ZONE_EXIT);
+                events++;
+            } else if (nowInside && zone.dwellTime > 0 && !zone.dwelt && now - zone.enteredAt >= zone.dwellTime) {
+                zone.dwelt = true;
+                emit(id, ZONE_DWELL);
+                events++;
+            }
+        }
+    }
+    return events;
+}
+
+void GeofenceEngine::setEventCallback(ZoneEventCallback callback, void *context) {
+    eventCallback = callback;
+    eventContext = context;
+}
+
+bool GeofenceEngine::isInside(uint8_t zone) {
+    return zone < GEOFENCE_MAX_ZONES && (inside[zone / 32] & (1UL << (zone % 32))) != 0;
+}
+
+bool GeofenceEngine::isInsideAny() {
+    for (uint8_t w = 0; w < GEOFENCE_MASK_WORDS; w++) {
+        if (inside[w] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool GeofenceEngine::contains(uint8_t zone, int32_t latitudeE7, int32_t longitudeE7) {
+    if (zone >= GEOFENCE_MAX_ZONES || !used[zone]) {
+        return false;
+    }
+    int32_t x, y;
+    project(latitudeE7, longitudeE7, x, y);
+    return containsPoint(zones[zone], x, y);
+}
+
+uint8_t GeofenceEngine::count() {
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        if (used[i]) {
+            total++;
+        }
+    }
+    return total;
+}
+
+const char *GeofenceEngine::name(uint8_t zone) {
+    return (zone < GEOFENCE_MAX_ZONES && used[zone]) ? zones[zone].name : "";
+}
+
+const GeofenceStats &GeofenceEngine::getStats() {
+    return stats;
+}
+
+const char *GeofenceEngine::eventName(ZoneEventType event) {
+    switch (event) {
+        case ZONE_ENTER: return "enter";
+        case ZONE_EXIT: return "exit";
+        case ZONE_DWELL: return "dwell";
+        default: return "unknown";
+    }
+}
+
+void GeofenceEngine::setOrigin(int32_t latitudeE7, int32_t longitudeE7) {
+    originLat = latitudeE7;
+    originLon = longitudeE7;
+    DistanceReference reference;
+    setDistanceReference(reference, latitudeE7, longitudeE7);
+    latScale = DM_PER_E7_Q24;
+    lonScale = (int32_t)(DM_PER_E7_Q24 * reference.cosLatitude);
+    haveOrigin = true;
+}
+
+void GeofenceEngine::project(int32_t latitudeE7, int32_t longitudeE7, int32_t &x, int32_t &y) {
+    // Differences in 64 bits, so points across the antimeridian or far
+    // from the origin cannot overflow
+    int64_t dLat = (int64_t)latitudeE7 - originLat;
+    int64_t dLon = (int64_t)longitudeE7 - originLon;
+    if (dLon > 1800000000LL) {
+        dLon -= 3600000000LL;
+    } else if (dLon < -1800000000LL) {
+        dLon += 3600000000LL;
+    }
+    x = (int32_t)((dLon * lonScale) >> 24);
+    y = (int32_t)((dLat * latScale) >> 24);
+}
+
+bool GeofenceEngine::containsPoint(const Zone &zone, int32_t x, int32_t y) {
+    if (x < zone.minX || x > zone.maxX || y < zone.minY || y > zone.maxY) {
+        return false;
+    }
+    if (zone.shape == ZONE_CIRCLE) {
+        int64_t dx = x - zone.centerX;
+        int64_t dy = y - zone.centerY;
+        return dx * dx + dy * dy <= zone.radiusSquared;
+    }
+
+    // Crossing number; edge intersections compared by cross-multiplying
+    bool in = false;
+    const int32_t *px = vertexX + zone.firstVertex;
+    const int32_t *py = vertexY + zone.firstVertex;
+    for (uint8_t i = 0, j = zone.vertexCount - 1; i < zone.vertexCount; j = i++) {
+        if ((py[i] > y) != (py[j] > y)) {
+            int64_t lhs = (int64_t)(px[j] - px[i]) * (y - py[i]);
+            int64_t rhs = (int64_t)(x - px[i]) * (py[j] - py[i]);
+            if (py[j] > py[i] ? rhs < lhs : rhs > lhs) {
+                in = !in;
+            }
+        }
+    }
+    return in;
+}
+
+void GeofenceEngine::rebuildIndex() {
+    memset(cells, 0, sizeof(cells));
+    gridEmpty = true;
+    int32_t maxX = 0, maxY = 0;
+    for (uint8_t i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        if (!used[i]) {
+            continue;
+        }
+        if (gridEmpty || zones[i].minX < gridMinX) gridMinX = zones[i].minX;
+        if (gridEmpty || zones[i].minY < gridMinY) gridMinY = zones[i].minY;
+        if (gridEmpty || zones[i].maxX > maxX) maxX = zones[i].maxX;
+        if (gridEmpty || zones[i].maxY > maxY) maxY = zones[i].maxY;
+        gridEmpty = false;
+    }
+    if (gridEmpty) {
+        return;
+    }
+    cellWidth = (maxX - gridMinX) / GEOFENCE_GRID_SIZE + 1;
+    cellHeight = (maxY - gridMinY) / GEOFENCE_GRID_SIZE + 1;
+
+    for (uint8_t i = 0; i < GEOFENCE_MAX_ZONES; i++) {
+        if (!used[i]) {
+            continue;
+        }
+        int32_t firstColumn = (zones[i].minX - gridMinX) / cellWidth;
+        int32_t lastColumn = (zones[i].maxX - gridMinX) / cellWidth;
+        int32_t firstRow = (zones[i].minY - gridMinY) / cellHeight;
+        int32_t lastRow = (zones[i].maxY - gridMinY) / cellHeight;
+        for (int32_t row = firstRow; row <= lastRow; row++) {
+            for (int32_t column = firstColumn; column <= lastColumn; column++) {
+                cells[row * GEOFENCE_GRID_SIZE + column][i / 32] |= 1UL << (i % 32);
+            }
+        }
+    }
+}
+
+void GeofenceEngine::emit(uint8_t zone, ZoneEventType event) {
+    stats.events++;
+    if (eventCallback != NULL) {
+        eventCallback(eventContext, zone, event);
+    }
+}
@@ -0,0 +1,117 @@
+// GeofenceEngine.h
+// Header for the multi-zone geofence engine
+//
+// Zones are circles or polygons, each with a name and an optional dwell
+// time. Coordinates are projected once, when a zone is added, onto a flat
+// local grid in decimetres around an origin (the first zone), so each fix
+// is tested with integer arithmetic only. A uniform grid over the zones'
+// bounding boxes picks the zones near a fix; only those, and the zones the
+// bike is currently inside, are tested. Crossings are reported as enter,
+// exit and dwell events. The projection is equirectangular, so zones
+// should lie within a few tens of kilometres of each other.
+
+#ifndef GEOFENCEENGINE_H
+#define GEOFENCEENGINE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef GEOFENCE_MAX_ZONES
+#define GEOFENCE_MAX_ZONES 16
+#endif
+#ifndef GEOFENCE_MAX_VERTICES
+#define GEOFENCE_MAX_VERTICES 128   // Shared by all polygons
+#endif
+#define GEOFENCE_GRID_SIZE 8        // Index cells per side
+#define GEOFENCE_NAME_SIZE 12
+#define GEOFENCE_MASK_WORDS ((GEOFENCE_MAX_ZONES + 31) / 32)
+
+enum ZoneShape {
+    ZONE_CIRCLE,
+    ZONE_POLYGON
+};
+
+enum ZoneEventType {
+    ZONE_ENTER,
+    ZONE_EXIT,
+    ZONE_DWELL                      // Inside for the zone's dwell time
+};
+
+typedef void (*ZoneEventCallback)(void *context, uint8_t zone, ZoneEventType event);
+
+struct GeofenceStats {
+    unsigned long updates;
+    unsigned long zoneTests;        // Zones actually tested, over all updates
+    unsigned long events;
+};
+
+class GeofenceEngine {
+public:
+    GeofenceEngine();
+
+    // Add a zone; returns its id, or -1 if the table or vertex pool is full
+    int8_t addCircle(const char *name, int32_t latitudeE7, int32_t longitudeE7, float radius,
+                     unsigned long dwellTime = 0);
+    int8_t addPolygon(const char *name, const int32_t *latitudesE7, const int32_t *longitudesE7,
+                      uint8_t count, unsigned long dwellTime = 0);
+    bool remove(uint8_t zone);
+    void clear();
+
+    // Test one fix against the nearby zones. Events go to the callback
+    // as they are found; returns how many there were.
+    uint8_t update(int32_t latitudeE7, int32_t longitudeE7, unsigned long now);
+    void setEventCallback(ZoneEventCallback callback, void *context);
+
+    bool isInside(uint8_t zone);
+    bool isInsideAny();
+    bool contains(uint8_t zone, int32_t latitudeE7, int32_t longitudeE7);  // No state change
+    uint8_t count();
+    const char *name(uint8_t zone);
+    const GeofenceStats &getStats();
+    static const char *eventName(ZoneEventType event);
+
+private:
+    struct Zone {
+        char name[GEOFENCE_NAME_SIZE];
+        ZoneShape shape;
+        int32_t centerX, centerY;   // Circle, dm
+        int64_t radiusSquared;      // Circle, dm²
+        uint16_t firstVertex;       // Polygon, index into vertexX/vertexY
+        uint8_t vertexCount;
+        int32_t minX, minY, maxX, maxY;  // Bounding box, dm
+        unsigned long dwellTime;    // ms, 0 for no dwell event
+        unsigned long enteredAt;
+        bool dwelt;
+    };
+
+    Zone zones[GEOFENCE_MAX_ZONES];
+    bool used[GEOFENCE_MAX_ZONES];
+    uint32_t inside[GEOFENCE_MASK_WORDS];
+    int32_t vertexX[GEOFENCE_MAX_VERTICES];
+    int32_t vertexY[GEOFENCE_MAX_VERTICES];
+    uint16_t vertexCount;
+
+    // Local projection: dm = (difference in 1e-7 degrees * scale) >> 24
+    bool haveOrigin;
+    int32_t originLat, originLon;
+    int32_t latScale, lonScale;
+
+    // Uniform grid over the union of the zones' bounding boxes
+    uint32_t cells[GEOFENCE_GRID_SIZE * GEOFENCE_GRID_SIZE][GEOFENCE_MASK_WORDS];
+    int32_t gridMinX, gridMinY;
+    int32_t cellWidth, cellHeight;
+    bool gridEmpty;
+
+    ZoneEventCallback eventCallback;
+    void *eventContext;
+    GeofenceStats stats;
+
+    int8_t newZone(const char *name, ZoneShape shape, unsigned long dwellTime);
+    void setOrigin(int32_t latitudeE7, int32_t longitudeE7);
+    void project(int32_t latitudeE7, int32_t longitudeE7, int32_t &x, int32_t &y);
+    bool containsPoint(const Zone &zone, int32_t x, int32_t y);
+    void rebuildIndex();
+    void emit(uint8_t zone, ZoneEventType event);
+};
+
+#endif // GEOFENCEENGINE_H
@@ -0,0 +1,46 @@
+// HardwareSerialTransport.cpp
+// Implementation of the hardware UART transport
+
+#include "HardwareSerialTransport.h"
+
+HardwareSerialTransport::HardwareSerialTransport(HardwareSerial &port, size_t rxSize, bool swap)
+    : serial(port), rxBufferSize(rxSize), swapPins(swap) {
+}
+
+void HardwareSerialTransport::begin(long baudrate) {
+    // begin() puts UART0 back on its default pins, so swap after every one
+    serial.end();
+    serial.setRxBufferSize(rxBufferSize);
+    serial.begin(baudrate);
+    if (swapPins) {
+        serial.swap();
+    }
+}
+
+void HardwareSerialTransport::end() {
+    serial.end();
+}
+
+int HardwareSerialTransport::rxAvailable() {
+    return serial.available();
+}
+
+int HardwareSerialTransport::rxRead() {
+    return serial.read();
+}
+
+int HardwareSerialTransport::rxPeek() {
+    return serial.peek();
+}
+
+size_t HardwareSerialTransport::txWrite(const uint8_t *buffer, size_t size) {
+    return serial.write(buffer, size);
+}
+
+void HardwareSerialTransport::txFlush() {
+    serial.flush();
+}
+
+bool HardwareSerialTransport::rxOverflowed() {
+    return serial.hasOverrun();
+}
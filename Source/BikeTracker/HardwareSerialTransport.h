@@ -0,0 +1,32 @@
+// HardwareSerialTransport.h
+// Header for the hardware UART transport
+
+#ifndef HARDWARESERIALTRANSPORT_H
+#define HARDWARESERIALTRANSPORT_H
+
+#include <Arduino.h>
+#include "SerialTransport.h"
+
+class HardwareSerialTransport : public SerialTransport {
+public:
+    // swapPins moves UART0 from GPIO1/3 (USB) to GPIO15/13 (D8/D7)
+    HardwareSerialTransport(HardwareSerial &serial, size_t rxBufferSize, bool swapPins = false);
+    
+    void begin(long baudrate) override;
+    void end() override;
+    
+protected:
+    int rxAvailable() override;
+    int rxRead() override;
+    int rxPeek() override;
+    size_t txWrite(const uint8_t *buffer, size_t size) override;
+    void txFlush() override;
+    bool rxOverflowed() override;
+    
+private:
+    HardwareSerial &serial;
+    size_t rxBufferSize;
+    bool swapPins;
+};
+
+#endif // HARDWARESERIALTRANSPORT_H
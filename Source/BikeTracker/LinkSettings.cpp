@@ -0,0 +1,61 @@
+// LinkSettings.cpp
+// Implementation of persisted serial link settings
+
+#include "LinkSettings.h"
+#include "ModeConfig.h"
+#include <EEPROM.h>
+
+struct StoredLinkSettings {
+    uint32_t magic;
+    int32_t gpsBaud;
+    int32_t gsmBaud;
+    uint32_t check;
+};
+
+LinkSettings::LinkSettings() {
+    gpsBaud = GPS_BAUD_DEFAULT;
+    gsmBaud = GSM_BAUD_DEFAULT;
+}
+
+uint32_t LinkSettings::checksum(uint32_t magic, int32_t gps, int32_t gsm) {
+    return magic ^ ((uint32_t)gps * 31) ^ ((uint32_t)gsm * 17);
+}
+
+bool LinkSettings::load() {
+    StoredLinkSettings stored;
+    EEPROM.begin(LINK_SETTINGS_SIZE);
+    EEPROM.get(LINK_SETTINGS_ADDRESS, stored);
+    EEPROM.end();
+    
+    if (stored.magic != LINK_SETTINGS_MAGIC ||
+        stored.check != checksum(stored.magic, stored.gpsBaud, stored.gsmBaud) ||
+        stored.gpsBaud <= 0 || stored.gsmBaud <= 0) {
+        return false;
+    }
+    
+    gpsBaud = stored.gpsBaud;
+    gsmBaud = stored.gsmBaud;
+    return true;
+}
+
+bool LinkSettings::save() {
+    StoredLinkSettings stored;
+    EEPROM.begin(LINK_SETTINGS_SIZE);
+    EEPROM.get(LINK_SETTINGS_ADDRESS, stored);
+    
+    // Skip the flash write when nothing changed
+    if (stored.magic == LINK_SETTINGS_MAGIC && stored.gpsBaud == gpsBaud && stored.gsmBaud == gsmBaud &&
+        stored.check == checksum(stored.magic, stored.gpsBaud, stored.gsmBaud)) {
+        EEPROM.end();
+        return true;
+    }
+    
+    stored.magic = LINK_SETTINGS_MAGIC;
+    stored.gpsBaud = gpsBaud;
+    stored.gsmBaud = gsmBaud;
+    stored.check = checksum(stored.magic, stored.gpsBaud, stored.gsmBaud);
+    EEPROM.put(LINK_SETTINGS_ADDRESS, stored);
+    bool committed = EEPROM.commit();
+    EEPROM.end();
+    return committed;
+}
@@ -0,0 +1,28 @@
+// LinkSettings.h
+// Header for serial link settings persisted across reboots
+
+#ifndef LINKSETTINGS_H
+#define LINKSETTINGS_H
+
+#include <Arduino.h>
+
+#define LINK_SETTINGS_ADDRESS 0         // EEPROM offset of the record
+#define LINK_SETTINGS_SIZE 64           // EEPROM bytes reserved for link settings
+#define LINK_SETTINGS_MAGIC 0x4C4E4B31  // "LNK1"
+
+class LinkSettings {
+public:
+    LinkSettings();
+    
+    // False (and defaults kept) if nothing valid has been stored yet
+    bool load();
+    bool save();
+    
+    long gpsBaud;
+    long gsmBaud;
+    
+private:
+    uint32_t checksum(uint32_t magic, int32_t gps, int32_t gsm);
+};
+
+#endif // LINKSETTINGS_H
@@ -0,0 +1,249 @@
+// LocationCodec.cpp
+// Implementation of the binary location report encoding
+
+#include "LocationCodec.h"
+#include <string.h>
+
+// Index is the wire code; append only, never reorder
+static const char *const alertNames[] = {
+    "",
+    "MOTION_DETECTED",
+    "SPEED_EXCEEDED",
+    "GEOFENCE_BREACH",
+    "SYSTEM_ERROR",
+    "GPS_LOST",
+    "GSM_LOST"
+};
+static const uint8_t alertNameCount = sizeof(alertNames) / sizeof(alertNames[0]);
+#define LOCATION_ALERT_UNKNOWN 0xFF
+
+uint8_t locationAlertCode(const char *name) {
+    for (uint8_t i = 0; i < alertNameCount; i++) {
+        if (strcmp(name, alertNames[i]) == 0) {
+            return i;
+        }
+    }
+    return LOCATION_ALERT_UNKNOWN;
+}
+
+const char *locationAlertName(uint8_t code) {
+    return code < alertNameCount ? alertNames[code] : "UNKNOWN";
+}
+
+// =============================================================================
+// Encoder
+// =============================================================================
+
+LocationEncoder::LocationEncoder(uint8_t *output, size_t outputCapacity) {
+    buffer = output;
+    capacity = outputCapacity;
+    length = 0;
+    overflow = false;
+    started = false;
+    memset(&previous, 0, sizeof(previous));
+}
+
+void LocationEncoder::begin(const LocationHeader &header) {
+    length = 0;
+    overflow = false;
+    started = false;
+
+    // The IMEI travels as a number; anything but digits is left out
+    size_t imeiLength = strlen(header.imei);
+    uint64_t imei = 0;
+    bool imeiValid = imeiLength > 0 && imeiLength <= LOCATION_CODEC_IMEI_MAX;
+    for (size_t i = 0; imeiValid && i < imeiLength; i++) {
+        if (header.imei[i] < '0' || header.imei[i] > '9') {
+            imeiValid = false;
+        }
+        imei = imei * 10 + (header.imei[i] - '0');
+    }
+
+    size_t idLength = strlen(header.deviceId);
+    if (idLength > LOCATION_CODEC_ID_MAX) {
+        overflow = true;
+        return;
+    }
+
+    putByte(LOCATION_CODEC_MAGIC);
+    putByte(LOCATION_CODEC_VERSION);
+    putByte(imeiValid ? LOCATION_FLAG_IMEI : 0);
+    putByte(header.alertType);
+    putVarint(idLength);
+    for (size_t i = 0; i < idLength; i++) {
+        putByte(header.deviceId[i]);
+    }
+    if (imeiValid) {
+        putVarint(imei);
+    }
+    putByte(header.signalStrength >= 0 && header.signalStrength < 0xFF ? header.signalStrength : 0xFF);
+}
+
+void LocationEncoder::add(const LocationFix &fix) {
+    if (!started) {
+        putVarint(fix.timestamp);
+        putSigned(fix.latitudeE7);
+        putSigned(fix.longitudeE7);
+        started = true;
+    } else {
+        // Signed: fixes replayed after a reboot can go back in time
+        putSigned((int64_t)fix.timestamp - previous.timestamp);
+        putSigned((int64_t)fix.latitudeE7 - previous.latitudeE7);
+        putSigned((int64_t)fix.longitudeE7 - previous.longitudeE7);
+    }
+    previous = fix;
+}
+
+size_t LocationEncoder::size() {
+    return length;
+}
+
+bool LocationEncoder::failed() {
+    return overflow;
+}
+
+void LocationEncoder::putByte(uint8_t value) {
+    if (length >= capacity) {
+        overflow = true;
+        return;
+    }
+    buffer[length++] = value;
+}
+
+void LocationEncoder::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        putByte((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    putByte((uint8_t)value);
+}
+
+void LocationEncoder::putSigned(int64_t value) {
+    putVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+// =============================================================================
+// Decoder
+// =============================================================================
+
+LocationDecoder::LocationDecoder(const uint8_t *input, size_t inputLength) {
+    data = input;
+    length = inputLength;
+    position = 0;
+    error = false;
+    started = false;
+    memset(&previous, 0, sizeof(previous));
+}
+
+bool LocationDecoder::readHeader(LocationHeader &header) {
+    uint8_t magic, flags, signal;
+    uint64_t idLength;
+    position = 0;
+    started = false;
+    error = true;
+
+    if (!getByte(magic) || magic != LOCATION_CODEC_MAGIC ||
+        !getByte(header.version) || header.version != LOCATION_CODEC_VERSION ||
+        !getByte(flags) || !getByte(header.alertType) ||
+        !getVarint(idLength) || idLength > LOCATION_CODEC_ID_MAX || idLength > length - position) {
+        return false;
+    }
+    memcpy(header.deviceId, data + position, idLength);
+    header.deviceId[idLength] = '\0';
+    position += idLength;
+
+    header.imei[0] = '\0';
+    if (flags & LOCATION_FLAG_IMEI) {
+        uint64_t imei;
+        if (!getVarint(imei)) {
+            return false;
+        }
+        // IMEIs are 15 digits; keep leading zeros
+        char digits[LOCATION_CODEC_IMEI_MAX + 1];
+        uint8_t count = 0;
+        do {
+            digits[count++] = '0' + (imei % 10);
+            imei /= 10;
+        } while (imei > 0 && count < LOCATION_CODEC_IMEI_MAX);
+        while (count < 15) {
+            digits[count++] = '0';
+        }
+        for (uint8_t i = 0; i < count; i++) {
+            header.imei[i] = digits[count - 1 - i];
+        }
+        header.imei[count] = '\0';
+    }
+
+    if (!getByte(signal)) {
+        return false;
+    }
+    header.signalStrength = (signal == 0xFF) ? -1 : signal;
+    error = false;
+    return true;
+}
+
+bool LocationDecoder::next(LocationFix &fix) {
+    if (error || position >= length) {
+        return false;
+    }
+
+    error = true;
+    if (!started) {
+        uint64_t timestamp;
+        int64_t latitude, longitude;
+        if (!getVarint(timestamp) || !getSigned(latitude) || !getSigned(longitude)) {
+            return false;
+        }
+        fix.timestamp = (uint32_t)timestamp;
+        fix.latitudeE7 = (int32_t)latitude;
+        fix.longitudeE7 = (int32_t)longitude;
+        started = true;
+    } else {
+        int64_t timestamp, latitude, longitude;
+        if (!getSigned(timestamp) || !getSigned(latitude) || !getSigned(longitude)) {
+            return false;
+        }
+        fix.timestamp = (uint32_t)(previous.timestamp + timestamp);
+        fix.latitudeE7 = (int32_t)(previous.latitudeE7 + latitude);
+        fix.longitudeE7 = (int32_t)(previous.longitudeE7 + longitude);
+    }
+    previous = fix;
+    error = false;
+    return true;
+}
+
+bool LocationDecoder::failed() {
+    return error;
+}
+
+bool LocationDecoder::getByte(uint8_t &value) {
+    if (position >= length) {
+        return false;
+    }
+    value = data[position++];
+    return true;
+}
+
+bool LocationDecoder::getVarint(uint64_t &value) {
+    value = 0;
+    for (uint8_t shift = 0; shift < 64; shift += 7) {
+        uint8_t b;
+        if (!getByte(b)) {
+            return false;
+        }
+        value |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LocationDecoder::getSigned(int64_t &value) {
+    uint64_t raw;
+    if (!getVarint(raw)) {
+        return false;
+    }
+    value = (int64_t)(raw >> 1) ^ -(int64_t)(raw & 1);
+    return true;
+}
@@ -0,0 +1,94 @@
+// LocationCodec.h
+// Compact binary encoding of location reports, with the matching decoder
+//
+// Plain C++ with no Arduino dependency, so servers and tools can build the
+// decoder on Linux from these two files. Layout of version 1, all integers
+// as LEB128 varints unless noted:
+//
+//   header  magic 'L' (byte), version (byte), flags (byte), alert code (byte),
+//           device id length + bytes, IMEI as a number (if LOCATION_FLAG_IMEI),
+//           signal strength (byte, 0xFF unknown)
+//   fix 0   timestamp, latitude, longitude (1e-7 degrees, zigzag)
+//   fix n   timestamp, latitude and longitude as zigzag deltas from fix n-1
+//
+// Fixes run to the end of the payload.
+
+#ifndef LOCATIONCODEC_H
+#define LOCATIONCODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LOCATION_CODEC_MAGIC 0x4C       // 'L'
+#define LOCATION_CODEC_VERSION 1
+#define LOCATION_CODEC_CONTENT_TYPE "application/vnd.biketracker.location.v1"
+#define LOCATION_CODEC_ID_MAX 32        // Longest device id carried
+#define LOCATION_CODEC_IMEI_MAX 19      // Digits that fit a uint64
+#define LOCATION_CODEC_HEADER_MAX (4 + 1 + LOCATION_CODEC_ID_MAX + 10 + 1)
+#define LOCATION_CODEC_FIX_MAX 15       // Three 5-byte varints
+
+#define LOCATION_FLAG_IMEI 0x01
+
+struct LocationHeader {
+    uint8_t version;
+    uint8_t alertType;              // Code from locationAlertCode(), 0 for routine
+    char deviceId[LOCATION_CODEC_ID_MAX + 1];
+    char imei[LOCATION_CODEC_IMEI_MAX + 1];  // Empty if not sent
+    int signalStrength;             // -1 unknown
+};
+
+struct LocationFix {
+    int32_t latitudeE7;
+    int32_t longitudeE7;
+    uint32_t timestamp;             // Device millis() when the fix was taken
+};
+
+// Alert names as used by the JSON API, mapped to one-byte codes
+uint8_t locationAlertCode(const char *name);
+const char *locationAlertName(uint8_t code);
+
+class LocationEncoder {
+public:
+    LocationEncoder(uint8_t *buffer, size_t capacity);
+
+    void begin(const LocationHeader &header);
+    void add(const LocationFix &fix);
+
+    size_t size();
+    bool failed();                  // Buffer too small or bad header
+
+private:
+    uint8_t *buffer;
+    size_t capacity;
+    size_t length;
+    bool overflow;
+    bool started;
+    LocationFix previous;
+
+    void putByte(uint8_t value);
+    void putVarint(uint64_t value);
+    void putSigned(int64_t value);
+};
+
+class LocationDecoder {
+public:
+    LocationDecoder(const uint8_t *data, size_t length);
+
+    bool readHeader(LocationHeader &header);
+    bool next(LocationFix &fix);    // False at the end of the payload or on an error
+    bool failed();
+
+private:
+    const uint8_t *data;
+    size_t length;
+    size_t position;
+    bool error;
+    bool started;
+    LocationFix previous;
+
+    bool getByte(uint8_t &value);
+    bool getVarint(uint64_t &value);
+    bool getSigned(int64_t &value);
+};
+
+#endif // LOCATIONCODEC_H
@@ -0,0 +1,189 @@
+// Lzss.cpp
+// Implementation of the streaming LZSS compressor and decompressor
+
+#include "Lzss.h"
+
+#define LZSS_LITERAL_BITS 9
+#define LZSS_COPY_BITS (1 + LZSS_WINDOW_BITS + LZSS_LENGTH_BITS)
+
+// =============================================================================
+// Encoder
+// =============================================================================
+
+LzssEncoder::LzssEncoder(LzssSink outputSink, void *outputContext) {
+    sink = outputSink;
+    context = outputContext;
+    historyStart = 0;
+    historyCount = 0;
+    pendingCount = 0;
+    bitBuffer = 0;
+    bitCount = 0;
+    started = false;
+}
+
+void LzssEncoder::write(uint8_t value) {
+    if (!started) {
+        sink(context, LZSS_FORMAT);
+        started = true;
+    }
+    // Encode only with a full lookahead so matches can reach their longest
+    if (pendingCount == LZSS_MAX_MATCH) {
+        encodeToken();
+    }
+    pending[pendingCount++] = value;
+}
+
+void LzssEncoder::finish() {
+    if (!started) {
+        sink(context, LZSS_FORMAT);
+        started = true;
+    }
+    while (pendingCount > 0) {
+        encodeToken();
+    }
+    if (bitCount > 0) {
+        sink(context, bitBuffer << (8 - bitCount));
+        bitBuffer = 0;
+        bitCount = 0;
+    }
+}
+
+uint8_t LzssEncoder::byteBack(uint16_t distance, uint8_t offset) {
+    // A copy may run on into the bytes it is producing
+    if (offset < distance) {
+        return history[(historyStart + historyCount - distance + offset) % LZSS_WINDOW_SIZE];
+    }
+    return pending[offset - distance];
+}
+
+void LzssEncoder::encodeToken() {
+    // Longest match in the window, nearest first on ties
+    uint8_t bestLength = 0;
+    uint16_t bestDistance = 0;
+    for (uint16_t distance = 1; distance <= historyCount; distance++) {
+        uint8_t length = 0;
+        while (length < pendingCount && byteBack(distance, length) == pending[length]) {
+            length++;
+        }
+        if (length > bestLength) {
+            bestLength = length;
+            bestDistance = distance;
+            if (length == pendingCount) {
+                break;
+            }
+        }
+    }
+
+    uint8_t consumed;
+    if (bestLength >= LZSS_MIN_MATCH) {
+        putBits(0, 1);
+        putBits(bestDistance - 1, LZSS_WINDOW_BITS);
+        putBits(bestLength - LZSS_MIN_MATCH, LZSS_LENGTH_BITS);
+        consumed = bestLength;
+    } else {
+        putBits(1, 1);
+        putBits(pending[0], 8);
+        consumed = 1;
+    }
+
+    for (uint8_t i = 0; i < consumed; i++) {
+        remember(pending[i]);
+    }
+    for (uint8_t i = consumed; i < pendingCount; i++) {
+        pending[i - consumed] = pending[i];
+    }
+    pendingCount -= consumed;
+}
+
+void LzssEncoder::remember(uint8_t value) {
+    if (historyCount < LZSS_WINDOW_SIZE) {
+        history[(historyStart + historyCount) % LZSS_WINDOW_SIZE] = value;
+        historyCount++;
+    } else {
+        history[historyStart] = value;
+        historyStart = (historyStart + 1) % LZSS_WINDOW_SIZE;
+    }
+}
+
+void LzssEncoder::putBits(uint16_t value, uint8_t count) {
+    while (count-- > 0) {
+        bitBuffer = (bitBuffer << 1) | ((value >> count) & 1);
+        if (++bitCount == 8) {
+            sink(context, bitBuffer);
+            bitBuffer = 0;
+            bitCount = 0;
+        }
+    }
+}
+
+// =============================================================================
+// Decoder
+// =============================================================================
+
+LzssDecoder::LzssDecoder(LzssSink outputSink, void *outputContext) {
+    sink = outputSink;
+    context = outputContext;
+    historyHead = 0;
+    historyCount = 0;
+    bits = 0;
+    bitCount = 0;
+    started = false;
+    error = false;
+}
+
+bool LzssDecoder::write(uint8_t value) {
+    if (error) {
+        return false;
+    }
+    if (!started) {
+        started = true;
+        error = (value != LZSS_FORMAT);
+        return !error;
+    }
+
+    bits = (bits << 8) | value;
+    bitCount += 8;
+
+    // Decode every complete token; a partial one waits for more input
+    while (bitCount > 0) {
+        bool literal = (bits >> (bitCount - 1)) & 1;
+        if (literal) {
+            if (bitCount < LZSS_LITERAL_BITS) {
+                break;
+            }
+            bitCount -= LZSS_LITERAL_BITS;
+            emit((bits >> bitCount) & 0xFF);
+        } else {
+            if (bitCount < LZSS_COPY_BITS) {
+                break;
+            }
+            bitCount -= LZSS_COPY_BITS;
+            uint16_t token = (bits >> bitCount) & ((1 << (LZSS_COPY_BITS - 1)) - 1);
+            uint16_t distance = (token >> LZSS_LENGTH_BITS) + 1;
+            uint8_t length = (token & ((1 << LZSS_LENGTH_BITS) - 1)) + LZSS_MIN_MATCH;
+            if (distance > historyCount) {
+                error = true;
+                return false;
+            }
+            for (uint8_t i = 0; i < length; i++) {
+                emit(history[(historyHead + LZSS_WINDOW_SIZE - distance) % LZSS_WINDOW_SIZE]);
+            }
+        }
+    }
+    bits &= (1UL << bitCount) - 1;
+    return true;
+}
+
+bool LzssDecoder::finish() {
+    // Only zero padding, shorter than any token, may be left over
+    return started && !error && bitCount < 8 && (bits & ((1UL << bitCount) - 1)) == 0;
+}
+
+void LzssDecoder::emit(uint8_t value) {
+    sink(context, value);
+    history[historyHead] = value;
+    historyHead = (historyHead + 1) % LZSS_WINDOW_SIZE;
+    if (historyCount < LZSS_WINDOW_SIZE) {
+        historyCount++;
+    }
+}
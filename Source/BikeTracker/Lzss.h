@@ -0,0 +1,74 @@
+// Lzss.h
+// Small-footprint streaming LZSS compressor and decompressor
+//
+// heatshrink-style bit stream: a 1 bit then 8 bits is a literal byte, a 0
+// bit then LZSS_WINDOW_BITS of distance - 1 and LZSS_LENGTH_BITS of
+// length - LZSS_MIN_MATCH is a copy from the bytes already produced. The
+// stream starts with one byte holding both bit widths and ends with at
+// most 7 zero padding bits. Each side keeps one window of history, so
+// both fit in about 300 bytes. Plain C++, builds on Linux for the server.
+
+#ifndef LZSS_H
+#define LZSS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LZSS_WINDOW_BITS 8
+#define LZSS_LENGTH_BITS 4
+#define LZSS_WINDOW_SIZE (1 << LZSS_WINDOW_BITS)
+#define LZSS_MIN_MATCH 2                // Shorter copies cost more than literals
+#define LZSS_MAX_MATCH (LZSS_MIN_MATCH + (1 << LZSS_LENGTH_BITS) - 1)
+#define LZSS_FORMAT ((LZSS_WINDOW_BITS << 4) | LZSS_LENGTH_BITS)
+#define LZSS_CONTENT_ENCODING "x-lzss"
+
+// Receives each output byte
+typedef void (*LzssSink)(void *context, uint8_t value);
+
+class LzssEncoder {
+public:
+    LzssEncoder(LzssSink sink, void *context);
+
+    void write(uint8_t value);
+    void finish();                  // Encode what is left and flush the bits
+
+private:
+    LzssSink sink;
+    void *context;
+    uint8_t history[LZSS_WINDOW_SIZE];  // Ring of bytes already encoded
+    uint16_t historyStart;          // Oldest byte
+    uint16_t historyCount;
+    uint8_t pending[LZSS_MAX_MATCH];    // Bytes waiting to be encoded
+    uint8_t pendingCount;
+    uint8_t bitBuffer;
+    uint8_t bitCount;
+    bool started;
+
+    void encodeToken();
+    uint8_t byteBack(uint16_t distance, uint8_t offset);
+    void remember(uint8_t value);
+    void putBits(uint16_t value, uint8_t count);
+};
+
+class LzssDecoder {
+public:
+    LzssDecoder(LzssSink sink, void *context);
+
+    bool write(uint8_t value);      // False once the stream is found corrupt
+    bool finish();                  // True if the stream ended cleanly
+
+private:
+    LzssSink sink;
+    void *context;
+    uint8_t history[LZSS_WINDOW_SIZE];
+    uint16_t historyHead;           // Next write position
+    uint16_t historyCount;
+    uint32_t bits;
+    uint8_t bitCount;
+    bool started;
+    bool error;
+
+    void emit(uint8_t value);
+};
+
+#endif // LZSS_H
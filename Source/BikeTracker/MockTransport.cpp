@@ -0,0 +1,98 @@
+// MockTransport.cpp
+// Implementation of the in-memory transport
+
+#include "MockTransport.h"
+#include <string.h>
+
+MockTransport::MockTransport(size_t capacity) {
+    rxCapacity = (capacity > 0 && capacity < MOCK_TRANSPORT_RX_SIZE) ? capacity : MOCK_TRANSPORT_RX_SIZE;
+    rxHead = 0;
+    rxCount = 0;
+    txLength = 0;
+    txBuffer[0] = '\0';
+    overflowFlag = false;
+    baudRate = 0;
+    open = false;
+}
+
+void MockTransport::begin(long baudrate) {
+    baudRate = baudrate;
+    open = true;
+}
+
+void MockTransport::end() {
+    open = false;
+}
+
+size_t MockTransport::inject(const uint8_t *data, size_t length) {
+    size_t accepted = 0;
+    while (accepted < length && rxCount < rxCapacity) {
+        rxBuffer[(rxHead + rxCount) % rxCapacity] = data[accepted++];
+        rxCount++;
+    }
+    if (accepted < length) {
+        overflowFlag = true;
+    }
+    return accepted;
+}
+
+size_t MockTransport::inject(const char *text) {
+    return inject((const uint8_t *)text, strlen(text));
+}
+
+const char *MockTransport::sentText() {
+    return txBuffer;
+}
+
+size_t MockTransport::sentLength() {
+    return txLength;
+}
+
+void MockTransport::clearSent() {
+    txLength = 0;
+    txBuffer[0] = '\0';
+}
+
+long MockTransport::getBaudRate() {
+    return baudRate;
+}
+
+bool MockTransport::isOpen() {
+    return open;
+}
+
+int MockTransport::rxAvailable() {
+    return rxCount;
+}
+
+int MockTransport::rxRead() {
+    if (rxCount == 0) {
+        return -1;
+    }
+    uint8_t b = rxBuffer[rxHead];
+    rxHead = (rxHead + 1) % rxCapacity;
+    rxCount--;
+    return b;
+}
+
+int MockTransport::rxPeek() {
+    return rxCount > 0 ? rxBuffer[rxHead] : -1;
+}
+
+size_t MockTransport::txWrite(const uint8_t *buffer, size_t size) {
+    // Like a real port, writes always "succeed"; the capture just truncates
+    for (size_t i = 0; i < size && txLength < MOCK_TRANSPORT_TX_SIZE; i++) {
+        txBuffer[txLength++] = buffer[i];
+    }
+    txBuffer[txLength] = '\0';
+    return size;
+}
+
+void MockTransport::txFlush() {
+}
+
+bool MockTransport::rxOverflowed() {
+    bool overflowed = overflowFlag;
+    overflowFlag = false;
+    return overflowed;
+}
@@ -0,0 +1,57 @@
+// MockTransport.h
+// Header for an in-memory transport used to exercise the drivers off-device
+//
+// Builds on the board and, against the Arduino core stand-in in
+// test/host, on a Linux host; see test/test_transport.cpp.
+
+#ifndef MOCKTRANSPORT_H
+#define MOCKTRANSPORT_H
+
+#include <Arduino.h>
+#include "SerialTransport.h"
+
+#define MOCK_TRANSPORT_RX_SIZE 512
+#define MOCK_TRANSPORT_TX_SIZE 512
+
+class MockTransport : public SerialTransport {
+public:
+    // rxCapacity below MOCK_TRANSPORT_RX_SIZE simulates a small driver buffer
+    MockTransport(size_t rxCapacity = MOCK_TRANSPORT_RX_SIZE);
+    
+    void begin(long baudrate) override;
+    void end() override;
+    
+    // Test side: bytes "arriving on the wire". Whatever does not fit is
+    // dropped and reported as an overflow. Returns the bytes accepted.
+    size_t inject(const uint8_t *data, size_t length);
+    size_t inject(const char *text);
+    
+    // Everything the driver wrote since the last clearSent()
+    const char *sentText();
+    size_t sentLength();
+    void clearSent();
+    
+    long getBaudRate();
+    bool isOpen();
+    
+protected:
+    int rxAvailable() override;
+    int rxRead() override;
+    int rxPeek() override;
+    size_t txWrite(const uint8_t *buffer, size_t size) override;
+    void txFlush() override;
+    bool rxOverflowed() override;
+    
+private:
+    uint8_t rxBuffer[MOCK_TRANSPORT_RX_SIZE];
+    size_t rxCapacity;
+    size_t rxHead;
+    size_t rxCount;
+    char txBuffer[MOCK_TRANSPORT_TX_SIZE + 1];
+    size_t txLength;
+    bool overflowFlag;
+    long baudRate;
+    bool open;
+};
+
+#endif // MOCKTRANSPORT_H
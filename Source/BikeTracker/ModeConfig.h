@@ -15,7 +15,7 @@
 #if CURRENT_MODE == MODE_TESTING
     #define DEBUG_ENABLED true
     #define GPS_UPDATE_INTERVAL 5000      // 5 seconds for testing
-    #define SMS_ALERT_INTERVAL 30000      // 30 seconds for testing
+    #define SMS_ALERT_INTERVAL 30000      // Alert token refill per type, 30 seconds for testing
     #define MOTION_THRESHOLD 5            // Lower threshold for testing
     #define MAX_SPEED_THRESHOLD 10        // km/h for testing alerts
     #define SLEEP_TIMEOUT 300000          // 5 minutes for testing
@@ -28,7 +28,7 @@
 #else
     #define DEBUG_ENABLED false
     #define GPS_UPDATE_INTERVAL 60000     // 1 minute for production
-    #define SMS_ALERT_INTERVAL 300000     // 5 minutes for production
+    #define SMS_ALERT_INTERVAL 300000     // Alert token refill per type, 5 minutes for production
     #define MOTION_THRESHOLD 15           // Higher threshold for production
     #define MAX_SPEED_THRESHOLD 80        // km/h for production alerts
     #define SLEEP_TIMEOUT 1800000         // 30 minutes for production
@@ -40,6 +40,69 @@
     #define GPS_NMEA_DISPLAY false        // Disable raw NMEA in production
 #endif
 
+// GPS receiver protocol: UBX binary output (NAV-POSLLH/VELNED/TIMEUTC only)
+// is several times smaller per epoch than NMEA. Falls back to NMEA if the
+// receiver does not acknowledge the configuration.
+#define GPS_UBX_PROTOCOL false
+
+// A published fix older than this is treated as no fix (ms)
+#define GPS_FIX_MAX_AGE 5000
+
+// Alert pipeline, see AlertQueue.h. Each alert type has its own token
+// bucket: ALERT_RATE_BURST alerts at once, then one per SMS_ALERT_INTERVAL.
+// Repeats of an alert still waiting to be sent are merged, not counted.
+#define ALERT_RATE_BURST 2
+#define ALERT_SMS_ATTEMPTS 3          // Tries per alert SMS before it is given up
+#define ALERT_SMS_RETRY_DELAY 30000   // Wait after a failed alert SMS (ms)
+
+// Motion detection while armed, see MotionDetector.h. A fix is displaced
+// when it lies MOTION_THRESHOLD beyond twice the error of both itself and
+// the averaged parked position; motion needs several displaced fixes in a row.
+#define MOTION_HDOP_METRES 5.0        // Position error per unit of HDOP (m)
+#define MOTION_MAX_HDOP 5.0           // Fixes with a worse HDOP are ignored
+#define MOTION_MIN_SATELLITES 4
+#define MOTION_CONFIRM_FIXES 3        // Displaced fixes in a row that confirm motion
+#define MOTION_SPEED 6.0              // km/h from the receiver that corroborates a displacement
+#define MOTION_SPEED_CONFIRM_FIXES 2  // Displaced fixes in a row at MOTION_SPEED that confirm motion
+#define MOTION_ANCHOR_FIXES 30        // Parked position averages about this many HDOP 1 fixes
+
+// initialize() returns once GSM is up; the first fix is waited for in the
+// background for this long before the tracker reports TRACKER_ERROR (ms)
+#define GPS_FIX_WAIT_TIMEOUT 60000
+
+// Security checks, alert processing and report sampling run this often.
+// GPS and modem servicing run on every scheduler pass (ms)
+#define MONITOR_INTERVAL 100
+
+// Serial link rates. Both modules power up at the defaults; at startup the
+// links are probed and raised to the fastest candidate that verifies
+// cleanly over SoftwareSerial. The result is kept in EEPROM (LinkSettings).
+#define BAUD_NEGOTIATION_ENABLED true
+#define GPS_BAUD_DEFAULT 9600
+#define GSM_BAUD_DEFAULT 9600
+#define LINK_BAUD_CANDIDATES { 57600, 38400, 19200, 9600 }  // Fastest first
+#define GPS_BAUD_PROBE_WINDOW 1500    // ms to listen for valid sentences per rate
+#define GPS_BAUD_VERIFY_WINDOW 3000   // ms of clean traffic required after a switch
+#define GSM_BAUD_VERIFY_ROUNDS 5      // Consecutive "AT" round trips required after a switch
+
+// Serial receive buffers. SoftwareSerial captures bit edges in an ISR
+// buffer (4 bytes per edge, roughly 5 edges per byte) and decodes them
+// into the byte buffer when the port is read, so the ISR buffer sets how
+// long a port can go unserviced before data is lost.
+#define GPS_RX_BUFFER_SIZE 512        // Bytes, several NMEA epochs
+#define GPS_ISR_BUFFER_SIZE 1024      // Bit edges
+#define GSM_RX_BUFFER_SIZE 256        // Bytes, a full HTTPREAD chunk
+#define GSM_ISR_BUFFER_SIZE 512       // Bit edges (SoftwareSerial only)
+
+// Signal quality (AT+CSQ) is sampled in the background while the modem is
+// idle; location reports use the last sample instead of querying
+#define GSM_SIGNAL_SAMPLE_INTERVAL 60000
+
+// GPRS bearer state is trusted for this long after the last AT+SAPBR=2,1
+// or successful transfer before it is queried again. Deactivation URCs and
+// failed requests invalidate it sooner.
+#define GSM_BEARER_CACHE_TTL 120000
+
 // Emergency contact (modify for production use)
 #if CURRENT_MODE == MODE_TESTING
     #define EMERGENCY_CONTACT "+639634905586"  // Test number
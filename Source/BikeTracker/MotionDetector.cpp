@@ -0,0 +1,137 @@
+// MotionDetector.cpp
+// Implementation of GPS motion detection while parked
+
+#include "MotionDetector.h"
+#include <math.h>
+#include <string.h>
+
+MotionDetector::MotionDetector(const MotionParameters &parameters) : params(parameters) {
+    memset(&stats, 0, sizeof(stats));
+    reset();
+}
+
+void MotionDetector::reset() {
+    haveAnchor = false;
+    setDistanceReference(anchor, 0, 0);
+    anchorWeight = 0;
+    displacedFixes = 0;
+    fastFixes = 0;
+    radius = 0;
+    lastDistance = 0;
+}
+
+bool MotionDetector::update(const GPSData &fix) {
+    stats.fixes++;
+    float error, weight;
+    if (!fix.isValid || !fixError(fix, error, weight)) {
+        stats.rejected++;
+        return false; // Neither confirms nor breaks a run of displaced fixes
+    }
+    if (!haveAnchor) {
+        restartAnchor(fix, weight);
+        return false;
+    }
+
+    lastDistance = distanceFrom(anchor, fix.latitudeE7, fix.longitudeE7);
+    radius = params.distance + 2.0 * (error + 1.0 / sqrt(anchorWeight));
+
+    if (lastDistance <= radius) {
+        // Still in place: fold the fix into the weighted mean. The weight
+        // is capped, so the anchor keeps following slow drift.
+        float share = weight / (anchorWeight + weight);
+        int32_t latitude = anchor.latitudeE7 + (int32_t)((float)((int64_t)fix.latitudeE7 - anchor.latitudeE7) * share);
+        int32_t longitude = anchor.longitudeE7 + (int32_t)((float)((int64_t)fix.longitudeE7 - anchor.longitudeE7) * share);
+        setDistanceReference(anchor, latitude, longitude);
+        float maxWeight = params.anchorFixes / (params.hdopMetres * params.hdopMetres);
+        anchorWeight += weight;
+        if (anchorWeight > maxWeight) {
+            anchorWeight = maxWeight;
+        }
+        displacedFixes = 0;
+        fastFixes = 0;
+        return false;
+    }
+
+    // Displaced fixes never move the anchor, so a slow push cannot drag it along
+    stats.displaced++;
+    if (displacedFixes < 255) {
+        displacedFixes++;
+    }
+    if (fix.speed >= params.speed) {
+        if (fastFixes < 255) {
+            fastFixes++;
+        }
+    } else {
+        fastFixes = 0;
+    }
+
+    bool corroborated = fastFixes >= params.speedConfirmFixes;
+    if (displacedFixes < params.confirmFixes && !corroborated) {
+        return false;
+    }
+    stats.detections++;
+    if (displacedFixes < params.confirmFixes) {
+        stats.corroborated++;
+    }
+    restartAnchor(fix, weight);
+    return true;
+}
+
+bool MotionDetector::fixError(const GPSData &fix, float &error, float &weight) {
+    float satellites = 1.0;
+    if (fix.accuracy > 0) {
+        // UBX mode: the receiver's own estimate, no HDOP or satellite count
+        error = fix.accuracy;
+    } else if (fix.hdop > 0) {
+        if (fix.satellites < params.minSatellites) {
+            return false;
+        }
+        error = fix.hdop * params.hdopMetres;
+        int used = fix.satellites < MOTION_MAX_SATELLITES ? fix.satellites : MOTION_MAX_SATELLITES;
+        satellites = (float)used / MOTION_REFERENCE_SATELLITES;
+    } else {
+        return false; // No quality information
+    }
+    if (error > params.maxHdop * params.hdopMetres) {
+        return false;
+    }
+    // Inverse variance; a minimum error keeps one perfect fix from
+    // outweighing all the others
+    if (error < params.hdopMetres * 0.5) {
+        error = params.hdopMetres * 0.5;
+    }
+    weight = satellites / (error * error);
+    return true;
+}
+
+void MotionDetector::restartAnchor(const GPSData &fix, float weight) {
+    haveAnchor = true;
+    setDistanceReference(anchor, fix.latitudeE7, fix.longitudeE7);
+    anchorWeight = weight;
+    displacedFixes = 0;
+    fastFixes = 0;
+}
+
+bool MotionDetector::hasAnchor() {
+    return haveAnchor;
+}
+
+float MotionDetector::getRadius() {
+    return radius;
+}
+
+float MotionDetector::getLastDistance() {
+    return lastDistance;
+}
+
+void MotionDetector::setParameters(const MotionParameters &parameters) {
+    params = parameters;
+}
+
+const MotionParameters &MotionDetector::getParameters() {
+    return params;
+}
+
+const MotionStats &MotionDetector::getStats() {
+    return stats;
+}
@@ -0,0 +1,74 @@
+// MotionDetector.h
+// Header for GPS motion detection while parked
+//
+// Consecutive fixes of a parked bike wander by several metres, more when
+// HDOP is poor, so comparing each fix with the previous one raises false
+// alerts. Instead, good fixes are averaged into an anchor, each weighted
+// by its expected accuracy (HDOP and satellites, or the UBX estimate). A
+// fix counts as displaced when it lies further from the anchor than the
+// threshold plus twice the error of both; motion is confirmed only after
+// several displaced fixes in a row, or fewer when the receiver's speed
+// agrees.
+// Each fix costs O(1): one distance and a running weighted mean.
+
+#ifndef MOTIONDETECTOR_H
+#define MOTIONDETECTOR_H
+
+#include <Arduino.h>
+#include "GPSData.h"
+#include "Distance.h"
+
+#define MOTION_REFERENCE_SATELLITES 8   // Satellite count that HDOP weights are scaled to
+#define MOTION_MAX_SATELLITES 12        // More than this adds no weight
+
+struct MotionParameters {
+    float distance;                 // Metres beyond twice both error estimates
+    float hdopMetres;               // Position error per unit of HDOP
+    float maxHdop;                  // Worse fixes are ignored
+    uint8_t minSatellites;
+    uint8_t confirmFixes;           // Displaced fixes in a row that confirm motion
+    float speed;                    // km/h that corroborates a displacement
+    uint8_t speedConfirmFixes;      // The same, when every one is at least speed
+    uint8_t anchorFixes;            // Anchor weight is capped at this many HDOP 1 fixes
+};
+
+struct MotionStats {
+    unsigned long fixes;
+    unsigned long rejected;         // Too few satellites or too inaccurate
+    unsigned long displaced;
+    unsigned long detections;
+    unsigned long corroborated;     // Detections confirmed early by speed
+};
+
+class MotionDetector {
+public:
+    MotionDetector(const MotionParameters &parameters);
+
+    // Offer one new fix; true when it confirms motion. The anchor then
+    // restarts at this fix.
+    bool update(const GPSData &fix);
+    void reset();                   // Forget the anchor, e.g. when arming
+
+    bool hasAnchor();
+    float getRadius();              // Metres, displacement threshold at the last fix
+    float getLastDistance();        // Metres from the anchor to the last fix
+    void setParameters(const MotionParameters &parameters);
+    const MotionParameters &getParameters();
+    const MotionStats &getStats();
+
+private:
+    MotionParameters params;
+    bool haveAnchor;
+    DistanceReference anchor;
+    float anchorWeight;             // Sum of fix weights, 1/m²
+    uint8_t displacedFixes;         // In a row
+    uint8_t fastFixes;              // Displaced and at speed, in a row
+    float radius;
+    float lastDistance;
+    MotionStats stats;
+
+    bool fixError(const GPSData &fix, float &error, float &weight);
+    void restartAnchor(const GPSData &fix, float weight);
+};
+
+#endif // MOTIONDETECTOR_H
@@ -2,23 +2,44 @@
 // Implementation for Neo6m GPS module
 
 #include "Neo6mGPS.h"
+#include "Coordinates.h"
+#include "ModeConfig.h"
 
-Neo6mGPS::Neo6mGPS(SoftwareSerial &serial) : gpsSerial(serial) {
+Neo6mGPS::Neo6mGPS(SerialTransport &serial) : gpsSerial(serial) {
     currentData.isValid = false;
-    currentData.latitude = 0.0;
-    currentData.longitude = 0.0;
+    currentData.latitudeE7 = 0;
+    currentData.longitudeE7 = 0;
     currentData.altitude = 0.0;
     currentData.speed = 0.0;
+    currentData.course = 0.0;
     currentData.satellites = 0;
     currentData.hdop = 0.0;
+    currentData.pdop = 0.0;
+    currentData.vdop = 0.0;
+    currentData.accuracy = 0.0;
+    currentData.fixMode = 0;
+    currentData.timestamp[0] = '\0';
+    epoch.begin((1 << NMEA_GGA) | (1 << NMEA_RMC));
+    latestFixTime = 0;
+    fixCount = 0;
+    protocol = GPS_PROTOCOL_NMEA;
+    baudRate = 9600;
     rawData = "";
 }
 
-void Neo6mGPS::begin(long baudrate) {
-    gpsSerial.begin(baudrate);
+void Neo6mGPS::begin(long baudrate, GPSProtocol requestedProtocol) {
+    openPort(baudrate);
     delay(1000);
+    
+    if (requestedProtocol == GPS_PROTOCOL_UBX && enableUBXMode()) {
+        epoch.begin((1 << UBX_NAV_POSLLH) | (1 << UBX_NAV_VELNED) | (1 << UBX_NAV_TIMEUTC));
+        return;
+    }
+    
+    // NMEA mode (also the fallback if the receiver did not ACK the UBX setup)
     enableGGA();
     enableRMC();
+    epoch.begin((1 << NMEA_GGA) | (1 << NMEA_RMC));
 }
 
 void Neo6mGPS::enableGGA() {
@@ -31,6 +52,203 @@ void Neo6mGPS::enableRMC() {
     delay(100);
 }
 
+bool Neo6mGPS::enableUBXMode() {
+    // Only the three NAV messages GPSData needs, once per navigation epoch
+    const uint8_t navMessages[] = { UBX_NAV_POSLLH_ID, UBX_NAV_VELNED_ID, UBX_NAV_TIMEUTC_ID };
+    for (uint8_t i = 0; i < sizeof(navMessages); i++) {
+        uint8_t cfgMsg[3] = { UBX_CLASS_NAV, navMessages[i], 1 };
+        sendUBX(UBX_CLASS_CFG, UBX_CFG_MSG_ID, cfgMsg, sizeof(cfgMsg));
+        if (!waitForUBXAck(UBX_CLASS_CFG, UBX_CFG_MSG_ID, 1000)) {
+            return false;
+        }
+    }
+    
+    // Keep the current baud rate but only emit UBX. This silences every
+    // NMEA sentence.
+    sendPortConfig(baudRate, UBX_PROTO_UBX);
+    
+    // Switch parsers before the ACK so it is read as UBX
+    protocol = GPS_PROTOCOL_UBX;
+    if (!waitForUBXAck(UBX_CLASS_CFG, UBX_CFG_PRT_ID, 1000)) {
+        protocol = GPS_PROTOCOL_NMEA;
+        return false;
+    }
+    return true;
+}
+
+void Neo6mGPS::sendPortConfig(long rate, uint8_t outProtoMask) {
+    // CFG-PRT for UART1: 8N1 at the given rate, accept UBX and NMEA input
+    uint8_t cfgPrt[20] = { 0 };
+    cfgPrt[0] = 1;                              // portID: UART1
+    cfgPrt[4] = 0xD0;                           // mode: 8 data bits, no parity, 1 stop bit
+    cfgPrt[5] = 0x08;
+    cfgPrt[8] = rate & 0xFF;
+    cfgPrt[9] = (rate >> 8) & 0xFF;
+    cfgPrt[10] = (rate >> 16) & 0xFF;
+    cfgPrt[11] = (rate >> 24) & 0xFF;
+    cfgPrt[12] = UBX_PROTO_UBX | UBX_PROTO_NMEA; // inProtoMask
+    cfgPrt[14] = outProtoMask;
+    sendUBX(UBX_CLASS_CFG, UBX_CFG_PRT_ID, cfgPrt, sizeof(cfgPrt));
+}
+
+void Neo6mGPS::sendUBX(uint8_t msgClass, uint8_t msgId, const uint8_t *payload, uint16_t length) {
+    uint8_t frame[UBX_MAX_PAYLOAD + UBX_FRAME_OVERHEAD];
+    size_t frameLength = UbxParser::buildFrame(msgClass, msgId, payload, length, frame);
+    gpsSerial.write(frame, frameLength);
+}
+
+bool Neo6mGPS::waitForUBXAck(uint8_t msgClass, uint8_t msgId, unsigned long timeout) {
+    unsigned long startTime = millis();
+    while (millis() - startTime < timeout) {
+        while (gpsSerial.available()) {
+            UbxMessageType type = ubxParser.encode(gpsSerial.read());
+            if (ubxParser.isAckFor(msgClass, msgId) && (type == UBX_ACK_ACK || type == UBX_ACK_NAK)) {
+                return type == UBX_ACK_ACK;
+            }
+        }
+        delay(10);
+    }
+    return false;
+}
+
+GPSProtocol Neo6mGPS::getProtocol() {
+    return protocol;
+}
+
+long Neo6mGPS::getBaudRate() {
+    return baudRate;
+}
+
+void Neo6mGPS::openPort(long rate) {
+    gpsSerial.end();
+    gpsSerial.begin(rate);
+    baudRate = rate;
+    while (gpsSerial.available()) {
+        gpsSerial.read();
+    }
+}
+
+void Neo6mGPS::setReceiverBaud(long rate) {
+    // The receiver switches as soon as the command is processed, there is
+    // no ACK at either rate to wait for
+    uint8_t outProto = (protocol == GPS_PROTOCOL_UBX) ? UBX_PROTO_UBX : (UBX_PROTO_UBX | UBX_PROTO_NMEA);
+    sendPortConfig(rate, outProto);
+    delay(100);
+    openPort(rate);
+}
+
+unsigned long Neo6mGPS::acceptedFrames() {
+    unsigned long total = ubxParser.getStats().accepted;
+    for (int i = 0; i < NMEA_SENTENCE_TYPES; i++) {
+        total += parser.getStats((NmeaSentenceType)i).accepted;
+    }
+    return total;
+}
+
+unsigned long Neo6mGPS::rejectedFrames() {
+    unsigned long total = ubxParser.getStats().badChecksum;
+    for (int i = 0; i < NMEA_SENTENCE_TYPES; i++) {
+        const NmeaSentenceStats &stats = parser.getStats((NmeaSentenceType)i);
+        total += stats.badChecksum + stats.truncated + stats.overflowed;
+    }
+    return total;
+}
+
+void Neo6mGPS::listen(unsigned long duration, unsigned long &bytes, unsigned long &frames, unsigned long &errors) {
+    unsigned long acceptedBefore = acceptedFrames();
+    unsigned long rejectedBefore = rejectedFrames();
+    unsigned long overflowsBefore = gpsSerial.getStats().overflows;
+    bytes = 0;
+    
+    unsigned long startTime = millis();
+    while (millis() - startTime < duration) {
+        while (gpsSerial.available()) {
+            uint8_t b = gpsSerial.read();
+            bytes++;
+            processByte(b);
+            
+            // The receiver may be in either output mode before begin(),
+            // so the inactive parser gets the bytes too
+            if (protocol == GPS_PROTOCOL_UBX) {
+                parser.encode(b);
+            } else {
+                ubxParser.encode(b);
+            }
+        }
+        delay(5);
+    }
+    
+    frames = acceptedFrames() - acceptedBefore;
+    errors = (rejectedFrames() - rejectedBefore) + (gpsSerial.getStats().overflows - overflowsBefore);
+}
+
+void Neo6mGPS::measureLink(unsigned long duration, unsigned long &bytes, unsigned long &frames, unsigned long &errors) {
+    listen(duration, bytes, frames, errors);
+}
+
+bool Neo6mGPS::probeBaud(long rate) {
+    // Any checksummed sentence or frame means the rate is right, garbage
+    // at the wrong rate never passes the checksum
+    openPort(rate);
+    unsigned long bytes, frames, errors;
+    listen(GPS_BAUD_PROBE_WINDOW, bytes, frames, errors);
+    return frames > 0;
+}
+
+bool Neo6mGPS::verifyBaud() {
+    // Stricter than a probe: steady traffic with no corruption or loss
+    unsigned long bytes, frames, errors;
+    listen(GPS_BAUD_VERIFY_WINDOW, bytes, frames, errors);
+    return frames >= 3 && errors == 0;
+}
+
+long Neo6mGPS::findBaud(long preferredRate, const long *rates, uint8_t count) {
+    if (probeBaud(preferredRate)) {
+        return preferredRate;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (rates[i] != preferredRate && probeBaud(rates[i])) {
+            return rates[i];
+        }
+    }
+    return 0;
+}
+
+long Neo6mGPS::negotiateBaud(long preferredRate, const long *rates, uint8_t count) {
+    long current = findBaud(preferredRate, rates, count);
+    if (current == 0) {
+        openPort(preferredRate); // Receiver silent, nothing to negotiate
+        return 0;
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+        if (rates[i] <= current) {
+            continue;
+        }
+        
+        setReceiverBaud(rates[i]);
+        if (verifyBaud()) {
+            return rates[i];
+        }
+        
+        // Too fast for the link. Our TX usually still gets through at the
+        // new rate, so ask the receiver to step back; search if it didn't
+        setReceiverBaud(current);
+        if (!probeBaud(current)) {
+            current = findBaud(current, rates, count);
+            if (current == 0) {
+                openPort(preferredRate);
+                return 0;
+            }
+        }
+    }
+    return current;
+}
+
+const UbxStats &Neo6mGPS::getUBXStats() {
+    return ubxParser.getStats();
+}
+
 bool Neo6mGPS::available() {
     return gpsSerial.available();
 }
@@ -52,121 +270,83 @@ String Neo6mGPS::read() {
 }
 
 GPSData Neo6mGPS::parseGPSData() {
-    while (gpsSerial.available()) {
-        String sentence = read();
-        if (sentence.length() > 0) {
-            if (sentence.startsWith("$GPGGA") || sentence.startsWith("$GNGGA")) {
-                parseGGA(sentence);
-            } else if (sentence.startsWith("$GPRMC") || sentence.startsWith("$GNRMC")) {
-                parseRMC(sentence);
-            }
-        }
-    }
+    poll();
     return currentData;
 }
 
-bool Neo6mGPS::parseGGA(String sentence) {
-    // Parse GGA sentence: $GPGGA,time,lat,lat_dir,lon,lon_dir,quality,satellites,hdop,altitude,alt_unit,geoid_height,geoid_unit,checksum
-    int commaIndex[14];
-    int commaCount = 0;
-    
-    for (int i = 0; i < sentence.length() && commaCount < 14; i++) {
-        if (sentence.charAt(i) == ',') {
-            commaIndex[commaCount++] = i;
-        }
-    }
-    
-    if (commaCount >= 6) {
-        String quality = sentence.substring(commaIndex[5] + 1, commaIndex[6]);
-        if (quality.toInt() > 0) {
-            currentData.isValid = true;
-            
-            // Parse latitude
-            String latStr = sentence.substring(commaIndex[1] + 1, commaIndex[2]);
-            String latDir = sentence.substring(commaIndex[2] + 1, commaIndex[3]);
-            if (latStr.length() > 0) {
-                currentData.latitude = convertDMSToDecimal(latStr, latDir);
-            }
-            
-            // Parse longitude
-            String lonStr = sentence.substring(commaIndex[3] + 1, commaIndex[4]);
-            String lonDir = sentence.substring(commaIndex[4] + 1, commaIndex[5]);
-            if (lonStr.length() > 0) {
-                currentData.longitude = convertDMSToDecimal(lonStr, lonDir);
-            }
-            
-            // Parse satellites
-            if (commaCount >= 7) {
-                String satStr = sentence.substring(commaIndex[6] + 1, commaIndex[7]);
-                currentData.satellites = satStr.toInt();
-            }
-            
-            // Parse HDOP
-            if (commaCount >= 8) {
-                String hdopStr = sentence.substring(commaIndex[7] + 1, commaIndex[8]);
-                currentData.hdop = hdopStr.toFloat();
-            }
-            
-            // Parse altitude
-            if (commaCount >= 9) {
-                String altStr = sentence.substring(commaIndex[8] + 1, commaIndex[9]);
-                currentData.altitude = altStr.toFloat();
-            }
-        } else {
-            currentData.isValid = false;
-        }
+void Neo6mGPS::poll() {
+    // The transport counts bytes and RX overflows
+    while (gpsSerial.available()) {
+        processByte(gpsSerial.read());
     }
-    return currentData.isValid;
 }
 
-bool Neo6mGPS::parseRMC(String sentence) {
-    // Parse RMC sentence: $GPRMC,time,status,lat,lat_dir,lon,lon_dir,speed,course,date,checksum
-    int commaIndex[12];
-    int commaCount = 0;
-    
-    for (int i = 0; i < sentence.length() && commaCount < 12; i++) {
-        if (sentence.charAt(i) == ',') {
-            commaIndex[commaCount++] = i;
+void Neo6mGPS::processByte(uint8_t b) {
+    if (protocol == GPS_PROTOCOL_UBX) {
+        UbxMessageType type = ubxParser.encode(b);
+        if (type == UBX_NAV_POSLLH || type == UBX_NAV_VELNED || type == UBX_NAV_TIMEUTC) {
+            // Every NAV frame carries the epoch's iTOW
+            GPSData &record = epoch.beginPart(ubxParser.lastTimeOfWeek(), true);
+            ubxParser.decode(record);
+            completePart(type);
         }
-    }
-    
-    if (commaCount >= 7) {
-        String status = sentence.substring(commaIndex[1] + 1, commaIndex[2]);
-        if (status == "A") { // Active (valid)
-            // Parse speed (knots)
-            String speedStr = sentence.substring(commaIndex[6] + 1, commaIndex[7]);
-            if (speedStr.length() > 0) {
-                currentData.speed = speedStr.toFloat() * 1.852; // Convert knots to km/h
-            }
-            
-            // Parse timestamp
-            String timeStr = sentence.substring(commaIndex[0] + 1, commaIndex[1]);
-            String dateStr = sentence.substring(commaIndex[8] + 1, commaIndex[9]);
-            currentData.timestamp = timeStr + " " + dateStr;
+    } else {
+        NmeaSentenceType type = parser.encode(b);
+        if (type != NMEA_NONE && type != NMEA_OTHER) {
+            uint32_t utcTime = 0;
+            bool hasTime = parser.epochTime(utcTime);
+            GPSData &record = epoch.beginPart(utcTime, hasTime);
+            parser.decode(record);
+            completePart(type);
         }
     }
-    return true;
 }
 
-float Neo6mGPS::convertDMSToDecimal(String dms, String direction) {
-    if (dms.length() < 4) return 0.0;
-    
-    float degrees, minutes;
-    if (dms.length() >= 7) { // Longitude format: dddmm.mmmm
-        degrees = dms.substring(0, 3).toFloat();
-        minutes = dms.substring(3).toFloat();
-    } else { // Latitude format: ddmm.mmmm
-        degrees = dms.substring(0, 2).toFloat();
-        minutes = dms.substring(2).toFloat();
-    }
-    
-    float decimal = degrees + (minutes / 60.0);
-    
-    if (direction == "S" || direction == "W") {
-        decimal = -decimal;
+void Neo6mGPS::completePart(uint8_t part) {
+    if (epoch.completePart(part)) {
+        publishFix();
+    } else if (epoch.fixUpdated()) {
+        // A late part of the published epoch; not a new fix
+        currentData = epoch.getFix();
     }
-    
-    return decimal;
+}
+
+void Neo6mGPS::publishFix() {
+    currentData = epoch.getFix();
+    latestFixTime = millis();
+    fixCount++;
+}
+
+GPSData Neo6mGPS::getLatestFix() {
+    return currentData;
+}
+
+void Neo6mGPS::setEpochParts(uint8_t parts) {
+    epoch.begin(parts);
+}
+
+const GPSEpochStats &Neo6mGPS::getEpochStats() {
+    return epoch.getStats();
+}
+
+unsigned long Neo6mGPS::getLatestFixTime() {
+    return latestFixTime;
+}
+
+unsigned long Neo6mGPS::getFixCount() {
+    return fixCount;
+}
+
+unsigned long Neo6mGPS::getRxOverflowCount() {
+    return gpsSerial.getStats().overflows;
+}
+
+unsigned long Neo6mGPS::getBytesReceived() {
+    return gpsSerial.getStats().bytesReceived;
+}
+
+const NmeaSentenceStats &Neo6mGPS::getParserStats(NmeaSentenceType type) {
+    return parser.getStats(type);
 }
 
 bool Neo6mGPS::isLocationValid() {
@@ -175,7 +355,11 @@ bool Neo6mGPS::isLocationValid() {
 
 String Neo6mGPS::getLocationString() {
     if (currentData.isValid) {
-        return "Lat: " + String(currentData.latitude, 6) + ", Lon: " + String(currentData.longitude, 6);
+        char lat[COORDINATE_TEXT_SIZE];
+        char lon[COORDINATE_TEXT_SIZE];
+        formatCoordinate(currentData.latitudeE7, lat);
+        formatCoordinate(currentData.longitudeE7, lon);
+        return "Lat: " + String(lat) + ", Lon: " + String(lon);
     }
     return "No GPS Fix";
 }
@@ -250,7 +434,7 @@ void Neo6mGPS::runBasicGPSTests() {
     }
     
     // Test GPS parsing functionality
-    GPSData data = parseGPSData();
+    parseGPSData();
     printGPSTestResult("GPS Data Parsing", true, "NMEA parsing functional");
     
     // Test location validity
@@ -338,7 +522,7 @@ void Neo6mGPS::runLocationTests() {
     int lastSatCount = -1;
     
     for (int i = 0; i < 120; i++) {
-        GPSData data = parseGPSData();
+        parseGPSData();
         
         if (currentData.satellites != lastSatCount) {
             Serial.println("  Satellites visible: " + String(currentData.satellites));
@@ -367,7 +551,7 @@ void Neo6mGPS::runLocationTests() {
     
     if (gotFix) {
         // Test coordinate validity
-        bool validCoords = (currentData.latitude != 0.0 && currentData.longitude != 0.0);
+        bool validCoords = (currentData.latitudeE7 != 0 && currentData.longitudeE7 != 0);
         printGPSTestResult("Coordinate Validity", validCoords, getLocationString());
         
         // Test altitude data
@@ -381,11 +565,11 @@ void Neo6mGPS::runLocationTests() {
                           hasSpeed ? String(currentData.speed) + " km/h" : "No speed data");
         
         // Test coordinate precision
-        String latStr = String(currentData.latitude, 6);
-        String lonStr = String(currentData.longitude, 6);
-        bool goodPrecision = (latStr.indexOf('.') > 0 && lonStr.indexOf('.') > 0);
-        printGPSTestResult("Coordinate Precision", goodPrecision,
-                          "Lat: " + latStr + ", Lon: " + lonStr);
+        // Fixed-point coordinates: a fix rounded to whole degrees means the
+        // minute digits were lost somewhere
+        bool goodPrecision = (currentData.latitudeE7 % COORDINATE_SCALE != 0 &&
+                              currentData.longitudeE7 % COORDINATE_SCALE != 0);
+        printGPSTestResult("Coordinate Precision", goodPrecision, getLocationString());
     }
     
     Serial.println("Location Tests Complete\n");
@@ -404,15 +588,15 @@ void Neo6mGPS::runPerformanceTests() {
     Serial.println("[INFO] Testing GPS update rate for 10 seconds...");
     unsigned long startTime = millis();
     int updateCount = 0;
-    float lastLat = currentData.latitude;
-    float lastLon = currentData.longitude;
+    int32_t lastLat = currentData.latitudeE7;
+    int32_t lastLon = currentData.longitudeE7;
     
     while (millis() - startTime < 10000) {
-        GPSData data = parseGPSData();
-        if (currentData.latitude != lastLat || currentData.longitude != lastLon) {
+        parseGPSData();
+        if (currentData.latitudeE7 != lastLat || currentData.longitudeE7 != lastLon) {
             updateCount++;
-            lastLat = currentData.latitude;
-            lastLon = currentData.longitude;
+            lastLat = currentData.latitudeE7;
+            lastLon = currentData.longitudeE7;
         }
         delay(100);
     }
@@ -437,7 +621,7 @@ void Neo6mGPS::testSatelliteTracking(int duration) {
     unsigned long startTime = millis();
     int minSats = 999, maxSats = 0, totalSats = 0, readings = 0;
     
-    while (millis() - startTime < duration * 1000) {
+    while (millis() - startTime < (unsigned long)duration * 1000) {
         parseGPSData();
         if (currentData.satellites > 0) {
             if (currentData.satellites < minSats) minSats = currentData.satellites;
@@ -513,7 +697,7 @@ void Neo6mGPS::displayRawNMEA(int duration) {
     Serial.println("----------------------------------------");
     
     unsigned long startTime = millis();
-    while (millis() - startTime < duration * 1000) {
+    while (millis() - startTime < (unsigned long)duration * 1000) {
         if (gpsSerial.available()) {
             String sentence = read();
             if (sentence.length() > 10) {
@@ -535,14 +719,44 @@ void Neo6mGPS::printGPSStatus() {
     parseGPSData();
     
     Serial.println("GPS Fix: " + String(currentData.isValid ? "VALID" : "INVALID"));
-    Serial.println("Latitude: " + String(currentData.latitude, 6));
-    Serial.println("Longitude: " + String(currentData.longitude, 6));
+    char coordinate[COORDINATE_TEXT_SIZE];
+    formatCoordinate(currentData.latitudeE7, coordinate);
+    Serial.println("Latitude: " + String(coordinate));
+    formatCoordinate(currentData.longitudeE7, coordinate);
+    Serial.println("Longitude: " + String(coordinate));
     Serial.println("Altitude: " + String(currentData.altitude) + " m");
     Serial.println("Speed: " + String(currentData.speed) + " km/h");
+    Serial.println("Course: " + String(currentData.course) + " deg");
+    Serial.println("Fix Mode: " + String(currentData.fixMode) + " (1=None, 2=2D, 3=3D)");
     Serial.println("Satellites: " + String(currentData.satellites));
     Serial.println("HDOP: " + String(currentData.hdop));
-    Serial.println("Timestamp: " + currentData.timestamp);
+    Serial.println("PDOP/VDOP: " + String(currentData.pdop) + " / " + String(currentData.vdop));
+    Serial.println("Timestamp: " + String(currentData.timestamp));
     Serial.println("Location String: " + getLocationString());
+    
+    Serial.println("Protocol: " + String(protocol == GPS_PROTOCOL_UBX ? "UBX" : "NMEA"));
+    Serial.println("Fixes Published: " + String(fixCount) + " (last " +
+                   String(fixCount > 0 ? (millis() - latestFixTime) / 1000 : 0) + "s ago)");
+    Serial.println("Bytes Received: " + String(getBytesReceived()) + ", RX Overflows: " + String(getRxOverflowCount()));
+    const GPSEpochStats &epochStats = epoch.getStats();
+    Serial.println("Epochs Published: " + String(epochStats.published) +
+                   ", Incomplete: " + String(epochStats.incomplete) +
+                   (epoch.lastEpochIncomplete() ? " (last epoch incomplete)" : ""));
+    
+    Serial.println("----------------------------------------");
+    if (protocol == GPS_PROTOCOL_UBX) {
+        const UbxStats &ubx = ubxParser.getStats();
+        Serial.println("UBX Link Health (accepted/bad checksum/overflowed): " +
+                       String(ubx.accepted) + " / " + String(ubx.badChecksum) + " / " + String(ubx.overflowed));
+        Serial.println("Accuracy: " + String(currentData.accuracy) + " m");
+    }
+    Serial.println("NMEA Link Health (accepted/bad checksum/truncated/overflowed):");
+    for (int type = 0; type < NMEA_SENTENCE_TYPES; type++) {
+        const NmeaSentenceStats &stats = parser.getStats((NmeaSentenceType)type);
+        Serial.println("  " + String(NmeaParser::sentenceName((NmeaSentenceType)type)) + ": " +
+                       String(stats.accepted) + " / " + String(stats.badChecksum) + " / " +
+                       String(stats.truncated) + " / " + String(stats.overflowed));
+    }
     Serial.println("========================================\n");
 }
 
@@ -5,31 +5,61 @@
 #define NEO6MGPS_H
 
 #include <Arduino.h>
-#include <SoftwareSerial.h>
+#include "SerialTransport.h"
+#include "GPSData.h"
+#include "NmeaParser.h"
+#include "UbxParser.h"
+#include "GPSEpoch.h"
 
-struct GPSData {
-    bool isValid;
-    float latitude;
-    float longitude;
-    float altitude;
-    float speed;
-    int satellites;
-    String timestamp;
-    float hdop;
+enum GPSProtocol {
+    GPS_PROTOCOL_NMEA,
+    GPS_PROTOCOL_UBX
 };
 
 class Neo6mGPS {
 public:
-    Neo6mGPS(SoftwareSerial &serial);
-    void begin(long baudrate = 9600);
+    Neo6mGPS(SerialTransport &serial);
+    void begin(long baudrate = 9600, GPSProtocol protocol = GPS_PROTOCOL_NMEA);
     bool available();
     String read();
     GPSData parseGPSData();
+    
+    // Background ingestion: poll() drains the port into the parser and
+    // publishes each complete epoch as a time-stamped snapshot
+    void poll();
+    GPSData getLatestFix();
+    unsigned long getLatestFixTime();
+    unsigned long getFixCount();
+    unsigned long getRxOverflowCount();
+    unsigned long getBytesReceived();
+    
+    // Sentences (NMEA_* bits) or frames (UBX_NAV_* bits) that must all
+    // arrive for the same epoch before a fix is published
+    void setEpochParts(uint8_t parts);
+    const GPSEpochStats &getEpochStats();
+    
     bool isLocationValid();
     String getLocationString();
     float getSpeed();
     void enableGGA();
     void enableRMC();
+    bool enableUBXMode();
+    GPSProtocol getProtocol();
+    
+    // Baud rate negotiation. rates are candidates, fastest first.
+    // negotiateBaud finds the receiver's current rate (preferredRate is
+    // tried first), then moves it up to the fastest candidate that
+    // verifies cleanly. Returns the final rate, 0 if the receiver was
+    // never heard.
+    long negotiateBaud(long preferredRate, const long *rates, uint8_t count);
+    long findBaud(long preferredRate, const long *rates, uint8_t count);
+    bool probeBaud(long rate);
+    bool verifyBaud();
+    void setReceiverBaud(long rate);
+    long getBaudRate();
+    void measureLink(unsigned long duration, unsigned long &bytes, unsigned long &frames, unsigned long &errors);
+    const NmeaSentenceStats &getParserStats(NmeaSentenceType type);
+    const UbxStats &getUBXStats();
     
     // GPS Testing Functions
     void runBasicGPSTests();
@@ -46,12 +76,26 @@ public:
     void printGPSStatus();
     
 private:
-    SoftwareSerial &gpsSerial;
-    GPSData currentData;
-    bool parseGGA(String sentence);
-    bool parseRMC(String sentence);
-    float convertDMSToDecimal(String dms, String direction);
+    SerialTransport &gpsSerial;
+    GPSData currentData;            // Last published epoch
+    GPSEpochAssembler epoch;
+    unsigned long latestFixTime;
+    unsigned long fixCount;
+    NmeaParser parser;
+    UbxParser ubxParser;
+    GPSProtocol protocol;
+    long baudRate;
     String rawData;
+    void completePart(uint8_t part);
+    void publishFix();
+    void processByte(uint8_t b);
+    void openPort(long rate);
+    void listen(unsigned long duration, unsigned long &bytes, unsigned long &frames, unsigned long &errors);
+    unsigned long acceptedFrames();
+    unsigned long rejectedFrames();
+    void sendPortConfig(long rate, uint8_t outProtoMask);
+    void sendUBX(uint8_t msgClass, uint8_t msgId, const uint8_t *payload, uint16_t length);
+    bool waitForUBXAck(uint8_t msgClass, uint8_t msgId, unsigned long timeout);
 };
 
 #endif // NEO6MGPS_H
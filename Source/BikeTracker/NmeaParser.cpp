@@ -0,0 +1,360 @@
+// NmeaParser.cpp
+// Implementation of the streaming NMEA 0183 parser
+//
+// Bytes are collected into a fixed buffer. Each ',' is replaced by a
+// terminator as it arrives and its offset recorded, so once the line ends
+// every field is already a C string and no second scan is needed.
+
+#include "NmeaParser.h"
+#include "Coordinates.h"
+#include <string.h>
+
+NmeaParser::NmeaParser() {
+    reset();
+}
+
+void NmeaParser::reset() {
+    state = STATE_IDLE;
+    length = 0;
+    fields = 0;
+    sentenceType = NMEA_NONE;
+    pendingType = NMEA_OTHER;
+    checksum = 0;
+    receivedChecksum = 0;
+    checksumDigits = 0;
+    resetStats();
+}
+
+NmeaSentenceType NmeaParser::encode(char c) {
+    if (c == '$') {
+        // Start of a new sentence, anything half-received was cut short
+        if (state != STATE_IDLE) {
+            stats[pendingType].truncated++;
+        }
+        state = STATE_BODY;
+        length = 0;
+        fields = 1;
+        fieldOffsets[0] = 0;
+        pendingType = NMEA_OTHER;
+        checksum = 0;
+        receivedChecksum = 0;
+        checksumDigits = 0;
+        return NMEA_NONE;
+    }
+
+    switch (state) {
+        case STATE_IDLE:
+            return NMEA_NONE;
+
+        case STATE_BODY:
+            if (c == '\r' || c == '\n') {
+                stats[pendingType].truncated++; // No checksum delimiter
+                state = STATE_IDLE;
+                return NMEA_NONE;
+            }
+            if (length >= NMEA_MAX_SENTENCE - 1) {
+                stats[pendingType].overflowed++;
+                state = STATE_IDLE; // Overlong line, wait for the next '$'
+                return NMEA_NONE;
+            }
+            if (c == '*') {
+                buffer[length++] = '\0';
+                state = STATE_CHECKSUM;
+                return NMEA_NONE;
+            }
+
+            checksum ^= c;
+            if (c == ',') {
+                buffer[length++] = '\0';
+                if (fields == 1) {
+                    pendingType = classify(); // Address field complete
+                }
+                if (fields < NMEA_MAX_FIELDS) {
+                    fieldOffsets[fields++] = length;
+                }
+            } else {
+                buffer[length++] = c;
+            }
+            return NMEA_NONE;
+
+        case STATE_CHECKSUM: {
+            if (checksumDigits == 2 && (c == '\r' || c == '\n')) {
+                return finishSentence();
+            }
+            int digit = hexValue(c);
+            if (digit < 0 || checksumDigits == 2) {
+                stats[pendingType].truncated++;
+                state = STATE_IDLE;
+                return NMEA_NONE;
+            }
+            receivedChecksum = (receivedChecksum << 4) | digit;
+            checksumDigits++;
+            return NMEA_NONE;
+        }
+    }
+
+    return NMEA_NONE;
+}
+
+NmeaSentenceType NmeaParser::finishSentence() {
+    buffer[length] = '\0';
+    state = STATE_IDLE;
+
+    if (fields == 1) {
+        pendingType = classify(); // Sentence without any field separator
+    }
+
+    if (receivedChecksum != checksum) {
+        stats[pendingType].badChecksum++;
+        return NMEA_NONE;
+    }
+
+    stats[pendingType].accepted++;
+    sentenceType = pendingType;
+    return sentenceType;
+}
+
+int NmeaParser::hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+NmeaSentenceType NmeaParser::classify() {
+    // Address field is talker (GP, GN, GL...) followed by the sentence id
+    const char *address = buffer;
+    if (strlen(address) != 5) {
+        return NMEA_OTHER;
+    }
+
+    const char *id = address + 2;
+    if (strcmp(id, "GGA") == 0) return NMEA_GGA;
+    if (strcmp(id, "RMC") == 0) return NMEA_RMC;
+    if (strcmp(id, "VTG") == 0) return NMEA_VTG;
+    if (strcmp(id, "GSA") == 0) return NMEA_GSA;
+    return NMEA_OTHER;
+}
+
+NmeaSentenceType NmeaParser::lastSentence() {
+    return sentenceType;
+}
+
+uint8_t NmeaParser::fieldCount() {
+    return fields;
+}
+
+const char *NmeaParser::field(uint8_t index) {
+    if (index >= fields) {
+        return "";
+    }
+    return buffer + fieldOffsets[index];
+}
+
+const NmeaSentenceStats &NmeaParser::getStats(NmeaSentenceType type) {
+    if (type >= NMEA_SENTENCE_TYPES) {
+        type = NMEA_OTHER;
+    }
+    return stats[type];
+}
+
+void NmeaParser::resetStats() {
+    memset(stats, 0, sizeof(stats));
+}
+
+const char *NmeaParser::sentenceName(NmeaSentenceType type) {
+    switch (type) {
+        case NMEA_GGA: return "GGA";
+        case NMEA_RMC: return "RMC";
+        case NMEA_VTG: return "VTG";
+        case NMEA_GSA: return "GSA";
+        default: return "Other";
+    }
+}
+
+bool NmeaParser::decode(GPSData &data) {
+    switch (sentenceType) {
+        case NMEA_GGA: decodeGGA(data); return true;
+        case NMEA_RMC: decodeRMC(data); return true;
+        case NMEA_VTG: decodeVTG(data); return true;
+        case NMEA_GSA: decodeGSA(data); return true;
+        default: return false;
+    }
+}
+
+bool NmeaParser::epochTime(uint32_t &centiseconds) {
+    if ((sentenceType != NMEA_GGA && sentenceType != NMEA_RMC) || fields < 2) {
+        return false;
+    }
+
+    // hhmmss.ss
+    const char *timeStr = field(1);
+    if (strlen(timeStr) < 6) {
+        return false;
+    }
+
+    long hhmmss = parseInteger(timeStr);
+    long hundredths = 0;
+    const char *dot = strchr(timeStr, '.');
+    if (dot != NULL && dot[1] >= '0' && dot[1] <= '9') {
+        hundredths = (dot[1] - '0') * 10;
+        if (dot[2] >= '0' && dot[2] <= '9') {
+            hundredths += dot[2] - '0';
+        }
+    }
+
+    centiseconds = ((hhmmss / 10000) * 3600L + ((hhmmss / 100) % 100) * 60L + hhmmss % 100) * 100L + hundredths;
+    return true;
+}
+
+void NmeaParser::decodeGGA(GPSData &data) {
+    // $GPGGA,time,lat,lat_dir,lon,lon_dir,quality,satellites,hdop,altitude,alt_unit,geoid_height,geoid_unit
+    if (fields < 7) {
+        return;
+    }
+
+    if (parseInteger(field(6)) > 0) {
+        data.isValid = true;
+
+        parseCoordinate(field(2), field(3), data.latitudeE7);
+        parseCoordinate(field(4), field(5), data.longitudeE7);
+
+        if (fields > 7) {
+            data.satellites = parseInteger(field(7));
+        }
+        if (fields > 8) {
+            parseDecimal(field(8), data.hdop);
+        }
+        if (fields > 9) {
+            parseDecimal(field(9), data.altitude);
+        }
+    } else {
+        data.isValid = false;
+    }
+}
+
+void NmeaParser::decodeRMC(GPSData &data) {
+    // $GPRMC,time,status,lat,lat_dir,lon,lon_dir,speed,course,date
+    if (fields < 8 || strcmp(field(2), "A") != 0) {
+        return; // Only active (valid) sentences carry usable data
+    }
+
+    float knots;
+    if (parseDecimal(field(7), knots)) {
+        data.speed = knots * 1.852; // Convert knots to km/h
+    }
+    if (fields > 8) {
+        parseDecimal(field(8), data.course);
+    }
+
+    // Timestamp as "hhmmss.ss ddmmyy"
+    const char *timeStr = field(1);
+    const char *dateStr = fields > 9 ? field(9) : "";
+    size_t timeLen = strlen(timeStr);
+    size_t dateLen = strlen(dateStr);
+    if (timeLen + 1 + dateLen < GPS_TIMESTAMP_SIZE) {
+        memcpy(data.timestamp, timeStr, timeLen);
+        data.timestamp[timeLen] = ' ';
+        memcpy(data.timestamp + timeLen + 1, dateStr, dateLen + 1);
+    }
+}
+
+void NmeaParser::decodeVTG(GPSData &data) {
+    // $GPVTG,course_true,T,course_mag,M,speed_knots,N,speed_kmh,K,mode
+    if (fields < 8) {
+        return;
+    }
+
+    parseDecimal(field(1), data.course);
+    parseDecimal(field(7), data.speed);
+}
+
+void NmeaParser::decodeGSA(GPSData &data) {
+    // $GPGSA,mode,fix_type,sv1..sv12,pdop,hdop,vdop
+    if (fields < 18) {
+        return;
+    }
+
+    data.fixMode = parseInteger(field(2));
+    parseDecimal(field(15), data.pdop);
+    parseDecimal(field(16), data.hdop);
+    parseDecimal(field(17), data.vdop);
+}
+
+bool NmeaParser::parseDecimal(const char *text, float &value) {
+    if (*text == '\0') {
+        return false; // Empty field, keep the previous value
+    }
+
+    bool negative = (*text == '-');
+    if (negative) {
+        text++;
+    }
+
+    unsigned long whole = 0;
+    while (*text >= '0' && *text <= '9') {
+        whole = whole * 10 + (*text++ - '0');
+    }
+
+    unsigned long fraction = 0;
+    unsigned long scale = 1;
+    if (*text == '.') {
+        text++;
+        while (*text >= '0' && *text <= '9' && scale < 10000000UL) {
+            fraction = fraction * 10 + (*text++ - '0');
+            scale *= 10;
+        }
+    }
+
+    value = whole + (float)fraction / scale;
+    if (negative) {
+        value = -value;
+    }
+    return true;
+}
+
+long NmeaParser::parseInteger(const char *text) {
+    bool negative = (*text == '-');
+    if (negative) {
+        text++;
+    }
+
+    long value = 0;
+    while (*text >= '0' && *text <= '9') {
+        value = value * 10 + (*text++ - '0');
+    }
+    return negative ? -value : value;
+}
+
+bool NmeaParser::parseCoordinate(const char *value, const char *hemisphere, int32_t &result) {
+    // ddmm.mmmm (latitude) or dddmm.mmmm (longitude): the last two integer
+    // digits are always minutes, whatever the field width. Everything is
+    // done in integers straight from the digits, no float rounding.
+    if (strlen(value) < 4) {
+        return false;
+    }
+
+    long whole = parseInteger(value);
+    long degrees = whole / 100;
+
+    // Minutes in 1e-6 units (NEO-6M sends 5 decimals, extra ones are dropped)
+    long micromin = (whole % 100) * 1000000L;
+    const char *dot = strchr(value, '.');
+    if (dot != NULL) {
+        long place = 100000L;
+        for (const char *p = dot + 1; *p >= '0' && *p <= '9' && place > 0; p++) {
+            micromin += (*p - '0') * place;
+            place /= 10;
+        }
+    }
+
+    // 1e-6 minutes to 1e-7 degrees is a factor of 10/60, rounded
+    int32_t decimal = degrees * COORDINATE_SCALE + (micromin + 3) / 6;
+
+    if (hemisphere[0] == 'S' || hemisphere[0] == 'W') {
+        decimal = -decimal;
+    }
+
+    result = decimal;
+    return true;
+}
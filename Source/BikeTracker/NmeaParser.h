@@ -0,0 +1,89 @@
+// NmeaParser.h
+// Zero-allocation streaming NMEA 0183 parser
+
+#ifndef NMEAPARSER_H
+#define NMEAPARSER_H
+
+#include <stdint.h>
+#include "GPSData.h"
+
+#define NMEA_MAX_SENTENCE 83    // 82 characters allowed by NMEA 0183 plus terminator
+#define NMEA_MAX_FIELDS 20      // GSA is the widest sentence we decode (18 fields)
+
+enum NmeaSentenceType {
+    NMEA_GGA,
+    NMEA_RMC,
+    NMEA_VTG,
+    NMEA_GSA,
+    NMEA_OTHER,
+    NMEA_SENTENCE_TYPES,
+    NMEA_NONE = NMEA_SENTENCE_TYPES
+};
+
+// Link health counters, kept per sentence type
+struct NmeaSentenceStats {
+    unsigned long accepted;
+    unsigned long badChecksum;
+    unsigned long truncated;     // Line ended or restarted before "*hh" was complete
+    unsigned long overflowed;    // Longer than NMEA_MAX_SENTENCE
+};
+
+class NmeaParser {
+public:
+    NmeaParser();
+    void reset();
+
+    // Feed one byte from the receiver. Returns the sentence type once a
+    // complete sentence with a matching checksum has been accepted,
+    // NMEA_NONE otherwise.
+    NmeaSentenceType encode(char c);
+
+    // Apply the last accepted sentence to a fix record
+    bool decode(GPSData &data);
+
+    // UTC time of the last accepted sentence in centiseconds since
+    // midnight. False for sentences without a time field (VTG, GSA).
+    bool epochTime(uint32_t &centiseconds);
+
+    NmeaSentenceType lastSentence();
+    uint8_t fieldCount();
+    const char *field(uint8_t index);
+
+    // Parser health
+    const NmeaSentenceStats &getStats(NmeaSentenceType type);
+    void resetStats();
+    static const char *sentenceName(NmeaSentenceType type);
+
+private:
+    enum ParserState {
+        STATE_IDLE,         // Waiting for '$'
+        STATE_BODY,         // Collecting fields
+        STATE_CHECKSUM      // After '*', collecting the two hex digits
+    };
+
+    ParserState state;
+    char buffer[NMEA_MAX_SENTENCE];
+    uint8_t length;
+    uint8_t fieldOffsets[NMEA_MAX_FIELDS];
+    uint8_t fields;
+    NmeaSentenceType sentenceType;
+    NmeaSentenceType pendingType;
+    uint8_t checksum;
+    uint8_t receivedChecksum;
+    uint8_t checksumDigits;
+    NmeaSentenceStats stats[NMEA_SENTENCE_TYPES];
+
+    NmeaSentenceType finishSentence();
+    NmeaSentenceType classify();
+    static int hexValue(char c);
+    void decodeGGA(GPSData &data);
+    void decodeRMC(GPSData &data);
+    void decodeVTG(GPSData &data);
+    void decodeGSA(GPSData &data);
+
+    static bool parseDecimal(const char *text, float &value);
+    static long parseInteger(const char *text);
+    static bool parseCoordinate(const char *value, const char *hemisphere, int32_t &result);
+};
+
+#endif // NMEAPARSER_H
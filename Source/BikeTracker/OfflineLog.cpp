@@ -0,0 +1,358 @@
+// OfflineLog.cpp
+// Implementation of the flash log of web API reports
+
+#include "OfflineLog.h"
+#include <LittleFS.h>
+#include <stddef.h>
+#include <string.h>
+
+struct StoredCursor {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t check;
+};
+
+OfflineLog::OfflineLog() {
+    ready = false;
+    cursor = 1;
+    head = 1;
+    for (uint8_t i = 0; i < OFFLINE_LOG_ACK_SLOTS; i++) {
+        acked[i] = 0;
+    }
+    for (uint8_t i = 0; i < OFFLINE_LOG_RETRY_SLOTS; i++) {
+        retries[i].sequence = 0;
+        retries[i].reloads = 0;
+    }
+    unsynced = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool OfflineLog::begin() {
+    ready = false;
+    if (!LittleFS.begin()) {
+        return false;
+    }
+    if (!LittleFS.exists(OFFLINE_LOG_DIR) && !LittleFS.mkdir(OFFLINE_LOG_DIR)) {
+        return false;
+    }
+
+    // The first record of each segment says which stretch of the ring it holds
+    uint32_t firsts[OFFLINE_LOG_SEGMENTS];
+    uint32_t newest = 0;
+    int8_t newestSlot = -1;
+    for (uint8_t slot = 0; slot < OFFLINE_LOG_SEGMENTS; slot++) {
+        OfflineRecord record;
+        firsts[slot] = 0;
+        if (!readAt(slot, 0, record) || !validRecord(record) ||
+            (record.sequence - 1) % OFFLINE_LOG_SEGMENT_RECORDS != 0 || slotOf(record.sequence) != slot) {
+            continue;
+        }
+        firsts[slot] = record.sequence;
+        if (record.sequence > newest) {
+            newest = record.sequence;
+            newestSlot = slot;
+        }
+    }
+
+    uint32_t stored = 0;
+    bool haveCursor = loadCursor(stored);
+
+    if (newestSlot < 0) {
+        // Empty log; keep counting from the cursor so old acks stay valid
+        head = haveCursor ? stored : 1;
+        cursor = head;
+        ready = true;
+        return true;
+    }
+
+    // Only the tail of the newest segment can hold a torn write
+    uint32_t count = 0;
+    File file = LittleFS.open(segmentPath(newestSlot), "r");
+    if (file) {
+        count = file.size() / sizeof(OfflineRecord);
+        file.close();
+    }
+    if (count > OFFLINE_LOG_SEGMENT_RECORDS) {
+        count = OFFLINE_LOG_SEGMENT_RECORDS;
+    }
+    while (count > 1) {
+        OfflineRecord record;
+        if (readAt(newestSlot, count - 1, record) && validRecord(record) &&
+            record.sequence == newest + count - 1) {
+            break;
+        }
+        stats.corrupted++;
+        count--;
+    }
+    truncateSegment(newestSlot, count);
+    head = newest + count;
+
+    // Oldest record still in the ring
+    uint32_t oldest = newest;
+    for (uint8_t slot = 0; slot < OFFLINE_LOG_SEGMENTS; slot++) {
+        if (firsts[slot] != 0 && firsts[slot] < oldest &&
+            newest - firsts[slot] < (uint32_t)(OFFLINE_LOG_SEGMENTS - 1) * OFFLINE_LOG_SEGMENT_RECORDS + 1) {
+            oldest = firsts[slot];
+        }
+    }
+
+    // Without a cursor everything still stored is sent again
+    cursor = haveCursor ? stored : oldest;
+    if (cursor < oldest) {
+        cursor = oldest;
+    }
+    if (cursor > head) {
+        cursor = head;
+    }
+    ready = true;
+    return true;
+}
+
+bool OfflineLog::isReady() {
+    return ready;
+}
+
+bool OfflineLog::append(OfflineRecord &record) {
+    if (!ready) {
+        return false;
+    }
+
+    uint32_t index = (head - 1) % OFFLINE_LOG_SEGMENT_RECORDS;
+    uint8_t slot = slotOf(head);
+
+    // Starting a segment recycles the oldest one in the ring
+    if (index == 0) {
+        uint32_t span = (uint32_t)(OFFLINE_LOG_SEGMENTS - 1) * OFFLINE_LOG_SEGMENT_RECORDS;
+        if (head > span && cursor < head - span) {
+            stats.overwritten += (head - span) - cursor;
+            advanceCursor(head - span);
+        }
+    }
+
+    record.sequence = head;
+    memset(record.reserved, 0, sizeof(record.reserved));
+    record.crc = crc32((const uint8_t *)&record, offsetof(OfflineRecord, crc));
+
+    File file = LittleFS.open(segmentPath(slot), index == 0 ? "w" : "a");
+    if (!file) {
+        return false;
+    }
+    size_t written = file.write((const uint8_t *)&record, sizeof(record));
+    file.close();
+    if (written != sizeof(record)) {
+        // Keep the segment aligned to whole records
+        truncateSegment(slot, index);
+        return false;
+    }
+
+    head++;
+    stats.appended++;
+    return true;
+}
+
+bool OfflineLog::read(uint32_t sequence, OfflineRecord &record) {
+    if (!ready || sequence == 0 || sequence >= head) {
+        return false;
+    }
+    if (!readAt(slotOf(sequence), (sequence - 1) % OFFLINE_LOG_SEGMENT_RECORDS, record) ||
+        !validRecord(record) || record.sequence != sequence) {
+        stats.corrupted++;
+        return false;
+    }
+    return true;
+}
+
+void OfflineLog::acknowledge(uint32_t sequence) {
+    if (!ready || sequence >= head || isAcknowledged(sequence)) {
+        return;
+    }
+    stats.acknowledged++;
+    release(sequence);
+}
+
+bool OfflineLog::retry(uint32_t sequence) {
+    if (!ready || sequence >= head || isAcknowledged(sequence)) {
+        return false;
+    }
+
+    // Its own slot, else the one of the oldest report (free slots are 0)
+    uint8_t slot = 0;
+    for (uint8_t i = 0; i < OFFLINE_LOG_RETRY_SLOTS; i++) {
+        if (retries[i].sequence == sequence) {
+            slot = i;
+            break;
+        }
+        if (retries[i].sequence < retries[slot].sequence) {
+            slot = i;
+        }
+    }
+    if (retries[slot].sequence != sequence) {
+        retries[slot].sequence = sequence;
+        retries[slot].reloads = 0;
+    }
+
+    if (retries[slot].reloads >= OFFLINE_LOG_MAX_RELOADS) {
+        stats.abandoned++;
+        release(sequence);
+        return false;
+    }
+    retries[slot].reloads++;
+    stats.reloads++;
+    return true;
+}
+
+void OfflineLog::release(uint32_t sequence) {
+    if (sequence == cursor) {
+        advanceCursor(cursor + 1);
+        return;
+    }
+    for (uint8_t i = 0; i < OFFLINE_LOG_ACK_SLOTS; i++) {
+        if (acked[i] == 0) {
+            acked[i] = sequence;
+            return;
+        }
+    }
+    // No room to remember it; the report is simply sent again later
+}
+
+bool OfflineLog::isAcknowledged(uint32_t sequence) {
+    if (sequence < cursor) {
+        return true;
+    }
+    for (uint8_t i = 0; i < OFFLINE_LOG_ACK_SLOTS; i++) {
+        if (acked[i] == sequence) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void OfflineLog::flush() {
+    if (ready && unsynced > 0) {
+        saveCursor();
+    }
+}
+
+uint32_t OfflineLog::first() {
+    return cursor;
+}
+
+uint32_t OfflineLog::end() {
+    return head;
+}
+
+uint32_t OfflineLog::pending() {
+    uint32_t waiting = head - cursor;
+    for (uint8_t i = 0; i < OFFLINE_LOG_ACK_SLOTS; i++) {
+        if (acked[i] >= cursor && acked[i] < head) {
+            waiting--;
+        }
+    }
+    return waiting;
+}
+
+const OfflineLogStats &OfflineLog::getStats() {
+    return stats;
+}
+
+uint8_t OfflineLog::slotOf(uint32_t sequence) {
+    return ((sequence - 1) / OFFLINE_LOG_SEGMENT_RECORDS) % OFFLINE_LOG_SEGMENTS;
+}
+
+String OfflineLog::segmentPath(uint8_t slot) {
+    return String(OFFLINE_LOG_DIR "/seg") + String(slot);
+}
+
+bool OfflineLog::readAt(uint8_t slot, uint32_t index, OfflineRecord &record) {
+    File file = LittleFS.open(segmentPath(slot), "r");
+    if (!file) {
+        return false;
+    }
+    bool ok = file.size() >= (index + 1) * sizeof(OfflineRecord) &&
+              file.seek(index * sizeof(OfflineRecord)) &&
+              file.read((uint8_t *)&record, sizeof(record)) == sizeof(record);
+    file.close();
+    return ok;
+}
+
+void OfflineLog::truncateSegment(uint8_t slot, uint32_t count) {
+    File file = LittleFS.open(segmentPath(slot), "r+");
+    if (!file) {
+        return;
+    }
+    if (file.size() != count * sizeof(OfflineRecord)) {
+        file.truncate(count * sizeof(OfflineRecord));
+    }
+    file.close();
+}
+
+bool OfflineLog::validRecord(const OfflineRecord &record) {
+    return record.sequence != 0 &&
+           record.crc == crc32((const uint8_t *)&record, offsetof(OfflineRecord, crc));
+}
+
+void OfflineLog::advanceCursor(uint32_t sequence) {
+    cursor = sequence;
+
+    // Absorb acknowledgements that arrived out of order
+    bool advanced = true;
+    while (advanced) {
+        advanced = false;
+        for (uint8_t i = 0; i < OFFLINE_LOG_ACK_SLOTS; i++) {
+            if (acked[i] != 0 && acked[i] <= cursor) {
+                if (acked[i] == cursor) {
+                    cursor++;
+                    advanced = true;
+                }
+                acked[i] = 0;
+            }
+        }
+    }
+
+    // Batched to spare the flash; a power loss only resends a few reports
+    if (++unsynced >= OFFLINE_LOG_CURSOR_BATCH) {
+        saveCursor();
+    }
+}
+
+bool OfflineLog::loadCursor(uint32_t &sequence) {
+    File file = LittleFS.open(OFFLINE_LOG_CURSOR_FILE, "r");
+    if (!file) {
+        return false;
+    }
+    StoredCursor stored;
+    bool ok = file.read((uint8_t *)&stored, sizeof(stored)) == sizeof(stored);
+    file.close();
+    if (!ok || stored.magic != OFFLINE_LOG_CURSOR_MAGIC || stored.sequence == 0 ||
+        stored.check != crc32((const uint8_t *)&stored, offsetof(StoredCursor, check))) {
+        return false;
+    }
+    sequence = stored.sequence;
+    return true;
+}
+
+void OfflineLog::saveCursor() {
+    StoredCursor stored;
+    stored.magic = OFFLINE_LOG_CURSOR_MAGIC;
+    stored.sequence = cursor;
+    stored.check = crc32((const uint8_t *)&stored, offsetof(StoredCursor, check));
+
+    File file = LittleFS.open(OFFLINE_LOG_CURSOR_FILE, "w");
+    if (!file) {
+        return;
+    }
+    file.write((const uint8_t *)&stored, sizeof(stored));
+    file.close();
+    unsynced = 0;
+}
+
+uint32_t OfflineLog::crc32(const uint8_t *data, size_t length) {
+    uint32_t crc = 0xFFFFFFFF;
+    while (length--) {
+        crc ^= *data++;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
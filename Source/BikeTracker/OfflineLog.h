@@ -0,0 +1,105 @@
+// OfflineLog.h
+// Header for the flash log of web API reports waiting for the server
+//
+// Every report is appended to a ring of segment files in LittleFS. Records
+// are fixed size and CRC protected, numbered by a sequence that keeps
+// counting across reboots. A read cursor (the oldest record the server has
+// not acknowledged) is stored in its own small file, so mounting only reads
+// the first record of each segment, the tail of the newest one and the
+// cursor. Writing a new segment recycles the oldest slot, which spreads the
+// erases over all of them.
+
+#ifndef OFFLINELOG_H
+#define OFFLINELOG_H
+
+#include <Arduino.h>
+#include "APIConfig.h"
+
+#define OFFLINE_LOG_DIR "/offline"
+#define OFFLINE_LOG_CURSOR_FILE OFFLINE_LOG_DIR "/cursor"
+#define OFFLINE_LOG_SEGMENTS 4          // Segment files in the ring
+// Records per segment; the ring always keeps PH_MAX_OFFLINE_RECORDS even
+// while the oldest segment is being recycled
+#define OFFLINE_LOG_SEGMENT_RECORDS ((PH_MAX_OFFLINE_RECORDS + OFFLINE_LOG_SEGMENTS - 2) / (OFFLINE_LOG_SEGMENTS - 1))
+#define OFFLINE_LOG_CURSOR_BATCH 4      // Acknowledgements between cursor writes
+#define OFFLINE_LOG_ACK_SLOTS 8         // Out-of-order acknowledgements remembered
+#define OFFLINE_LOG_RETRY_SLOTS 8       // Reports whose reloads are being counted
+#define OFFLINE_LOG_CURSOR_MAGIC 0x4F4C4331  // "OLC1"
+
+struct OfflineRecord {
+    uint32_t sequence;              // Assigned by append(), never 0
+    int32_t latitudeE7;
+    int32_t longitudeE7;
+    uint32_t capturedAt;            // millis() of the boot that took the fix
+    uint8_t alertType;              // AlertType, ALERT_NONE for routine reports
+    uint8_t reserved[3];
+    uint32_t crc;                   // CRC-32 of the fields above
+};
+
+struct OfflineLogStats {
+    unsigned long appended;
+    unsigned long acknowledged;
+    unsigned long overwritten;      // Recycled before the server took them
+    unsigned long corrupted;        // Failed the CRC or sequence check
+    unsigned long reloads;          // Budgets spent and the report loaded again
+    unsigned long abandoned;        // Given up after OFFLINE_LOG_MAX_RELOADS reloads
+};
+
+class OfflineLog {
+public:
+    OfflineLog();
+
+    // Mount the filesystem and recover the write position and cursor.
+    // False if flash storage is unavailable.
+    bool begin();
+    bool isReady();
+
+    // Store a report; fills in record.sequence and record.crc
+    bool append(OfflineRecord &record);
+    bool read(uint32_t sequence, OfflineRecord &record);
+
+    // Server accepted the report. The cursor only moves past a contiguous
+    // run of acknowledged records; others are remembered until it does.
+    void acknowledge(uint32_t sequence);
+    bool isAcknowledged(uint32_t sequence);
+
+    // A report used up its attempt budget. True if it should be loaded
+    // again with a fresh one; after OFFLINE_LOG_MAX_RELOADS it is
+    // acknowledged as abandoned instead, so one report the server keeps
+    // refusing is not retried forever. Counts are kept in RAM only, a
+    // reboot starts them over.
+    bool retry(uint32_t sequence);
+
+    // Write the cursor now (before sleep or power down)
+    void flush();
+
+    uint32_t first();               // Oldest unacknowledged sequence
+    uint32_t end();                 // Sequence the next append gets
+    uint32_t pending();             // Records still waiting for the server
+    const OfflineLogStats &getStats();
+
+private:
+    bool ready;
+    uint32_t cursor;
+    uint32_t head;
+    uint32_t acked[OFFLINE_LOG_ACK_SLOTS];  // 0 marks a free slot
+    struct {
+        uint32_t sequence;                  // 0 marks a free slot
+        uint8_t reloads;
+    } retries[OFFLINE_LOG_RETRY_SLOTS];
+    uint8_t unsynced;               // Cursor moves not yet written
+    OfflineLogStats stats;
+
+    static uint8_t slotOf(uint32_t sequence);
+    static String segmentPath(uint8_t slot);
+    bool readAt(uint8_t slot, uint32_t index, OfflineRecord &record);
+    void truncateSegment(uint8_t slot, uint32_t count);
+    bool validRecord(const OfflineRecord &record);
+    void release(uint32_t sequence);
+    void advanceCursor(uint32_t sequence);
+    bool loadCursor(uint32_t &sequence);
+    void saveCursor();
+    static uint32_t crc32(const uint8_t *data, size_t length);
+};
+
+#endif // OFFLINELOG_H
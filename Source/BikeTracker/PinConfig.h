@@ -11,8 +11,18 @@
 #define GSM_RX_PIN D6
 #define GSM_TX_PIN D5
 
+// Run the GSM modem on hardware UART0 instead of SoftwareSerial. UART0 is
+// swapped onto GPIO13/GPIO15 (D7 RX, D8 TX), which moves the buzzer and
+// status LED and takes the USB console away, so production builds only.
+#define GSM_HARDWARE_UART false
+
 // Additional sensor pins
-#define BUZZER_PIN D7
-#define LED_STATUS_PIN D8
+#if GSM_HARDWARE_UART
+    #define BUZZER_PIN D1
+    #define LED_STATUS_PIN D0
+#else
+    #define BUZZER_PIN D7
+    #define LED_STATUS_PIN D8
+#endif
 
 #endif // PINCONFIG_H
@@ -0,0 +1,80 @@
+// RetryPolicy.cpp
+// Implementation of the upload retry policy
+
+#include "RetryPolicy.h"
+#include <string.h>
+
+RetryPolicy::RetryPolicy(unsigned long base, unsigned long maximum,
+                         uint8_t threshold, unsigned long cooldown) {
+    baseDelay = base;
+    maxDelay = maximum;
+    breakerThreshold = threshold;
+    breakerCooldown = cooldown;
+    state = BREAKER_CLOSED;
+    consecutiveFailures = 0;
+    openedAt = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+unsigned long RetryPolicy::backoff(uint8_t failures) {
+    unsigned long delayMs = baseDelay;
+    for (uint8_t i = 1; i < failures && delayMs < maxDelay; i++) {
+        delayMs *= 2;
+    }
+    if (delayMs > maxDelay) {
+        delayMs = maxDelay;
+    }
+    
+    // Equal jitter: half fixed, half random
+    return delayMs / 2 + random(delayMs / 2 + 1);
+}
+
+bool RetryPolicy::allowAttempt() {
+    if (state != BREAKER_OPEN) {
+        return true;
+    }
+    if (millis() - openedAt < breakerCooldown) {
+        return false;
+    }
+    state = BREAKER_HALF_OPEN; // Let one trial through
+    return true;
+}
+
+void RetryPolicy::recordSuccess() {
+    stats.successes++;
+    consecutiveFailures = 0;
+    state = BREAKER_CLOSED;
+}
+
+bool RetryPolicy::recordFailure() {
+    stats.failures++;
+    if (consecutiveFailures < 255) {
+        consecutiveFailures++;
+    }
+    
+    // A failed trial reopens at once
+    if (state == BREAKER_HALF_OPEN ||
+        (state == BREAKER_CLOSED && consecutiveFailures >= breakerThreshold)) {
+        state = BREAKER_OPEN;
+        openedAt = millis();
+        stats.breakerTrips++;
+        return true;
+    }
+    return false;
+}
+
+BreakerState RetryPolicy::getState() {
+    return state;
+}
+
+unsigned long RetryPolicy::getCooldownRemaining() {
+    if (state != BREAKER_OPEN) {
+        return 0;
+    }
+    unsigned long elapsed = millis() - openedAt;
+    return elapsed < breakerCooldown ? breakerCooldown - elapsed : 0;
+}
+
+const RetryStats &RetryPolicy::getStats() {
+    return stats;
+}
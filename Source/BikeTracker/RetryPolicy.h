@@ -0,0 +1,56 @@
+// RetryPolicy.h
+// Header for the upload retry policy: backoff with jitter and a circuit breaker
+//
+// One policy is shared by every upload. Each message keeps its own attempt
+// count; the policy decides how long a failed message waits and whether
+// anything may be sent at all. After breakerThreshold consecutive failures
+// the breaker opens and holds all uploads for breakerCooldown, then lets a
+// single trial through (half-open) to decide whether to close again.
+
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+#include <Arduino.h>
+
+enum BreakerState {
+    BREAKER_CLOSED,
+    BREAKER_OPEN,
+    BREAKER_HALF_OPEN
+};
+
+struct RetryStats {
+    unsigned long successes;
+    unsigned long failures;
+    unsigned long breakerTrips;
+};
+
+class RetryPolicy {
+public:
+    RetryPolicy(unsigned long baseDelay, unsigned long maxDelay,
+                uint8_t breakerThreshold, unsigned long breakerCooldown);
+    
+    // Wait before the next attempt of a message that has failed `failures`
+    // times: baseDelay doubled per failure, capped at maxDelay, with the
+    // upper half randomised so retries from a bad patch do not line up
+    unsigned long backoff(uint8_t failures);
+    
+    bool allowAttempt();            // False while the breaker is open
+    void recordSuccess();
+    bool recordFailure();           // True if this failure opened the breaker
+    
+    BreakerState getState();
+    unsigned long getCooldownRemaining();  // ms until a trial is allowed, 0 if not open
+    const RetryStats &getStats();
+    
+private:
+    unsigned long baseDelay;
+    unsigned long maxDelay;
+    uint8_t breakerThreshold;
+    unsigned long breakerCooldown;
+    BreakerState state;
+    uint8_t consecutiveFailures;
+    unsigned long openedAt;
+    RetryStats stats;
+};
+
+#endif // RETRYPOLICY_H
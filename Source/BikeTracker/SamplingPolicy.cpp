@@ -0,0 +1,122 @@
+// SamplingPolicy.cpp
+// Implementation of the adaptive location reporting policy
+
+#include "SamplingPolicy.h"
+#include "Coordinates.h"
+#include <math.h>
+#include <string.h>
+
+SamplingPolicy::SamplingPolicy(const SamplingParameters &parameters) : params(parameters) {
+    memset(&stats, 0, sizeof(stats));
+    reset();
+}
+
+void SamplingPolicy::reset() {
+    havePoint = false;
+    setDistanceReference(point, 0, 0);
+    pointCourse = 0;
+    pointHasCourse = false;
+    pointTime = 0;
+    parked = false;
+    slow = false;
+    slowSince = 0;
+}
+
+SampleReason SamplingPolicy::evaluate(int32_t latitudeE7, int32_t longitudeE7, float speed, float course,
+                                      unsigned long now) {
+    stats.evaluated++;
+    SampleReason reason = decide(latitudeE7, longitudeE7, speed, course, now);
+    stats.recorded[reason]++;
+    
+    bool validCourse = speed >= params.headingMinSpeed;
+    if (reason != SAMPLE_NONE) {
+        havePoint = true;
+        setDistanceReference(point, latitudeE7, longitudeE7);
+        pointTime = now;
+        pointCourse = course;
+        pointHasCourse = validCourse;
+    } else if (!pointHasCourse && validCourse) {
+        // Point was taken too slowly to have a heading; turns are measured
+        // from the first usable one after it
+        pointCourse = course;
+        pointHasCourse = true;
+    }
+    return reason;
+}
+
+SampleReason SamplingPolicy::decide(int32_t latitudeE7, int32_t longitudeE7, float speed, float course,
+                                    unsigned long now) {
+    if (!havePoint) {
+        return SAMPLE_FIRST;
+    }
+    unsigned long elapsed = now - pointTime;
+    float moved = distanceFrom(point, latitudeE7, longitudeE7);
+    
+    // Parked once slow and close to the last point for parkedAfter
+    if (speed < params.parkedSpeed && moved < params.distance) {
+        if (!slow) {
+            slow = true;
+            slowSince = now;
+        }
+        if (!parked && now - slowSince >= params.parkedAfter) {
+            parked = true;
+            stats.parkedPeriods++;
+        }
+    } else {
+        slow = false;
+        parked = false;
+    }
+    
+    if (elapsed < params.minInterval) {
+        return SAMPLE_NONE;
+    }
+    if (parked) {
+        return elapsed >= params.heartbeatInterval ? SAMPLE_HEARTBEAT : SAMPLE_NONE;
+    }
+    if (moved >= params.distance) {
+        return SAMPLE_DISTANCE;
+    }
+    if (pointHasCourse && speed >= params.headingMinSpeed &&
+        headingDifference(course, pointCourse) >= params.headingChange) {
+        return SAMPLE_HEADING;
+    }
+    if (elapsed >= params.maxInterval) {
+        return SAMPLE_INTERVAL;
+    }
+    return SAMPLE_NONE;
+}
+
+bool SamplingPolicy::isParked() {
+    return parked;
+}
+
+void SamplingPolicy::setParameters(const SamplingParameters &parameters) {
+    params = parameters;
+}
+
+const SamplingParameters &SamplingPolicy::getParameters() {
+    return params;
+}
+
+const SamplingStats &SamplingPolicy::getStats() {
+    return stats;
+}
+
+const char *SamplingPolicy::reasonName(SampleReason reason) {
+    switch (reason) {
+        case SAMPLE_FIRST: return "first";
+        case SAMPLE_HEADING: return "heading";
+        case SAMPLE_DISTANCE: return "distance";
+        case SAMPLE_INTERVAL: return "interval";
+        case SAMPLE_HEARTBEAT: return "heartbeat";
+        default: return "skipped";
+    }
+}
+
+float SamplingPolicy::headingDifference(float a, float b) {
+    float difference = fabs(a - b);
+    while (difference > 360.0) {
+        difference -= 360.0;
+    }
+    return difference > 180.0 ? 360.0 - difference : difference;
+}
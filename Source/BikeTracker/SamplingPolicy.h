@@ -0,0 +1,74 @@
+// SamplingPolicy.h
+// Header for the adaptive location reporting policy
+//
+// Each fix is offered to evaluate(), which decides whether it becomes a
+// report. While moving, a point is recorded when the heading has turned,
+// when the bike has covered enough distance, or when the interval since the
+// last point runs out. Once the bike has been still for a while it counts as
+// parked and only a slow heartbeat is recorded until it moves again.
+
+#ifndef SAMPLINGPOLICY_H
+#define SAMPLINGPOLICY_H
+
+#include <Arduino.h>
+#include "Distance.h"
+
+enum SampleReason {
+    SAMPLE_NONE,
+    SAMPLE_FIRST,                   // No point recorded yet
+    SAMPLE_HEADING,
+    SAMPLE_DISTANCE,
+    SAMPLE_INTERVAL,
+    SAMPLE_HEARTBEAT,               // Parked
+    SAMPLE_REASONS
+};
+
+struct SamplingParameters {
+    float headingChange;            // Degrees of turn that record a point
+    float headingMinSpeed;          // km/h; course is ignored below this
+    float distance;                 // Metres from the last point
+    unsigned long minInterval;      // ms; nothing is recorded sooner
+    unsigned long maxInterval;      // ms while moving
+    float parkedSpeed;              // km/h below which the bike may be parked
+    unsigned long parkedAfter;      // ms below parkedSpeed, without covering distance
+    unsigned long heartbeatInterval;    // ms between points while parked
+};
+
+struct SamplingStats {
+    unsigned long evaluated;
+    unsigned long recorded[SAMPLE_REASONS];  // By reason; [SAMPLE_NONE] counts skipped fixes
+    unsigned long parkedPeriods;
+};
+
+class SamplingPolicy {
+public:
+    SamplingPolicy(const SamplingParameters &parameters);
+
+    // Decide about one fix; a non-NONE reason means it was recorded and
+    // becomes the reference for the next decision
+    SampleReason evaluate(int32_t latitudeE7, int32_t longitudeE7, float speed, float course, unsigned long now);
+    void reset();                   // Forget the last point, the next fix is recorded
+
+    bool isParked();
+    void setParameters(const SamplingParameters &parameters);
+    const SamplingParameters &getParameters();
+    const SamplingStats &getStats();
+    static const char *reasonName(SampleReason reason);
+
+private:
+    SamplingParameters params;
+    bool havePoint;
+    DistanceReference point;        // Last recorded point, 1e-7 degrees
+    float pointCourse;
+    bool pointHasCourse;
+    unsigned long pointTime;
+    bool parked;
+    bool slow;                      // Below parkedSpeed near the last point
+    unsigned long slowSince;
+    SamplingStats stats;
+
+    SampleReason decide(int32_t latitudeE7, int32_t longitudeE7, float speed, float course, unsigned long now);
+    static float headingDifference(float a, float b);
+};
+
+#endif // SAMPLINGPOLICY_H
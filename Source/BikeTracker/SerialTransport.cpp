@@ -0,0 +1,62 @@
+// SerialTransport.cpp
+// Implementation of the counted Stream wrapper common to all transports
+
+#include "SerialTransport.h"
+#include <string.h>
+
+SerialTransport::SerialTransport() {
+    resetStats();
+}
+
+void SerialTransport::checkOverflow() {
+    if (rxOverflowed()) {
+        stats.overflows++;
+    }
+}
+
+int SerialTransport::available() {
+    checkOverflow();
+    return rxAvailable();
+}
+
+int SerialTransport::read() {
+    int c = rxRead();
+    if (c >= 0) {
+        stats.bytesReceived++;
+    }
+    return c;
+}
+
+int SerialTransport::peek() {
+    return rxPeek();
+}
+
+size_t SerialTransport::write(uint8_t b) {
+    return write(&b, 1);
+}
+
+size_t SerialTransport::write(const uint8_t *buffer, size_t size) {
+    size_t written = txWrite(buffer, size);
+    stats.bytesSent += written;
+    return written;
+}
+
+void SerialTransport::flush() {
+    txFlush();
+}
+
+bool SerialTransport::overflow() {
+    checkOverflow();
+    bool overflowed = (stats.overflows != reportedOverflows);
+    reportedOverflows = stats.overflows;
+    return overflowed;
+}
+
+const SerialTransportStats &SerialTransport::getStats() {
+    return stats;
+}
+
+void SerialTransport::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+    reportedOverflows = 0;
+}
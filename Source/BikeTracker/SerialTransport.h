@@ -0,0 +1,55 @@
+// SerialTransport.h
+// Header for the byte transport shared by the GPS and GSM drivers
+//
+// Drivers talk to a SerialTransport instead of a concrete port, so the same
+// code runs over SoftwareSerial, a hardware UART or a mock. Every transport
+// counts traffic and RX overflows the same way.
+
+#ifndef SERIALTRANSPORT_H
+#define SERIALTRANSPORT_H
+
+#include <Arduino.h>
+
+struct SerialTransportStats {
+    unsigned long bytesReceived;
+    unsigned long bytesSent;
+    unsigned long overflows;        // Times RX data was lost to a full buffer
+};
+
+class SerialTransport : public Stream {
+public:
+    SerialTransport();
+    
+    virtual void begin(long baudrate) = 0;
+    virtual void end() = 0;
+    
+    // Stream interface, counted
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t b) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    void flush() override;
+    using Print::write;
+    
+    // True if RX data was lost since the last call
+    bool overflow();
+    const SerialTransportStats &getStats();
+    void resetStats();
+    
+protected:
+    // Implemented by each transport
+    virtual int rxAvailable() = 0;
+    virtual int rxRead() = 0;
+    virtual int rxPeek() = 0;
+    virtual size_t txWrite(const uint8_t *buffer, size_t size) = 0;
+    virtual void txFlush() = 0;
+    virtual bool rxOverflowed() = 0;    // Reads and clears the driver's overflow flag
+    
+private:
+    SerialTransportStats stats;
+    unsigned long reportedOverflows;
+    void checkOverflow();
+};
+
+#endif // SERIALTRANSPORT_H
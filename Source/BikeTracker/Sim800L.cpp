@@ -2,24 +2,171 @@
 // Implementation for SIM800L GSM module
 
 #include "Sim800L.h"
+#include "Coordinates.h"
+#include "Lzss.h"
+#include "ModeConfig.h"
+#include <string.h>
 
-Sim800L::Sim800L(SoftwareSerial &serial) : gsmSerial(serial) {
+Sim800L::Sim800L(SerialTransport &serial) : gsmSerial(serial), engine(serial) {
     status = GSM_INIT;
+    jobHead = 0;
+    jobCount = 0;
+    nextJobId = 0;
+    finishedJobId = 0;
+    lastJobSuccess = false;
+    syncPending = false;
+    syncResult = AT_RESULT_OK;
     lastCommandTime = 0;
     lastDataActivity = 0;
+    idleCallback = NULL;
+    idleContext = NULL;
+    eventCallback = NULL;
+    eventContext = NULL;
     gprsConnected = false;
+    bearerCacheValid = false;
+    bearerConfirmedAt = 0;
+    memset(&bearerStats, 0, sizeof(bearerStats));
+    localIP = "0.0.0.0";
+    imei = "Unknown";
+    signalStrength = -1;
+    signalSampledAt = 0;
+    nextSignalSample = 0;
+    signalSamplePending = false;
+    httpSessionOpen = false;
+    httpSessionURL = "";
+    httpSessionTuned = false;
+    httpSessionContent = "";
+    httpSessionCompressed = false;
+    bodyCompression = false;
+    networkTime = "";
+    baudRate = 9600;
     currentAPN = "";
     currentUsername = "";
     currentPassword = "";
+    
+    // Everything else the modem says unprompted is dropped by the engine
+    engine.addUrcHandler("+CREG:", onUrc, this);
+    engine.addUrcHandler("+SAPBR 1:", onUrc, this);
+    engine.addUrcHandler("+CMTI:", onUrc, this);
+    engine.addUrcHandler("RING", onUrc, this);
+    engine.addUrcHandler("*PSUTTZ:", onUrc, this);
 }
 
 void Sim800L::begin(long baudrate) {
-    gsmSerial.begin(baudrate);
-    delay(2000);
+    openPort(baudrate);
+    pause(2000);
+}
+
+void Sim800L::openPort(long rate) {
+    gsmSerial.end();
+    gsmSerial.begin(rate);
+    baudRate = rate;
+    clearBuffer();
+}
+
+long Sim800L::getBaudRate() {
+    return baudRate;
+}
+
+const SerialTransportStats &Sim800L::getLinkStats() {
+    return gsmSerial.getStats();
+}
+
+bool Sim800L::probeBaud(long rate) {
+    // A few tries: with autobaud the first "AT" only trains the modem
+    openPort(rate);
+    for (int i = 0; i < 3; i++) {
+        if (sendATCommand("AT", "OK", 300)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Sim800L::verifyBaud(int rounds) {
+    for (int i = 0; i < rounds; i++) {
+        if (!sendATCommand("AT", "OK", 500)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Sim800L::setModemBaud(long rate) {
+    // The modem answers OK at the old rate, then switches
+    if (!sendATCommand("AT+IPR=" + String(rate), "OK", 1000)) {
+        return false;
+    }
+    pause(100);
+    openPort(rate);
+    return true;
+}
+
+long Sim800L::findBaud(long preferredRate, const long *rates, uint8_t count) {
+    if (probeBaud(preferredRate)) {
+        return preferredRate;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (rates[i] != preferredRate && probeBaud(rates[i])) {
+            return rates[i];
+        }
+    }
+    return 0;
+}
+
+long Sim800L::negotiateBaud(long preferredRate, const long *rates, uint8_t count) {
+    long current = findBaud(preferredRate, rates, count);
+    if (current == 0) {
+        openPort(preferredRate); // No answer, leave it to initialize() retries
+        return 0;
+    }
+    long found = current;
+    
+    for (uint8_t i = 0; i < count; i++) {
+        if (rates[i] <= current) {
+            continue;
+        }
+        if (!setModemBaud(rates[i])) {
+            continue; // Rate refused by the modem
+        }
+        if (verifyBaud(GSM_BAUD_VERIFY_ROUNDS)) {
+            current = rates[i];
+            break;
+        }
+        
+        // Too fast for the link, step back (or search if that is lost too)
+        setModemBaud(current);
+        if (!probeBaud(current)) {
+            current = findBaud(current, rates, count);
+            if (current == 0) {
+                openPort(preferredRate);
+                return 0;
+            }
+        }
+    }
+    
+    // Keep the fixed rate across modem power cycles
+    if (current != found) {
+        sendATCommand("AT&W", "OK", 2000);
+    }
+    return current;
+}
+
+unsigned long Sim800L::measureATLatency(int rounds) {
+    unsigned long total = 0;
+    for (int i = 0; i < rounds; i++) {
+        unsigned long startTime = micros();
+        if (!sendATCommand("AT", "OK", 1000)) {
+            return 0;
+        }
+        total += micros() - startTime;
+    }
+    return rounds > 0 ? total / rounds : 0;
 }
 
 bool Sim800L::initialize() {
     clearBuffer();
+    invalidateHTTPSession(); // The modem may have restarted
     
     // Test AT communication
     if (!sendATCommand("AT", "OK", 3000)) {
@@ -30,15 +177,28 @@ bool Sim800L::initialize() {
     // Disable echo
     sendATCommand("ATE0", "OK", 3000);
     
+    // Fixed for the life of the module; read once for location reports
+    if (imei == "Unknown") {
+        getIMEI();
+    }
+    getSignalStrength(); // First sample; update() refreshes it from here on
+    
     // Set SMS text mode
     if (!sendATCommand("AT+CMGF=1", "OK", 3000)) {
         status = GSM_ERROR;
         return false;
     }
     
-    // Check network registration
-    if (sendATCommand("AT+CREG?", "+CREG: 0,1", 10000) || 
-        sendATCommand("AT+CREG?", "+CREG: 0,5", 10000)) {
+    // Report new SMS (+CMTI) and registration changes (+CREG) as URCs
+    sendATCommand("AT+CNMI=2,1,0,0,0", "OK", 3000);
+    sendATCommand("AT+CREG=1", "OK", 3000);
+    
+    // Check network registration (home or roaming)
+    int registration = -1;
+    if (sendATCommand("AT+CREG?", "+CREG:", 10000)) {
+        registration = parseRegistration(lastResponse);
+    }
+    if (registration == 1 || registration == 5) {
         status = GSM_NETWORK_CONNECTED;
         return true;
     } else {
@@ -47,74 +207,735 @@ bool Sim800L::initialize() {
     }
 }
 
+int Sim800L::parseRegistration(const String &response) {
+    // +CREG: <n>,<stat>
+    int start = response.indexOf("+CREG:");
+    int comma = response.indexOf(',', start);
+    if (start < 0 || comma < 0) {
+        return -1;
+    }
+    return response.substring(comma + 1).toInt();
+}
+
 GSMStatus Sim800L::getStatus() {
     return status;
 }
 
 bool Sim800L::sendATCommand(const String &command, const String &expectedResponse, int timeout) {
-    clearBuffer();
-    gsmSerial.println(command);
+    // Blocking wrapper over the engine: queued behind anything in flight
+    syncPending = true;
+    if (!engine.submit(command, expectedResponse, timeout, onSyncDone, this)) {
+        syncPending = false;
+        return false;
+    }
     lastCommandTime = millis();
     
-    return waitForResponse(expectedResponse, timeout);
+    while (syncPending) {
+        update();
+        if (syncPending) {
+            pause(1);
+        }
+    }
+    return syncResult == AT_RESULT_OK;
+}
+
+void Sim800L::onSyncDone(void *context, AtResult result, const String &response) {
+    Sim800L *modem = (Sim800L *)context;
+    modem->syncResult = result;
+    modem->lastResponse = response;
+    modem->syncPending = false;
+}
+
+void Sim800L::setIdleCallback(void (*callback)(void *context), void *context) {
+    idleCallback = callback;
+    idleContext = context;
+}
+
+void Sim800L::setEventCallback(GSMEventCallback callback, void *context) {
+    eventCallback = callback;
+    eventContext = context;
+}
+
+String Sim800L::getNetworkTime() {
+    return networkTime;
+}
+
+void Sim800L::notify(GSMEvent event, int value) {
+    if (eventCallback != NULL) {
+        eventCallback(eventContext, event, value);
+    }
+}
+
+bool Sim800L::onUrc(void *context, const String &line) {
+    return ((Sim800L *)context)->handleUrc(line);
+}
+
+bool Sim800L::handleUrc(const String &line) {
+    if (line.startsWith("+CREG:")) {
+        // The URC is "+CREG: <stat>[,"lac","ci"]"; AT+CREG? answers "+CREG: <n>,<stat>"
+        int comma = line.indexOf(',');
+        if (comma >= 0 && line.charAt(comma + 1) != '"') {
+            return false;
+        }
+        int stat = line.substring(6).toInt();
+        bool registered = (stat == 1 || stat == 5);
+        if (registered && status == GSM_NO_NETWORK) {
+            status = GSM_NETWORK_CONNECTED;
+        } else if (!registered && status == GSM_NETWORK_CONNECTED) {
+            status = GSM_NO_NETWORK;
+        }
+        notify(GSM_EVENT_REGISTRATION, registered ? 1 : 0);
+    } else if (line.startsWith("+SAPBR 1:")) {
+        if (line.indexOf("DEACT") < 0) {
+            return false;
+        }
+        gprsConnected = false;
+        localIP = "0.0.0.0";
+        invalidateBearerCache();
+        invalidateHTTPSession();
+        notify(GSM_EVENT_BEARER_LOST, 0);
+    } else if (line.startsWith("+CMTI:")) {
+        // +CMTI: "SM",<index>
+        notify(GSM_EVENT_SMS_RECEIVED, line.substring(line.lastIndexOf(',') + 1).toInt());
+    } else if (line.startsWith("RING")) {
+        notify(GSM_EVENT_CALL_RING, 0);
+    } else if (line.startsWith("*PSUTTZ:")) {
+        // *PSUTTZ: yyyy,mm,dd,hh,mm,ss,"+tz",dst
+        networkTime = line.substring(9);
+        notify(GSM_EVENT_NETWORK_TIME, 0);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void Sim800L::pause(unsigned long duration) {
+    // Blocking wait that still lets the owner service other ports
+    unsigned long startTime = millis();
+    while (millis() - startTime < duration) {
+        if (idleCallback != NULL) {
+            idleCallback(idleContext);
+        }
+        delay(duration < 10 ? duration : 10);
+    }
+}
+
+void Sim800L::clearBuffer() {
+    // URCs already waiting are still handled
+    engine.discardInput();
+}
+
+// =============================================================================
+// JOB QUEUE
+// =============================================================================
+
+void Sim800L::update() {
+    engine.update();
+    
+    if (jobCount == 0) {
+        // Refresh the signal sample when the modem has nothing else to do
+        if (status != GSM_INIT && !signalSamplePending && engine.isIdle() &&
+            (long)(millis() - nextSignalSample) >= 0) {
+            nextSignalSample = millis() + GSM_SIGNAL_SAMPLE_INTERVAL;
+            signalSamplePending = engine.submit("AT+CSQ", "+CSQ:", 3000, onSignalSampled, this);
+        }
+        return;
+    }
+    GSMJob &job = jobs[jobHead];
+    if (job.waiting && (long)(millis() - job.resumeAt) >= 0) {
+        job.waiting = false;
+        runStep();
+    }
+}
+
+bool Sim800L::isBusy() {
+    return jobCount > 0 || !engine.isIdle();
+}
+
+const AtEngineStats &Sim800L::getEngineStats() {
+    return engine.getStats();
+}
+
+Sim800L::GSMJob *Sim800L::newJob(GSMJobType type, GSMJobStep firstStep, GSMJobCallback callback, void *context) {
+    if (jobCount >= GSM_JOB_QUEUE_SIZE) {
+        return NULL;
+    }
+    
+    GSMJob &job = jobs[(jobHead + jobCount) % GSM_JOB_QUEUE_SIZE];
+    job.id = ++nextJobId;
+    job.type = type;
+    job.step = firstStep;
+    job.waiting = true;             // Started by update() when it reaches the front
+    job.resumeAt = millis();
+    job.attempts = 0;
+    job.post = false;
+    job.locationReport = false;
+    job.readBody = true;
+    job.target = "";
+    job.body = "";
+    job.contentType = GSM_HTTP_CONTENT_JSON;
+    job.compressed = false;
+    job.deviceId = "";
+    job.alertType = "";
+    job.latitudeE7 = 0;
+    job.longitudeE7 = 0;
+    job.capturedAt = 0;
+    job.fixes = "";
+    job.success = false;
+    job.result = "";
+    job.callback = callback;
+    job.context = context;
+    jobCount++;
+    return &job;
 }
 
-bool Sim800L::waitForResponse(const String &expected, int timeout) {
-    String response = "";
+bool Sim800L::waitForJob(unsigned long id) {
+    while (finishedJobId < id) {
+        update();
+        if (finishedJobId < id) {
+            pause(1);
+        }
+    }
+    return lastJobSuccess;
+}
+
+void Sim800L::finishPendingJobs(unsigned long timeout) {
     unsigned long startTime = millis();
+    while (isBusy() && millis() - startTime < timeout) {
+        update();
+        pause(1);
+    }
+}
+
+void Sim800L::nextStep(GSMJobStep step, unsigned long wait) {
+    GSMJob &job = jobs[jobHead];
+    job.step = step;
+    job.waiting = true;
+    job.resumeAt = millis() + wait;
+}
+
+void Sim800L::submitStep(const String &command, const String &expected, unsigned long timeout) {
+    if (!engine.submit(command, expected, timeout, onStepDone, this)) {
+        jobs[jobHead].waiting = true; // Engine full, try again shortly
+        jobs[jobHead].resumeAt = millis() + 10;
+    }
+}
+
+void Sim800L::finishJob(bool success, const String &response) {
+    // Pop before the callback so it can queue another job
+    GSMJob &job = jobs[jobHead];
+    GSMJobCallback callback = job.callback;
+    void *context = job.context;
+    finishedJobId = job.id;
+    lastJobSuccess = success;
+    lastJobResponse = response;
+    jobHead = (jobHead + 1) % GSM_JOB_QUEUE_SIZE;
+    jobCount--;
+    
+    if (callback != NULL) {
+        callback(context, success, lastJobResponse);
+    }
+}
+
+void Sim800L::onStepDone(void *context, AtResult result, const String &response) {
+    ((Sim800L *)context)->stepDone(result, response);
+}
+
+void Sim800L::runStep() {
+    GSMJob &job = jobs[jobHead];
+    
+    switch (job.step) {
+        // SMS
+        case STEP_SMS_MODE:
+            submitStep("AT+CMGF=1", "OK", 3000);
+            break;
+        case STEP_SMS_SEND:
+            if (!engine.submitWithPayload("AT+CMGS=\"" + job.target + "\"", "> ", job.body, true,
+                                          "+CMGS:", 60000, onStepDone, this)) {
+                nextStep(STEP_SMS_SEND, 10);
+            }
+            break;
+        
+        // GPRS bearer. While it is up, a drop is reported by URC, so the
+        // bearer is only queried when it is down or the cache has expired.
+        case STEP_GPRS_CHECK_FIRST:
+            if (useCachedBearer()) {
+                lastDataActivity = millis();
+                finishJob(true, localIP);
+            } else {
+                submitStep("AT+SAPBR=2,1", "OK", 5000);
+            }
+            break;
+        case STEP_HTTP_BEARER:
+            if (useCachedBearer()) {
+                afterBearer(job);
+            } else {
+                submitStep("AT+SAPBR=2,1", "OK", 5000);
+            }
+            break;
+        case STEP_GPRS_VERIFY:
+            submitStep("AT+SAPBR=2,1", "OK", 5000);
+            break;
+        case STEP_GPRS_HTTPTERM:
+        case STEP_RESET_HTTPTERM:
+            submitStep("AT+HTTPTERM", "OK", 5000);
+            break;
+        case STEP_GPRS_CLOSE:
+        case STEP_GPRS_RETRY_CLOSE:
+        case STEP_RESET_CLOSE:
+            submitStep("AT+SAPBR=0,1", "OK", 5000);
+            break;
+        case STEP_GPRS_CONTYPE:
+            submitStep("AT+SAPBR=3,1,\"CONTYPE\",\"GPRS\"", "OK", 5000);
+            break;
+        case STEP_GPRS_APN:
+            submitStep("AT+SAPBR=3,1,\"APN\",\"" + currentAPN + "\"", "OK", 5000);
+            break;
+        case STEP_GPRS_USER:
+            if (currentUsername.length() == 0) {
+                nextStep(STEP_GPRS_PWD);
+            } else {
+                submitStep("AT+SAPBR=3,1,\"USER\",\"" + currentUsername + "\"", "OK", 5000);
+            }
+            break;
+        case STEP_GPRS_PWD:
+            if (currentPassword.length() == 0) {
+                nextStep(STEP_GPRS_NTP_CID);
+            } else {
+                submitStep("AT+SAPBR=3,1,\"PWD\",\"" + currentPassword + "\"", "OK", 5000);
+            }
+            break;
+        case STEP_GPRS_NTP_CID:
+            submitStep("AT+CNTPCID=1", "OK", 3000);
+            break;
+        case STEP_GPRS_NTP_SERVER:
+            submitStep("AT+CNTP=\"pool.ntp.org\",0", "OK", 3000);
+            break;
+        case STEP_GPRS_NTP_SYNC:
+            submitStep("AT+CNTP", "OK", 30000);
+            break;
+        case STEP_GPRS_OPEN:
+            submitStep("AT+SAPBR=1,1", "OK", 30000);
+            break;
+        
+        // Connection reset
+        case STEP_RESET_CREG_OFF:
+            submitStep("AT+CREG=0", "OK", 3000);
+            break;
+        case STEP_RESET_CREG_ON:
+            submitStep("AT+CREG=1", "OK", 3000);
+            break;
+        
+        // HTTP
+        case STEP_HTTP_TERM:
+            if (httpSessionOpen) {
+                nextStep(STEP_HTTP_URL); // Reuse the open session
+            } else {
+                submitStep("AT+HTTPTERM", "OK", 2000); // Clear anything left open
+            }
+            break;
+        case STEP_HTTP_CLEANUP:
+            submitStep("AT+HTTPTERM", "OK", 2000);
+            break;
+        case STEP_HTTP_INIT:
+            submitStep("AT+HTTPINIT", "OK", 5000);
+            break;
+        case STEP_HTTP_CID:
+            submitStep("AT+HTTPPARA=\"CID\",1", "OK", 5000);
+            break;
+        case STEP_HTTP_URL:
+            if (job.target == httpSessionURL) {
+                nextStep(stepAfterURL(job));
+            } else {
+                submitStep("AT+HTTPPARA=\"URL\",\"" + job.target + "\"", "OK", 5000);
+            }
+            break;
+        case STEP_HTTP_CONTENT:
+            submitStep("AT+HTTPPARA=\"CONTENT\",\"" + job.contentType + "\"", "OK", 5000);
+            break;
+        case STEP_HTTP_ENCODING:
+            if (job.compressed) {
+                submitStep("AT+HTTPPARA=\"USERDATA\",\"Content-Encoding: " LZSS_CONTENT_ENCODING "\"", "OK", 5000);
+            } else {
+                submitStep("AT+HTTPPARA=\"USERDATA\",\"\"", "OK", 5000);
+            }
+            break;
+        case STEP_HTTP_REDIR:
+            submitStep("AT+HTTPPARA=\"REDIR\",1", "OK", 3000);
+            break;
+        case STEP_HTTP_TIMEOUT:
+            submitStep("AT+HTTPPARA=\"TIMEOUT\",30", "OK", 3000);
+            break;
+        case STEP_HTTP_DATA:
+            if (!engine.submitWithPayload("AT+HTTPDATA=" + String(job.body.length()) + ",10000", "DOWNLOAD",
+                                          job.body, false, "OK", 10000, onStepDone, this)) {
+                nextStep(STEP_HTTP_DATA, 10);
+            }
+            break;
+        case STEP_HTTP_ACTION:
+            // OK comes first; the request is done once +HTTPACTION reports
+            submitStep(job.post ? "AT+HTTPACTION=1" : "AT+HTTPACTION=0", "+HTTPACTION:", 35000);
+            break;
+        case STEP_HTTP_READ:
+            submitStep("AT+HTTPREAD", "OK", 10000);
+            break;
+        
+        // Registration, the same sequence as initialize()
+        case STEP_REGISTER_AT:
+            invalidateHTTPSession(); // The modem may have restarted
+            submitStep("AT", "OK", 3000);
+            break;
+        case STEP_REGISTER_ECHO:
+            submitStep("ATE0", "OK", 3000);
+            break;
+        case STEP_REGISTER_SMS_MODE:
+            submitStep("AT+CMGF=1", "OK", 3000);
+            break;
+        case STEP_REGISTER_NOTIFY:
+            submitStep("AT+CNMI=2,1,0,0,0", "OK", 3000);
+            break;
+        case STEP_REGISTER_CREG_ON:
+            submitStep("AT+CREG=1", "OK", 3000);
+            break;
+        case STEP_REGISTER_QUERY:
+            submitStep("AT+CREG?", "+CREG:", 10000);
+            break;
+    }
+}
+
+void Sim800L::stepDone(AtResult result, const String &response) {
+    if (jobCount == 0) {
+        return;
+    }
+    GSMJob &job = jobs[jobHead];
+    bool ok = (result == AT_RESULT_OK);
     
-    while (millis() - startTime < timeout) {
-        while (gsmSerial.available()) {
-            char c = gsmSerial.read();
-            response += c;
-            
-            if (response.indexOf(expected) >= 0) {
-                lastResponse = response;
-                return true;
+    switch (job.type) {
+        case GSM_JOB_SMS:
+            if (job.step == STEP_SMS_MODE) {
+                nextStep(STEP_SMS_SEND);
+            } else {
+                finishJob(ok, response);
             }
-            
-            if (response.indexOf("ERROR") >= 0) {
-                lastResponse = response;
-                return false;
+            break;
+        
+        case GSM_JOB_RESET:
+            switch (job.step) {
+                case STEP_RESET_HTTPTERM: invalidateHTTPSession(); nextStep(STEP_RESET_CLOSE); break;
+                case STEP_RESET_CLOSE: gprsConnected = false; nextStep(STEP_RESET_CREG_OFF, 3000); break;
+                case STEP_RESET_CREG_OFF: nextStep(STEP_RESET_CREG_ON, 1000); break;
+                case STEP_RESET_CREG_ON:
+                    // Bring the bearer back if there is one to restore
+                    if (status == GSM_NETWORK_CONNECTED && currentAPN.length() > 0) {
+                        nextStep(STEP_GPRS_CLOSE, 5000);
+                    } else {
+                        finishJob(true, response);
+                    }
+                    break;
+                default: gprsStepDone(job, ok, response); break;
+            }
+            break;
+        
+        case GSM_JOB_GPRS:
+            gprsStepDone(job, ok, response);
+            break;
+        
+        case GSM_JOB_HTTP:
+            httpStepDone(job, ok, response);
+            break;
+        
+        case GSM_JOB_REGISTER:
+            registerStepDone(job, ok, response);
+            break;
+    }
+}
+
+void Sim800L::registerStepDone(GSMJob &job, bool ok, const String &response) {
+    switch (job.step) {
+        case STEP_REGISTER_AT:
+        case STEP_REGISTER_SMS_MODE:
+            if (!ok) {
+                status = GSM_ERROR;
+                finishJob(false, response);
+            } else {
+                nextStep((GSMJobStep)(job.step + 1));
             }
+            break;
+        case STEP_REGISTER_ECHO:
+        case STEP_REGISTER_NOTIFY:
+        case STEP_REGISTER_CREG_ON:
+            nextStep((GSMJobStep)(job.step + 1));
+            break;
+        case STEP_REGISTER_QUERY: {
+            // Home or roaming
+            int registration = ok ? parseRegistration(response) : -1;
+            bool registered = (registration == 1 || registration == 5);
+            status = registered ? GSM_NETWORK_CONNECTED : GSM_NO_NETWORK;
+            finishJob(registered, response);
+            break;
         }
-        delay(10);
+        default:
+            finishJob(false, response);
+            break;
     }
-    
-    lastResponse = response;
+}
+
+void Sim800L::gprsStepDone(GSMJob &job, bool ok, const String &response) {
+    switch (job.step) {
+        case STEP_GPRS_CHECK_FIRST:
+            if (ok && response.indexOf("1,1,") >= 0) {
+                markBearerUp();
+                localIP = parseLocalIP(response);
+                lastDataActivity = millis();
+                finishJob(true, response);
+            } else if (currentAPN.length() == 0) {
+                gprsConnected = false;
+                finishJob(false, response); // No APN configured
+            } else {
+                nextStep(STEP_GPRS_HTTPTERM);
+            }
+            break;
+        case STEP_GPRS_HTTPTERM:
+            invalidateHTTPSession();
+            nextStep(STEP_GPRS_CLOSE);
+            break;
+        case STEP_GPRS_CLOSE:
+            gprsConnected = false;
+            invalidateHTTPSession(); // The session belongs to the old bearer
+            nextStep(STEP_GPRS_CONTYPE, 1000);
+            break;
+        case STEP_GPRS_CONTYPE:
+        case STEP_GPRS_APN:
+        case STEP_GPRS_USER:
+        case STEP_GPRS_PWD:
+            if (!ok) {
+                finishJob(false, response);
+            } else {
+                nextStep((GSMJobStep)(job.step + 1));
+            }
+            break;
+        case STEP_GPRS_NTP_CID:
+        case STEP_GPRS_NTP_SERVER:
+        case STEP_GPRS_NTP_SYNC:
+            nextStep((GSMJobStep)(job.step + 1)); // Time sync is best effort
+            break;
+        case STEP_GPRS_OPEN:
+            if (ok) {
+                nextStep(STEP_GPRS_VERIFY, 2000);
+                break;
+            }
+            // Fall through to the retry handling
+        case STEP_GPRS_VERIFY:
+            if (ok && job.step == STEP_GPRS_VERIFY && response.indexOf("1,1,") >= 0) {
+                markBearerUp();
+                localIP = parseLocalIP(response);
+                lastDataActivity = millis();
+                if (job.type == GSM_JOB_HTTP) {
+                    afterBearer(job);
+                } else {
+                    finishJob(true, response);
+                }
+            } else if (++job.attempts < (job.type == GSM_JOB_HTTP ? 1 : 3)) {
+                // Inside an HTTP job one try is enough: the upload queue retries
+                nextStep(STEP_GPRS_RETRY_CLOSE, 5000);
+            } else {
+                gprsConnected = false;
+                finishJob(false, response);
+            }
+            break;
+        case STEP_GPRS_RETRY_CLOSE:
+            nextStep(STEP_GPRS_OPEN, 2000);
+            break;
+        default:
+            finishJob(false, response);
+            break;
+    }
+}
+
+Sim800L::GSMJobStep Sim800L::stepAfterURL(GSMJob &job) {
+    if (!job.post || job.body.length() == 0) {
+        return STEP_HTTP_ACTION;
+    }
+    return nextParamStep(job);
+}
+
+Sim800L::GSMJobStep Sim800L::nextParamStep(GSMJob &job) {
+    if (job.contentType != httpSessionContent) {
+        return STEP_HTTP_CONTENT;
+    }
+    if (job.compressed != httpSessionCompressed) {
+        return STEP_HTTP_ENCODING;
+    }
+    return httpSessionTuned ? STEP_HTTP_DATA : STEP_HTTP_REDIR;
+}
+
+void Sim800L::invalidateHTTPSession() {
+    httpSessionOpen = false;
+    httpSessionURL = "";
+    httpSessionTuned = false;
+    httpSessionContent = "";
+    httpSessionCompressed = false;
+}
+
+bool Sim800L::useCachedBearer() {
+    if (gprsConnected && bearerCacheValid && millis() - bearerConfirmedAt < GSM_BEARER_CACHE_TTL) {
+        bearerStats.probesAvoided++;
+        return true;
+    }
+    bearerStats.probes++;
     return false;
 }
 
-void Sim800L::clearBuffer() {
-    while (gsmSerial.available()) {
-        gsmSerial.read();
+void Sim800L::markBearerUp() {
+    gprsConnected = true;
+    bearerCacheValid = true;
+    bearerConfirmedAt = millis();
+}
+
+void Sim800L::invalidateBearerCache() {
+    bearerCacheValid = false;
+}
+
+const GSMBearerStats &Sim800L::getBearerStats() {
+    return bearerStats;
+}
+
+void Sim800L::afterBearer(GSMJob &job) {
+    if (job.locationReport) {
+        job.body = buildLocationJSON(job); // From cached metadata only
+        job.compressed = false;
+    }
+    if (bodyCompression && job.post && !job.compressed && job.body.length() > 0) {
+        compressBody(job);
     }
+    nextStep(STEP_HTTP_TERM);
 }
 
-void Sim800L::sendSMS(const String &number, const String &message) {
+void Sim800L::httpStepDone(GSMJob &job, bool ok, const String &response) {
+    switch (job.step) {
+        case STEP_HTTP_BEARER:
+            if (ok && response.indexOf("1,1,") >= 0) {
+                markBearerUp();
+                localIP = parseLocalIP(response);
+                afterBearer(job);
+            } else if (currentAPN.length() > 0) {
+                nextStep(STEP_GPRS_HTTPTERM); // Reconnect, then carry on
+            } else {
+                gprsConnected = false;
+                finishJob(false, response);
+            }
+            break;
+        case STEP_HTTP_TERM:
+            nextStep(STEP_HTTP_INIT, 500);
+            break;
+        case STEP_HTTP_INIT:
+            if (ok) {
+                httpSessionOpen = true;
+                nextStep(STEP_HTTP_CID);
+            } else {
+                finishJob(false, response);
+            }
+            break;
+        case STEP_HTTP_CID:
+            nextStep(ok ? STEP_HTTP_URL : STEP_HTTP_CLEANUP);
+            break;
+        case STEP_HTTP_URL:
+            if (ok) {
+                httpSessionURL = job.target;
+                nextStep(stepAfterURL(job));
+            } else {
+                nextStep(STEP_HTTP_CLEANUP);
+            }
+            break;
+        case STEP_HTTP_CONTENT:
+            if (!ok) {
+                nextStep(STEP_HTTP_CLEANUP);
+                break;
+            }
+            httpSessionContent = job.contentType;
+            nextStep(nextParamStep(job));
+            break;
+        case STEP_HTTP_ENCODING:
+            if (!ok) {
+                nextStep(STEP_HTTP_CLEANUP);
+                break;
+            }
+            httpSessionCompressed = job.compressed;
+            nextStep(nextParamStep(job));
+            break;
+        case STEP_HTTP_REDIR:
+            nextStep(STEP_HTTP_TIMEOUT);
+            break;
+        case STEP_HTTP_TIMEOUT:
+            httpSessionTuned = true;
+            nextStep(STEP_HTTP_DATA);
+            break;
+        case STEP_HTTP_DATA:
+            nextStep(ok ? STEP_HTTP_ACTION : STEP_HTTP_CLEANUP);
+            break;
+        case STEP_HTTP_ACTION: {
+            int statusCode = ok ? extractHTTPStatusCode(response) : -1;
+            if (statusCode >= 200 && statusCode < 300) {
+                job.success = true;
+                lastDataActivity = millis();
+                markBearerUp(); // A completed transfer proves the bearer
+                if (!job.readBody) {
+                    finishJob(true, response); // Nobody reads the body, skip HTTPREAD
+                } else {
+                    nextStep(STEP_HTTP_READ);
+                }
+            } else if (statusCode >= 100 && statusCode < 600) {
+                // The server answered, so the session itself is fine
+                finishJob(false, "HTTP_ERROR_" + String(statusCode));
+            } else {
+                // 6xx are the modem's network / DNS errors; no reply at all is
+                // worse. Query the bearer again before the next request.
+                job.result = "HTTP_ERROR_" + String(statusCode);
+                nextStep(STEP_HTTP_CLEANUP);
+            }
+            break;
+        }
+        case STEP_HTTP_READ:
+            if (ok) {
+                finishJob(true, response);
+            } else {
+                nextStep(STEP_HTTP_CLEANUP);
+            }
+            break;
+        case STEP_HTTP_CLEANUP:
+            // Only failed requests get here
+            invalidateHTTPSession();
+            invalidateBearerCache();
+            finishJob(job.success, job.result);
+            break;
+        default:
+            // Bearer re-establishment inside an HTTP job
+            gprsStepDone(job, ok, response);
+            break;
+    }
+}
+
+// =============================================================================
+// SMS
+// =============================================================================
+
+bool Sim800L::queueSMS(const String &number, const String &message, GSMJobCallback callback, void *context) {
     if (status != GSM_NETWORK_CONNECTED) {
-        return;
+        return false;
     }
     
-    clearBuffer();
-    
-    // Set SMS text mode
-    gsmSerial.println("AT+CMGF=1");
-    delay(1000);
-    
-    // Set recipient
-    gsmSerial.print("AT+CMGS=\"");
-    gsmSerial.print(number);
-    gsmSerial.println("\"");
-    delay(1000);
-    
-    // Send message
-    gsmSerial.print(message);
-    gsmSerial.write(26); // Ctrl+Z to send
-    delay(5000);
-    
-    // Clear any response
-    clearBuffer();
+    GSMJob *job = newJob(GSM_JOB_SMS, STEP_SMS_MODE, callback, context);
+    if (job == NULL) {
+        return false;
+    }
+    job->target = number;
+    job->body = message;
+    return true;
+}
+
+void Sim800L::sendSMS(const String &number, const String &message) {
+    // Queued; goes out from update() without holding up the caller
+    queueSMS(number, message);
 }
 
 bool Sim800L::sendLocationSMS(const String &number, const String &location, const String &alertType) {
@@ -129,8 +950,7 @@ bool Sim800L::sendLocationSMS(const String &number, const String &location, cons
     message += "\nLocation: " + location;
     message += "\nTime: " + String(millis() / 1000) + "s";
     
-    sendSMS(number, message);
-    return true;
+    return queueSMS(number, message);
 }
 
 bool Sim800L::available() {
@@ -148,28 +968,84 @@ bool Sim800L::isNetworkConnected() {
     return (status == GSM_NETWORK_CONNECTED);
 }
 
+int Sim800L::parseSignal(const String &response) {
+    int start = response.indexOf("+CSQ: ") + 6;
+    int end = response.indexOf(",", start);
+    if (start > 5 && end > start) {
+        return response.substring(start, end).toInt();
+    }
+    return -1;
+}
+
+String Sim800L::parseIMEI(const String &response) {
+    // Skip blank lines (and an echo, if enabled) up to the digits
+    int start = 0;
+    while (start < (int)response.length()) {
+        char c = response.charAt(start);
+        if (c >= '0' && c <= '9') {
+            break;
+        }
+        start = response.indexOf('\n', start);
+        if (start < 0) {
+            return "Unknown";
+        }
+        start++;
+    }
+    int end = response.indexOf('\r', start);
+    if (end < 0) {
+        end = response.indexOf('\n', start);
+    }
+    if (start < (int)response.length() && end > start) {
+        return response.substring(start, end);
+    }
+    return "Unknown";
+}
+
+String Sim800L::parseLocalIP(const String &response) {
+    // +SAPBR: 1,1,"10.x.x.x"
+    int startQuote = response.indexOf("\"", response.indexOf("1,1,"));
+    int endQuote = response.indexOf("\"", startQuote + 1);
+    if (startQuote > 0 && endQuote > startQuote) {
+        return response.substring(startQuote + 1, endQuote);
+    }
+    return "0.0.0.0";
+}
+
 int Sim800L::getSignalStrength() {
     if (sendATCommand("AT+CSQ", "+CSQ:", 3000)) {
-        // Parse signal strength from response
-        int start = lastResponse.indexOf("+CSQ: ") + 6;
-        int end = lastResponse.indexOf(",", start);
-        if (start > 5 && end > start) {
-            return lastResponse.substring(start, end).toInt();
-        }
+        recordSignal(parseSignal(lastResponse));
+        return signalStrength;
     }
     return -1;
 }
 
+int Sim800L::getLastSignalStrength() {
+    return signalStrength;
+}
+
+unsigned long Sim800L::getSignalSampleTime() {
+    return signalSampledAt;
+}
+
+void Sim800L::recordSignal(int signal) {
+    signalStrength = signal;
+    signalSampledAt = millis();
+    nextSignalSample = signalSampledAt + GSM_SIGNAL_SAMPLE_INTERVAL;
+}
+
+void Sim800L::onSignalSampled(void *context, AtResult result, const String &response) {
+    Sim800L *modem = (Sim800L *)context;
+    modem->signalSamplePending = false;
+    if (result == AT_RESULT_OK) {
+        modem->recordSignal(parseSignal(response)); // Otherwise try again next interval
+    }
+}
+
 String Sim800L::getIMEI() {
-    if (sendATCommand("AT+GSN", "OK", 3000)) {
-        // Extract IMEI from response
-        int start = lastResponse.indexOf('\n') + 1;
-        int end = lastResponse.indexOf('\n', start);
-        if (start > 0 && end > start) {
-            return lastResponse.substring(start, end);
-        }
+    if (imei == "Unknown" && sendATCommand("AT+GSN", "OK", 3000)) {
+        imei = parseIMEI(lastResponse);
     }
-    return "Unknown";
+    return imei;
 }
 
 void Sim800L::powerOn() {
@@ -178,80 +1054,197 @@ void Sim800L::powerOn() {
 }
 
 void Sim800L::powerOff() {
+    // Let queued SMS go out before the modem shuts down
+    finishPendingJobs(90000);
     sendATCommand("AT+CPOWD=1", "OK", 5000);
 }
 
-bool Sim800L::initializeGPRS(const String &apn, const String &username, const String &password) {
+// =============================================================================
+// GPRS
+// =============================================================================
+
+bool Sim800L::queueGPRS(const String &apn, const String &username, const String &password,
+                        GSMJobCallback callback, void *context) {
     if (status != GSM_NETWORK_CONNECTED) {
         return false;
     }
     
-    // Store APN credentials for reconnection
+    // Stored for later reconnections
     currentAPN = apn;
     currentUsername = username;
     currentPassword = password;
-    
-    // First, close any existing GPRS connection
-    sendATCommand("AT+SAPBR=0,1", "OK", 5000);
-    delay(1000);
-    
-    // Configure bearer profile for GPRS
-    if (!sendATCommand("AT+SAPBR=3,1,\"CONTYPE\",\"GPRS\"", "OK", 5000)) {
+    return newJob(GSM_JOB_GPRS, STEP_GPRS_CLOSE, callback, context) != NULL;
+}
+
+bool Sim800L::queueConnectionCheck(GSMJobCallback callback, void *context) {
+    return newJob(GSM_JOB_GPRS, STEP_GPRS_CHECK_FIRST, callback, context) != NULL;
+}
+
+bool Sim800L::queueConnectionReset(GSMJobCallback callback, void *context) {
+    return newJob(GSM_JOB_RESET, STEP_RESET_HTTPTERM, callback, context) != NULL;
+}
+
+bool Sim800L::queueRegistration(GSMJobCallback callback, void *context) {
+    return newJob(GSM_JOB_REGISTER, STEP_REGISTER_AT, callback, context) != NULL;
+}
+
+bool Sim800L::initializeGPRS(const String &apn, const String &username, const String &password) {
+    if (!queueGPRS(apn, username, password)) {
         return false;
     }
+    return waitForJob(nextJobId);
+}
+
+bool Sim800L::reconnectGPRS() {
+    if (currentAPN.length() == 0) {
+        return false; // No APN configured
+    }
     
-    // Set APN
-    String apnCommand = "AT+SAPBR=3,1,\"APN\",\"" + apn + "\"";
-    if (!sendATCommand(apnCommand, "OK", 5000)) {
+    // Drop HTTP and the bearer, then bring it up with the stored credentials
+    GSMJob *job = newJob(GSM_JOB_GPRS, STEP_GPRS_HTTPTERM, NULL, NULL);
+    if (job == NULL) {
         return false;
     }
-    
-    // Set username if provided
-    if (username.length() > 0) {
-        String userCommand = "AT+SAPBR=3,1,\"USER\",\"" + username + "\"";
-        if (!sendATCommand(userCommand, "OK", 5000)) {
-            return false;
-        }
+    return waitForJob(job->id);
+}
+
+// =============================================================================
+// HTTP
+// =============================================================================
+
+bool Sim800L::queueHTTP(const String &method, const String &url, const String &data,
+                        GSMJobCallback callback, void *context) {
+    if (method != "GET" && method != "POST") {
+        return false;
     }
     
-    // Set password if provided
-    if (password.length() > 0) {
-        String passCommand = "AT+SAPBR=3,1,\"PWD\",\"" + password + "\"";
-        if (!sendATCommand(passCommand, "OK", 5000)) {
-            return false;
-        }
+    GSMJob *job = newJob(GSM_JOB_HTTP, STEP_HTTP_BEARER, callback, context);
+    if (job == NULL) {
+        return false;
     }
+    job->post = (method == "POST");
+    job->target = url;
+    job->body = data;
+    return true;
+}
+
+bool Sim800L::queueLocationHTTP(const String &url, const String &deviceId, int32_t latitudeE7, int32_t longitudeE7,
+                                const String &alertType, unsigned long capturedAt,
+                                GSMJobCallback callback, void *context) {
+    GSMJob *job = newJob(GSM_JOB_HTTP, STEP_HTTP_BEARER, callback, context);
+    if (job == NULL) {
+        return false;
+    }
+    job->post = true;
+    job->locationReport = true;
+    job->readBody = false;
+    job->target = url;
+    job->deviceId = deviceId;
+    job->alertType = alertType;
+    job->latitudeE7 = latitudeE7;
+    job->longitudeE7 = longitudeE7;
+    job->capturedAt = capturedAt;
+    return true;
+}
+
+bool Sim800L::queueLocationBatchHTTP(const String &url, const String &deviceId, const String &fixes,
+                                     GSMJobCallback callback, void *context) {
+    GSMJob *job = newJob(GSM_JOB_HTTP, STEP_HTTP_BEARER, callback, context);
+    if (job == NULL) {
+        return false;
+    }
+    job->post = true;
+    job->locationReport = true;
+    job->readBody = false;
+    job->target = url;
+    job->deviceId = deviceId;
+    job->fixes = fixes;
+    return true;
+}
+
+void Sim800L::setBodyCompression(bool enabled) {
+    bodyCompression = enabled;
+}
+
+static void appendCompressed(void *context, uint8_t value) {
+    ((String *)context)->concat((char)value);
+}
+
+void Sim800L::compressBody(GSMJob &job) {
+    // Streams straight into the new body; the encoder is about 300 bytes
+    String packed = "";
+    packed.reserve(job.body.length());
+    LzssEncoder encoder(appendCompressed, &packed);
+    for (unsigned int i = 0; i < job.body.length(); i++) {
+        encoder.write(job.body[i]);
+    }
+    encoder.finish();
     
-    // Enable automatic time synchronization
-    sendATCommand("AT+CNTPCID=1", "OK", 3000);
-    sendATCommand("AT+CNTP=\"pool.ntp.org\",0", "OK", 3000);
-    sendATCommand("AT+CNTP", "OK", 30000);
-    
-    // Open GPRS connection with retries
-    for (int attempts = 0; attempts < 3; attempts++) {
-        if (sendATCommand("AT+SAPBR=1,1", "OK", 30000)) {
-            delay(2000);
-            
-            // Verify GPRS connection
-            if (sendATCommand("AT+SAPBR=2,1", "OK", 5000)) {
-                if (lastResponse.indexOf("1,1,") >= 0) { // Check if status is connected
-                    gprsConnected = true;
-                    lastDataActivity = millis();
-                    return true;
-                }
-            }
-        }
-        
-        // Wait before retry
-        delay(5000);
-        
-        // Close connection for retry
-        sendATCommand("AT+SAPBR=0,1", "OK", 5000);
-        delay(2000);
+    // Already dense bodies are sent as they are
+    if (packed.length() < job.body.length()) {
+        job.body = packed;
+        job.compressed = true;
+    }
+}
+
+bool Sim800L::queueBinaryHTTP(const String &url, const String &contentType, const String &payload,
+                              GSMJobCallback callback, void *context) {
+    GSMJob *job = newJob(GSM_JOB_HTTP, STEP_HTTP_BEARER, callback, context);
+    if (job == NULL) {
+        return false;
+    }
+    job->post = true;
+    job->readBody = false;
+    job->target = url;
+    job->body = payload;
+    job->contentType = contentType;
+    return true;
+}
+
+void Sim800L::appendLocationFix(String &fixes, int32_t latitudeE7, int32_t longitudeE7, unsigned long capturedAt) {
+    char latitude[COORDINATE_TEXT_SIZE];
+    char longitude[COORDINATE_TEXT_SIZE];
+    formatCoordinate(latitudeE7, latitude);
+    formatCoordinate(longitudeE7, longitude);
+    
+    if (fixes.length() > 0) {
+        fixes += ",";
+    }
+    fixes += "{\"latitude\":" + String(latitude) + ",";
+    fixes += "\"longitude\":" + String(longitude) + ",";
+    fixes += "\"timestamp\":\"" + String(capturedAt) + "\"}";
+}
+
+String Sim800L::buildLocationJSON(GSMJob &job) {
+    if (job.fixes.length() > 0) {
+        // Batch: device metadata once, then the fixes oldest first
+        String jsonData = "{";
+        jsonData += "\"deviceId\":\"" + job.deviceId + "\",";
+        jsonData += "\"signalStrength\":" + String(signalStrength) + ",";
+        jsonData += "\"localIP\":\"" + localIP + "\",";
+        jsonData += "\"imei\":\"" + imei + "\",";
+        jsonData += "\"locations\":[" + job.fixes + "]";
+        jsonData += "}";
+        return jsonData;
     }
     
-    gprsConnected = false;
-    return false;
+    char latitude[COORDINATE_TEXT_SIZE];
+    char longitude[COORDINATE_TEXT_SIZE];
+    formatCoordinate(job.latitudeE7, latitude);
+    formatCoordinate(job.longitudeE7, longitude);
+    
+    // Create enhanced JSON payload with additional metadata
+    String jsonData = "{";
+    jsonData += "\"deviceId\":\"" + job.deviceId + "\",";
+    jsonData += "\"latitude\":" + String(latitude) + ",";
+    jsonData += "\"longitude\":" + String(longitude) + ",";
+    jsonData += "\"timestamp\":\"" + String(job.capturedAt) + "\",";
+    jsonData += "\"alertType\":\"" + job.alertType + "\",";
+    jsonData += "\"signalStrength\":" + String(signalStrength) + ",";
+    jsonData += "\"localIP\":\"" + localIP + "\",";
+    jsonData += "\"imei\":\"" + imei + "\"";
+    jsonData += "}";
+    return jsonData;
 }
 
 bool Sim800L::sendHTTPPOST(const String &url, const String &jsonData, String &response) {
@@ -262,50 +1255,23 @@ bool Sim800L::sendHTTPGET(const String &url, String &response) {
     return performHTTPRequest("GET", url, "", response);
 }
 
-bool Sim800L::sendLocationHTTP(const String &url, const String &deviceId, float latitude, float longitude, const String &alertType) {
-    // Ensure GPRS connection is active
-    if (!maintainConnection()) {
+bool Sim800L::performHTTPRequest(const String &method, const String &url, const String &data, String &response) {
+    response = "";
+    if (!queueHTTP(method, url, data)) {
         return false;
     }
-    
-    // Create enhanced JSON payload with additional metadata
-    String jsonData = "{";
-    jsonData += "\"deviceId\":\"" + deviceId + "\",";
-    jsonData += "\"latitude\":" + String(latitude, 6) + ",";
-    jsonData += "\"longitude\":" + String(longitude, 6) + ",";
-    jsonData += "\"timestamp\":\"" + String(millis()) + "\",";
-    
-    if (alertType.length() > 0) {
-        jsonData += "\"alertType\":\"" + alertType + "\",";
-    } else {
-        jsonData += "\"alertType\":\"\",";
-    }
-    
-    jsonData += "\"signalStrength\":" + String(getSignalStrength()) + ",";
-    jsonData += "\"localIP\":\"" + getLocalIP() + "\",";
-    jsonData += "\"imei\":\"" + getIMEI() + "\"";
-    jsonData += "}";
-    
-    String response;
-    
-    // Retry logic for HTTP requests
-    for (int attempt = 0; attempt < 3; attempt++) {
-        if (sendHTTPPOST(url, jsonData, response)) {
-            return true;
-        }
-        
-        // If first attempt fails, try to reconnect GPRS
-        if (attempt == 0) {
-            if (!reconnectGPRS()) {
-                continue; // Skip this attempt if reconnection fails
-            }
-        }
-        
-        // Wait before retry
-        delay(2000 * (attempt + 1));
+    bool success = waitForJob(nextJobId);
+    response = lastJobResponse;
+    return success;
+}
+
+bool Sim800L::sendLocationHTTP(const String &url, const String &deviceId, int32_t latitudeE7, int32_t longitudeE7, const String &alertType) {
+    // A single attempt; retries and backoff belong to the caller. The job
+    // re-establishes the bearer itself if it has dropped.
+    if (!queueLocationHTTP(url, deviceId, latitudeE7, longitudeE7, alertType, millis())) {
+        return false;
     }
-    
-    return false;
+    return waitForJob(nextJobId);
 }
 
 void Sim800L::disconnectGPRS() {
@@ -315,34 +1281,28 @@ void Sim800L::disconnectGPRS() {
     // Close GPRS connection
     sendATCommand("AT+SAPBR=0,1", "OK", 5000);
     gprsConnected = false;
+    invalidateHTTPSession();
 }
 
 // New enhanced methods implementation
 
 bool Sim800L::isGPRSConnected() {
+    // Cleared by the +SAPBR 1: DEACT URC when the network drops the bearer
     if (!gprsConnected) {
         return false;
     }
-    
-    // Check GPRS bearer status
-    if (sendATCommand("AT+SAPBR=2,1", "OK", 5000)) {
-        return lastResponse.indexOf("1,1,") >= 0;
+    if (useCachedBearer()) {
+        return true;
     }
     
-    return false;
-}
-
-bool Sim800L::reconnectGPRS() {
-    if (currentAPN.length() == 0) {
-        return false; // No APN configured
+    if (sendATCommand("AT+SAPBR=2,1", "OK", 5000) && lastResponse.indexOf("1,1,") >= 0) {
+        markBearerUp();
+        localIP = parseLocalIP(lastResponse);
+        return true;
     }
-    
-    // Disconnect first
-    disconnectGPRS();
-    delay(2000);
-    
-    // Reconnect with stored credentials
-    return initializeGPRS(currentAPN, currentUsername, currentPassword);
+    gprsConnected = false;
+    invalidateHTTPSession();
+    return false;
 }
 
 bool Sim800L::checkInternetConnectivity() {
@@ -350,29 +1310,18 @@ bool Sim800L::checkInternetConnectivity() {
         return false;
     }
     
-    // Try to ping a reliable server (Google DNS)
-    if (sendATCommand("AT+CIPPING=\"8.8.8.8\"", "OK", 15000)) {
-        // Wait for ping result
-        delay(5000);
-        return lastResponse.indexOf("+CIPPING: 1,") >= 0; // Success response
-    }
-    
-    return false;
-}
-
-bool Sim800L::ensureGPRSConnection() {
-    if (isGPRSConnected()) {
+    // Try to ping a reliable server (Google DNS); the result line follows OK
+    if (sendATCommand("AT+CIPPING=\"8.8.8.8\"", "+CIPPING: 1,", 20000)) {
         return true;
     }
     
-    // Try to reconnect
-    return reconnectGPRS();
+    return false;
 }
 
 bool Sim800L::maintainConnection() {
-    // Check if connection is still active
-    if (!isGPRSConnected()) {
-        return reconnectGPRS();
+    // Bearer query, reconnecting if it is down
+    if (!queueConnectionCheck() || !waitForJob(nextJobId)) {
+        return false;
     }
     
     // Update activity timestamp
@@ -382,31 +1331,13 @@ bool Sim800L::maintainConnection() {
 
 void Sim800L::resetConnection() {
     // Perform a complete reset of the connection
-    disconnectGPRS();
-    delay(3000);
-    
-    // Reset network registration
-    sendATCommand("AT+CREG=0", "OK", 3000);
-    delay(1000);
-    sendATCommand("AT+CREG=1", "OK", 3000);
-    delay(5000);
-    
-    // Re-initialize if network is available
-    if (status == GSM_NETWORK_CONNECTED && currentAPN.length() > 0) {
-        initializeGPRS(currentAPN, currentUsername, currentPassword);
+    if (queueConnectionReset()) {
+        waitForJob(nextJobId);
     }
 }
 
 String Sim800L::getLocalIP() {
-    if (sendATCommand("AT+SAPBR=2,1", "OK", 5000)) {
-        // Extract IP from response: +SAPBR: 1,1,"10.x.x.x"
-        int startQuote = lastResponse.indexOf("\"", lastResponse.indexOf("1,1,"));
-        int endQuote = lastResponse.indexOf("\"", startQuote + 1);
-        if (startQuote > 0 && endQuote > startQuote) {
-            return lastResponse.substring(startQuote + 1, endQuote);
-        }
-    }
-    return "0.0.0.0";
+    return gprsConnected ? localIP : "0.0.0.0";
 }
 
 void Sim800L::enableAutoTimeSync() {
@@ -440,100 +1371,6 @@ int Sim800L::extractHTTPStatusCode(const String &response) {
     return -1;
 }
 
-bool Sim800L::performHTTPRequest(const String &method, const String &url, const String &data, String &response) {
-    response = "";
-    
-    // Ensure GPRS connection is active
-    if (!ensureGPRSConnection()) {
-        return false;
-    }
-    
-    // Terminate any existing HTTP session
-    sendATCommand("AT+HTTPTERM", "OK", 2000);
-    delay(500);
-    
-    // Initialize HTTP service
-    if (!sendATCommand("AT+HTTPINIT", "OK", 5000)) {
-        return false;
-    }
-    
-    // Set HTTP parameters
-    if (!sendATCommand("AT+HTTPPARA=\"CID\",1", "OK", 5000)) {
-        sendATCommand("AT+HTTPTERM", "OK", 5000);
-        return false;
-    }
-    
-    // Set URL
-    String urlCommand = "AT+HTTPPARA=\"URL\",\"" + url + "\"";
-    if (!sendATCommand(urlCommand, "OK", 5000)) {
-        sendATCommand("AT+HTTPTERM", "OK", 5000);
-        return false;
-    }
-    
-    // Set content type for POST requests
-    if (method == "POST" && data.length() > 0) {
-        if (!sendATCommand("AT+HTTPPARA=\"CONTENT\",\"application/json\"", "OK", 5000)) {
-            sendATCommand("AT+HTTPTERM", "OK", 5000);
-            return false;
-        }
-        
-        // Set request timeout
-        sendATCommand("AT+HTTPPARA=\"REDIR\",1", "OK", 3000);
-        sendATCommand("AT+HTTPPARA=\"TIMEOUT\",30", "OK", 3000);
-        
-        // Upload data
-        String dataCommand = "AT+HTTPDATA=" + String(data.length()) + ",10000";
-        gsmSerial.println(dataCommand);
-        delay(1000);
-        
-        if (waitForResponse("DOWNLOAD", 5000)) {
-            gsmSerial.print(data);
-            if (!waitForResponse("OK", 10000)) {
-                sendATCommand("AT+HTTPTERM", "OK", 5000);
-                return false;
-            }
-        } else {
-            sendATCommand("AT+HTTPTERM", "OK", 5000);
-            return false;
-        }
-    }
-    
-    // Execute HTTP request
-    String actionCommand = "AT+HTTPACTION=";
-    if (method == "GET") {
-        actionCommand += "0";
-    } else if (method == "POST") {
-        actionCommand += "1";
-    } else {
-        sendATCommand("AT+HTTPTERM", "OK", 5000);
-        return false;
-    }
-    
-    if (sendATCommand(actionCommand, "OK", 5000)) {
-        // Wait for HTTP response with longer timeout
-        if (waitForResponse("+HTTPACTION:", 30000)) {
-            int statusCode = extractHTTPStatusCode(lastResponse);
-            
-            if (statusCode >= 200 && statusCode < 300) {
-                // Read response data
-                if (sendATCommand("AT+HTTPREAD", "OK", 10000)) {
-                    response = lastResponse;
-                    lastDataActivity = millis();
-                }
-                sendATCommand("AT+HTTPTERM", "OK", 5000);
-                return true;
-            } else {
-                // Log error status
-                response = "HTTP_ERROR_" + String(statusCode);
-            }
-        }
-    }
-    
-    // Cleanup on error
-    sendATCommand("AT+HTTPTERM", "OK", 5000);
-    return false;
-}
-
 // =============================================================================
 // AT COMMAND TESTING FUNCTIONS
 // =============================================================================
@@ -723,6 +1560,10 @@ void Sim800L::runGPRSTests() {
     // Test GPRS status
     testATCommand("AT+CGPADDR", "OK", "Get GPRS IP Address");
     
+    // The bearer was reconfigured and closed above without a URC
+    gprsConnected = false;
+    invalidateHTTPSession();
+    
     Serial.println("GPRS Tests Complete\n");
     Serial.println("[NOTE] GPRS tests require valid APN configuration");
 }
@@ -756,6 +1597,7 @@ void Sim800L::runHTTPTests() {
     
     // Terminate HTTP service
     testATCommand("AT+HTTPTERM", "OK", "Terminate HTTP Service");
+    invalidateHTTPSession();
     
     Serial.println("HTTP Tests Complete\n");
 }
@@ -5,7 +5,11 @@
 #define SIM800L_H
 
 #include <Arduino.h>
-#include <SoftwareSerial.h>
+#include "SerialTransport.h"
+#include "AtEngine.h"
+
+#define GSM_JOB_QUEUE_SIZE 4        // SMS / GPRS / HTTP sequences waiting or running
+#define GSM_HTTP_CONTENT_JSON "application/json"
 
 enum GSMStatus {
     GSM_INIT,
@@ -15,9 +19,39 @@ enum GSMStatus {
     GSM_NETWORK_CONNECTED
 };
 
+enum GSMJobType {
+    GSM_JOB_SMS,
+    GSM_JOB_GPRS,
+    GSM_JOB_RESET,
+    GSM_JOB_HTTP,
+    GSM_JOB_REGISTER
+};
+
+struct GSMBearerStats {
+    unsigned long probes;           // AT+SAPBR=2,1 state queries sent
+    unsigned long probesAvoided;    // Answered from the cached state instead
+};
+
+// Unsolicited modem events, reported as their URCs arrive
+enum GSMEvent {
+    GSM_EVENT_SMS_RECEIVED,         // value: message index in SIM storage (+CMTI)
+    GSM_EVENT_CALL_RING,            // RING
+    GSM_EVENT_BEARER_LOST,          // +SAPBR 1: DEACT
+    GSM_EVENT_REGISTRATION,         // value: 1 registered, 0 not (+CREG)
+    GSM_EVENT_NETWORK_TIME          // *PSUTTZ, see getNetworkTime()
+};
+
+// Runs from update() or while a blocking method waits, so it must not
+// call the blocking methods below.
+typedef void (*GSMEventCallback)(void *context, GSMEvent event, int value);
+
+// Completion of a queued job. Runs from update(), so it must not call the
+// blocking methods below.
+typedef void (*GSMJobCallback)(void *context, bool success, const String &response);
+
 class Sim800L {
 public:
-    Sim800L(SoftwareSerial &serial);
+    Sim800L(SerialTransport &serial);
     void begin(long baudrate = 9600);
     bool initialize();
     GSMStatus getStatus();
@@ -26,12 +60,74 @@ public:
     bool available();
     String read();
     bool isNetworkConnected();
-    int getSignalStrength();
+    int getSignalStrength();        // Fresh AT+CSQ reading, also refreshes the cache
     void powerOn();
     void powerOff();
-    String getIMEI();
+    String getIMEI();               // Read once, then cached
+    
+    // Cached device metadata, as used in location reports. Nothing here
+    // talks to the modem.
+    int getLastSignalStrength();    // -1 until the first sample
+    unsigned long getSignalSampleTime();  // millis() of the last sample, 0 if none
     bool sendATCommand(const String &command, const String &expectedResponse = "OK", int timeout = 5000);
     
+    // Called every few milliseconds while a command blocks, so the owner
+    // can keep draining other serial ports
+    void setIdleCallback(void (*callback)(void *context), void *context);
+    
+    // Registration, bearer and GSM_NETWORK_CONNECTED state follow the URCs
+    // as they arrive; the callback sees each event as well
+    void setEventCallback(GSMEventCallback callback, void *context);
+    String getNetworkTime();        // Last *PSUTTZ time, empty until the network sends one
+    
+    // Non-blocking operation. Jobs are queued and run one at a time as AT
+    // command sequences pumped by update(), which must be called from the
+    // main loop. queue* return false if the job queue is full or the
+    // network is not up.
+    void update();
+    bool isBusy();
+    bool queueSMS(const String &number, const String &message, GSMJobCallback callback = NULL, void *context = NULL);
+    bool queueGPRS(const String &apn, const String &username, const String &password,
+                   GSMJobCallback callback = NULL, void *context = NULL);
+    bool queueConnectionCheck(GSMJobCallback callback = NULL, void *context = NULL);  // Reconnects if the bearer is down
+    bool queueConnectionReset(GSMJobCallback callback = NULL, void *context = NULL);
+    // The modem setup of initialize() as a job; succeeds once registered.
+    // Does not need the network, unlike the other queue* methods.
+    bool queueRegistration(GSMJobCallback callback = NULL, void *context = NULL);
+    bool queueHTTP(const String &method, const String &url, const String &data,
+                   GSMJobCallback callback = NULL, void *context = NULL);
+    // capturedAt is the millis() time of the fix, reported as its timestamp
+    bool queueLocationHTTP(const String &url, const String &deviceId, int32_t latitudeE7, int32_t longitudeE7,
+                           const String &alertType, unsigned long capturedAt,
+                           GSMJobCallback callback = NULL, void *context = NULL);
+    // Several routine fixes in one POST. fixes is built with appendLocationFix().
+    bool queueLocationBatchHTTP(const String &url, const String &deviceId, const String &fixes,
+                                GSMJobCallback callback = NULL, void *context = NULL);
+    static void appendLocationFix(String &fixes, int32_t latitudeE7, int32_t longitudeE7, unsigned long capturedAt);
+    // LZSS-compress POST bodies (Content-Encoding: x-lzss) when it makes
+    // them smaller. The server must decode them; off by default.
+    void setBodyCompression(bool enabled);
+    // POST a body that is already encoded, e.g. a binary location report
+    bool queueBinaryHTTP(const String &url, const String &contentType, const String &payload,
+                         GSMJobCallback callback = NULL, void *context = NULL);
+    void finishPendingJobs(unsigned long timeout);  // Blocks until the job queue drains
+    const AtEngineStats &getEngineStats();
+    const GSMBearerStats &getBearerStats();
+    
+    // Baud rate negotiation. rates are candidates, fastest first.
+    // negotiateBaud finds the modem's current rate (preferredRate is tried
+    // first), then moves it up with AT+IPR to the fastest candidate that
+    // verifies cleanly and stores it in the modem profile. Returns the
+    // final rate, 0 if the modem never answered.
+    long negotiateBaud(long preferredRate, const long *rates, uint8_t count);
+    long findBaud(long preferredRate, const long *rates, uint8_t count);
+    bool probeBaud(long rate);
+    bool verifyBaud(int rounds);
+    bool setModemBaud(long rate);
+    long getBaudRate();
+    unsigned long measureATLatency(int rounds);  // Mean "AT" round trip in us, 0 on failure
+    const SerialTransportStats &getLinkStats();
+    
     // Enhanced HTTP/GPRS functions
     bool initializeGPRS(const String &apn, const String &username = "", const String &password = "");
     bool isGPRSConnected();
@@ -39,7 +135,7 @@ public:
     bool checkInternetConnectivity();
     bool sendHTTPPOST(const String &url, const String &jsonData, String &response);
     bool sendHTTPGET(const String &url, String &response);
-    bool sendLocationHTTP(const String &url, const String &deviceId, float latitude, float longitude, const String &alertType = "");
+    bool sendLocationHTTP(const String &url, const String &deviceId, int32_t latitudeE7, int32_t longitudeE7, const String &alertType = "");  // One attempt
     void disconnectGPRS();
     String getLocalIP();
     void enableAutoTimeSync();
@@ -62,7 +158,84 @@ public:
     void printATTestHeader(const String &category);
     
 private:
-    SoftwareSerial &gsmSerial;
+    enum GSMJobStep {
+        STEP_SMS_MODE,
+        STEP_SMS_SEND,
+        STEP_GPRS_CHECK_FIRST,      // Connection check: done if the bearer is already up
+        STEP_GPRS_HTTPTERM,         // Reconnect: drop the HTTP service first
+        STEP_GPRS_CLOSE,
+        STEP_GPRS_CONTYPE,
+        STEP_GPRS_APN,
+        STEP_GPRS_USER,
+        STEP_GPRS_PWD,
+        STEP_GPRS_NTP_CID,
+        STEP_GPRS_NTP_SERVER,
+        STEP_GPRS_NTP_SYNC,
+        STEP_GPRS_OPEN,
+        STEP_GPRS_VERIFY,
+        STEP_GPRS_RETRY_CLOSE,
+        STEP_RESET_HTTPTERM,
+        STEP_RESET_CLOSE,
+        STEP_RESET_CREG_OFF,
+        STEP_RESET_CREG_ON,
+        STEP_HTTP_BEARER,
+        STEP_HTTP_TERM,
+        STEP_HTTP_INIT,
+        STEP_HTTP_CID,
+        STEP_HTTP_URL,
+        STEP_HTTP_CONTENT,
+        STEP_HTTP_ENCODING,
+        STEP_HTTP_REDIR,
+        STEP_HTTP_TIMEOUT,
+        STEP_HTTP_DATA,
+        STEP_HTTP_ACTION,
+        STEP_HTTP_READ,
+        STEP_HTTP_CLEANUP,
+        STEP_REGISTER_AT,
+        STEP_REGISTER_ECHO,
+        STEP_REGISTER_SMS_MODE,
+        STEP_REGISTER_NOTIFY,
+        STEP_REGISTER_CREG_ON,
+        STEP_REGISTER_QUERY
+    };
+    
+    struct GSMJob {
+        unsigned long id;
+        GSMJobType type;
+        GSMJobStep step;
+        bool waiting;               // Next step is due at resumeAt
+        unsigned long resumeAt;
+        uint8_t attempts;
+        bool post;
+        bool locationReport;        // Body is built once the bearer is up
+        bool readBody;              // Fetch the reply with AT+HTTPREAD
+        String target;              // SMS number or URL
+        String body;                // SMS text or HTTP body
+        String contentType;         // HTTP body type
+        bool compressed;            // body is LZSS-compressed
+        String deviceId;
+        String alertType;
+        int32_t latitudeE7;
+        int32_t longitudeE7;
+        unsigned long capturedAt;
+        String fixes;               // Batched reports, JSON objects
+        bool success;
+        String result;
+        GSMJobCallback callback;
+        void *context;
+    };
+    
+    SerialTransport &gsmSerial;
+    AtEngine engine;
+    GSMJob jobs[GSM_JOB_QUEUE_SIZE];
+    uint8_t jobHead;
+    uint8_t jobCount;
+    unsigned long nextJobId;
+    unsigned long finishedJobId;
+    bool lastJobSuccess;
+    String lastJobResponse;
+    bool syncPending;
+    AtResult syncResult;
     GSMStatus status;
     String lastResponse;
     unsigned long lastCommandTime;
@@ -71,9 +244,69 @@ private:
     String currentUsername;
     String currentPassword;
     bool gprsConnected;
-    bool waitForResponse(const String &expected, int timeout);
+    bool bearerCacheValid;          // gprsConnected confirmed and not invalidated since
+    unsigned long bearerConfirmedAt;
+    GSMBearerStats bearerStats;
+    String localIP;                 // Bearer address, valid while gprsConnected
+    String imei;
+    int signalStrength;
+    unsigned long signalSampledAt;
+    unsigned long nextSignalSample;
+    bool signalSamplePending;
+    
+    // HTTP service kept initialised between requests, with the parameters
+    // already applied, so a repeat POST is just HTTPDATA and HTTPACTION
+    bool httpSessionOpen;
+    String httpSessionURL;
+    bool httpSessionTuned;          // CONTENT, REDIR and TIMEOUT applied
+    String httpSessionContent;      // CONTENT value last applied
+    bool httpSessionCompressed;     // USERDATA carries Content-Encoding
+    bool bodyCompression;
+    String networkTime;
+    long baudRate;
+    void (*idleCallback)(void *context);
+    void *idleContext;
+    GSMEventCallback eventCallback;
+    void *eventContext;
+    void pause(unsigned long duration);
+    void openPort(long rate);
     void clearBuffer();
-    bool ensureGPRSConnection();
+    
+    // Job machinery
+    GSMJob *newJob(GSMJobType type, GSMJobStep firstStep, GSMJobCallback callback, void *context);
+    bool waitForJob(unsigned long id);
+    void runStep();
+    void nextStep(GSMJobStep step, unsigned long wait = 0);
+    void submitStep(const String &command, const String &expected, unsigned long timeout);
+    void stepDone(AtResult result, const String &response);
+    void gprsStepDone(GSMJob &job, bool ok, const String &response);
+    void httpStepDone(GSMJob &job, bool ok, const String &response);
+    void registerStepDone(GSMJob &job, bool ok, const String &response);
+    void afterBearer(GSMJob &job);
+    GSMJobStep stepAfterURL(GSMJob &job);
+    GSMJobStep nextParamStep(GSMJob &job);  // First HTTPPARA the session still lacks
+    void compressBody(GSMJob &job);
+    void invalidateHTTPSession();   // After HTTPTERM, bearer loss or a modem restart
+    
+    // Bearer state cache
+    bool useCachedBearer();         // True (and counted) if no probe is needed
+    void markBearerUp();
+    void invalidateBearerCache();
+    void finishJob(bool success, const String &response);
+    String buildLocationJSON(GSMJob &job);
+    static void onStepDone(void *context, AtResult result, const String &response);
+    static void onSyncDone(void *context, AtResult result, const String &response);
+    static void onSignalSampled(void *context, AtResult result, const String &response);
+    void recordSignal(int signal);
+    
+    // URCs
+    static bool onUrc(void *context, const String &line);
+    bool handleUrc(const String &line);
+    void notify(GSMEvent event, int value);
+    static int parseRegistration(const String &response);
+    static int parseSignal(const String &response);
+    static String parseIMEI(const String &response);
+    static String parseLocalIP(const String &response);
     int extractHTTPStatusCode(const String &response);
     bool performHTTPRequest(const String &method, const String &url, const String &data, String &response);
 };
@@ -0,0 +1,40 @@
+// SoftwareSerialTransport.cpp
+// Implementation of the SoftwareSerial transport
+
+#include "SoftwareSerialTransport.h"
+
+SoftwareSerialTransport::SoftwareSerialTransport(int8_t rx, int8_t tx, int rxSize, int isrSize)
+    : serial(rx, tx), rxPin(rx), txPin(tx), rxBufferSize(rxSize), isrBufferSize(isrSize) {
+}
+
+void SoftwareSerialTransport::begin(long baudrate) {
+    serial.begin(baudrate, SWSERIAL_8N1, rxPin, txPin, false, rxBufferSize, isrBufferSize);
+}
+
+void SoftwareSerialTransport::end() {
+    serial.end();
+}
+
+int SoftwareSerialTransport::rxAvailable() {
+    return serial.available();
+}
+
+int SoftwareSerialTransport::rxRead() {
+    return serial.read();
+}
+
+int SoftwareSerialTransport::rxPeek() {
+    return serial.peek();
+}
+
+size_t SoftwareSerialTransport::txWrite(const uint8_t *buffer, size_t size) {
+    return serial.write(buffer, size);
+}
+
+void SoftwareSerialTransport::txFlush() {
+    serial.flush();
+}
+
+bool SoftwareSerialTransport::rxOverflowed() {
+    return serial.overflow();
+}
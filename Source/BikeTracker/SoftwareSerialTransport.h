@@ -0,0 +1,36 @@
+// SoftwareSerialTransport.h
+// Header for the SoftwareSerial transport with configurable buffers
+
+#ifndef SOFTWARESERIALTRANSPORT_H
+#define SOFTWARESERIALTRANSPORT_H
+
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#include "SerialTransport.h"
+
+class SoftwareSerialTransport : public SerialTransport {
+public:
+    // rxBufferSize is in bytes. isrBufferSize is in captured bit edges (4
+    // bytes each) and bounds how long the port can go unserviced.
+    SoftwareSerialTransport(int8_t rxPin, int8_t txPin, int rxBufferSize, int isrBufferSize);
+    
+    void begin(long baudrate) override;
+    void end() override;
+    
+protected:
+    int rxAvailable() override;
+    int rxRead() override;
+    int rxPeek() override;
+    size_t txWrite(const uint8_t *buffer, size_t size) override;
+    void txFlush() override;
+    bool rxOverflowed() override;
+    
+private:
+    SoftwareSerial serial;
+    int8_t rxPin;
+    int8_t txPin;
+    int rxBufferSize;
+    int isrBufferSize;
+};
+
+#endif // SOFTWARESERIALTRANSPORT_H
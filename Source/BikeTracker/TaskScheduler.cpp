@@ -0,0 +1,115 @@
+// TaskScheduler.cpp
+// Implementation of the cooperative task scheduler
+
+#include "TaskScheduler.h"
+#include <string.h>
+
+TaskScheduler::TaskScheduler() {
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        tasks[i].name = "";
+        tasks[i].callback = NULL;
+        tasks[i].context = NULL;
+        tasks[i].interval = 0;
+        tasks[i].due = 0;
+        tasks[i].periodic = false;
+        tasks[i].active = false;
+    }
+    running = false;
+    resetStats();
+}
+
+bool TaskScheduler::define(uint8_t task, const char *name, TaskCallback callback, void *context,
+                           unsigned long interval, bool periodic) {
+    if (task >= SCHEDULER_MAX_TASKS || callback == NULL) {
+        return false;
+    }
+    tasks[task].name = name;
+    tasks[task].callback = callback;
+    tasks[task].context = context;
+    tasks[task].interval = interval;
+    tasks[task].periodic = periodic;
+    tasks[task].active = false;
+    return true;
+}
+
+void TaskScheduler::start(uint8_t task, unsigned long delay) {
+    if (task >= SCHEDULER_MAX_TASKS || tasks[task].callback == NULL) {
+        return;
+    }
+    tasks[task].due = millis() + delay;
+    tasks[task].active = true;
+}
+
+void TaskScheduler::stop(uint8_t task) {
+    if (task < SCHEDULER_MAX_TASKS) {
+        tasks[task].active = false;
+    }
+}
+
+bool TaskScheduler::isActive(uint8_t task) {
+    return task < SCHEDULER_MAX_TASKS && tasks[task].active;
+}
+
+void TaskScheduler::setInterval(uint8_t task, unsigned long interval) {
+    if (task < SCHEDULER_MAX_TASKS) {
+        tasks[task].interval = interval;
+    }
+}
+
+bool TaskScheduler::run() {
+    if (running) {
+        return false;
+    }
+    running = true;
+
+    unsigned long passStart = micros();
+    if (passed && passStart - lastPass > stats.maxLoopLatency) {
+        stats.maxLoopLatency = passStart - lastPass;
+    }
+    lastPass = passStart;
+    passed = true;
+    stats.passes++;
+
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        Task &task = tasks[i];
+        unsigned long now = millis();
+        if (!task.active || (long)(now - task.due) < 0) {
+            continue;
+        }
+
+        // Reschedule first so the task can stop or restart itself
+        if (task.periodic) {
+            task.due += task.interval;
+            if ((long)(now - task.due) >= 0) {
+                task.due = now + task.interval; // Fell behind, skip the missed runs
+            }
+        } else {
+            task.active = false;
+        }
+
+        unsigned long taskStart = micros();
+        task.callback(task.context, i);
+        unsigned long taskTime = micros() - taskStart;
+        stats.taskRuns++;
+        if (taskTime > stats.maxTaskTime) {
+            stats.maxTaskTime = taskTime;
+            stats.slowestTask = i;
+        }
+    }
+
+    running = false;
+    return true;
+}
+
+const SchedulerStats &TaskScheduler::getStats() {
+    return stats;
+}
+
+const char *TaskScheduler::taskName(uint8_t task) {
+    return task < SCHEDULER_MAX_TASKS ? tasks[task].name : "";
+}
+
+void TaskScheduler::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+    passed = false;
+}
@@ -0,0 +1,69 @@
+// TaskScheduler.h
+// Header for the cooperative scheduler that runs the tracker's timer tasks
+//
+// Tasks live in a fixed table; nothing is allocated. Each task has a
+// deadline and, if periodic, an interval. run() makes one pass over the
+// table and calls every task whose deadline has passed, so the main loop
+// only ever waits on the slowest task, never on a delay(). A task must do
+// a bounded slice of work and return; anything longer is split into steps
+// that reschedule themselves. A periodic task with interval 0 runs on
+// every pass.
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHEDULER_MAX_TASKS 16
+
+typedef void (*TaskCallback)(void *context, uint8_t task);
+
+struct SchedulerStats {
+    unsigned long passes;
+    unsigned long taskRuns;
+    unsigned long maxLoopLatency;   // us, longest gap between the starts of two passes
+    unsigned long maxTaskTime;      // us, longest single task run
+    uint8_t slowestTask;            // Task that took maxTaskTime
+};
+
+class TaskScheduler {
+public:
+    TaskScheduler();
+
+    // Register task `task` (0..SCHEDULER_MAX_TASKS-1). It stays stopped
+    // until start(). A periodic task is due again `interval` ms after it
+    // was due; a one-shot task stops after it runs.
+    bool define(uint8_t task, const char *name, TaskCallback callback, void *context,
+                unsigned long interval, bool periodic = true);
+    void start(uint8_t task, unsigned long delay = 0);  // First run `delay` ms from now
+    void stop(uint8_t task);
+    bool isActive(uint8_t task);
+    void setInterval(uint8_t task, unsigned long interval);
+
+    // One pass over the table. False if called from inside a task, in
+    // which case nothing runs.
+    bool run();
+
+    const SchedulerStats &getStats();
+    const char *taskName(uint8_t task);
+    void resetStats();
+
+private:
+    struct Task {
+        const char *name;
+        TaskCallback callback;
+        void *context;
+        unsigned long interval;
+        unsigned long due;
+        bool periodic;
+        bool active;
+    };
+
+    Task tasks[SCHEDULER_MAX_TASKS];
+    bool running;
+    bool passed;                    // lastPass is valid
+    unsigned long lastPass;         // micros() at the start of the last pass
+    SchedulerStats stats;
+};
+
+#endif // TASKSCHEDULER_H
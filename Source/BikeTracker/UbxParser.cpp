@@ -0,0 +1,229 @@
+// UbxParser.cpp
+// Implementation of the UBX binary protocol parser
+//
+// Frame layout: B5 62 class id len_lo len_hi payload... ck_a ck_b
+// The 8-bit Fletcher checksum covers class, id, length and payload.
+
+#include "UbxParser.h"
+#include <stdio.h>
+#include <string.h>
+
+UbxParser::UbxParser() {
+    reset();
+    memset(&stats, 0, sizeof(stats));
+}
+
+void UbxParser::reset() {
+    state = STATE_SYNC_1;
+    msgClass = 0;
+    msgId = 0;
+    length = 0;
+    received = 0;
+    checksumA = 0;
+    checksumB = 0;
+    messageType = UBX_NONE;
+    timeOfWeek = 0;
+}
+
+void UbxParser::addChecksum(uint8_t b) {
+    checksumA += b;
+    checksumB += checksumA;
+}
+
+UbxMessageType UbxParser::encode(uint8_t b) {
+    switch (state) {
+        case STATE_SYNC_1:
+            if (b == UBX_SYNC_1) {
+                state = STATE_SYNC_2;
+            }
+            break;
+
+        case STATE_SYNC_2:
+            if (b == UBX_SYNC_2) {
+                state = STATE_CLASS;
+                checksumA = 0;
+                checksumB = 0;
+            } else {
+                state = (b == UBX_SYNC_1) ? STATE_SYNC_2 : STATE_SYNC_1;
+            }
+            break;
+
+        case STATE_CLASS:
+            msgClass = b;
+            addChecksum(b);
+            state = STATE_ID;
+            break;
+
+        case STATE_ID:
+            msgId = b;
+            addChecksum(b);
+            state = STATE_LENGTH_1;
+            break;
+
+        case STATE_LENGTH_1:
+            length = b;
+            addChecksum(b);
+            state = STATE_LENGTH_2;
+            break;
+
+        case STATE_LENGTH_2:
+            length |= (uint16_t)b << 8;
+            addChecksum(b);
+            received = 0;
+            if (length > UBX_MAX_PAYLOAD) {
+                stats.overflowed++;
+                state = STATE_SYNC_1; // Not a frame we decode, resync
+            } else {
+                state = (length == 0) ? STATE_CHECKSUM_A : STATE_PAYLOAD;
+            }
+            break;
+
+        case STATE_PAYLOAD:
+            payload[received++] = b;
+            addChecksum(b);
+            if (received >= length) {
+                state = STATE_CHECKSUM_A;
+            }
+            break;
+
+        case STATE_CHECKSUM_A:
+            if (b == checksumA) {
+                state = STATE_CHECKSUM_B;
+            } else {
+                stats.badChecksum++;
+                state = STATE_SYNC_1;
+            }
+            break;
+
+        case STATE_CHECKSUM_B:
+            state = STATE_SYNC_1;
+            if (b != checksumB) {
+                stats.badChecksum++;
+                break;
+            }
+            stats.accepted++;
+            messageType = classify();
+            if (msgClass == UBX_CLASS_NAV && length >= 4) {
+                timeOfWeek = readU32(0); // Every NAV message starts with iTOW
+            }
+            return messageType;
+    }
+
+    return UBX_NONE;
+}
+
+UbxMessageType UbxParser::classify() {
+    if (msgClass == UBX_CLASS_NAV) {
+        if (msgId == UBX_NAV_POSLLH_ID && length >= 28) return UBX_NAV_POSLLH;
+        if (msgId == UBX_NAV_VELNED_ID && length >= 36) return UBX_NAV_VELNED;
+        if (msgId == UBX_NAV_TIMEUTC_ID && length >= 20) return UBX_NAV_TIMEUTC;
+    } else if (msgClass == UBX_CLASS_ACK && length >= 2) {
+        if (msgId == UBX_ACK_ACK_ID) return UBX_ACK_ACK;
+        if (msgId == UBX_ACK_NAK_ID) return UBX_ACK_NAK;
+    }
+    return UBX_OTHER;
+}
+
+bool UbxParser::decode(GPSData &data) {
+    switch (messageType) {
+        case UBX_NAV_POSLLH: decodePosLLH(data); return true;
+        case UBX_NAV_VELNED: decodeVelNED(data); return true;
+        case UBX_NAV_TIMEUTC: decodeTimeUTC(data); return true;
+        default: return false;
+    }
+}
+
+bool UbxParser::isAckFor(uint8_t ackedClass, uint8_t ackedId) {
+    return (messageType == UBX_ACK_ACK || messageType == UBX_ACK_NAK) &&
+           payload[0] == ackedClass && payload[1] == ackedId;
+}
+
+uint32_t UbxParser::lastTimeOfWeek() {
+    return timeOfWeek;
+}
+
+const UbxStats &UbxParser::getStats() {
+    return stats;
+}
+
+void UbxParser::decodePosLLH(GPSData &data) {
+    // iTOW U4, lon I4 (1e-7 deg), lat I4, height I4 (mm), hMSL I4, hAcc U4, vAcc U4
+    uint32_t accuracy = readU32(20);
+
+    // POSLLH carries no fix flag; the accuracy estimate blows up without one
+    data.isValid = (accuracy <= UBX_VALID_ACCURACY_MM);
+    if (data.isValid) {
+        // Already in the 1e-7 degree units GPSData uses
+        data.longitudeE7 = readI32(4);
+        data.latitudeE7 = readI32(8);
+        data.altitude = readI32(16) / 1000.0;
+    }
+    data.accuracy = accuracy / 1000.0;
+}
+
+void UbxParser::decodeVelNED(GPSData &data) {
+    // iTOW U4, velN/velE/velD I4 (cm/s), speed U4, gSpeed U4 (cm/s), heading I4 (1e-5 deg)
+    data.speed = readU32(20) * 0.036; // cm/s to km/h
+    data.course = readI32(24) / 100000.0;
+}
+
+void UbxParser::decodeTimeUTC(GPSData &data) {
+    // iTOW U4, tAcc U4, nano I4, year U2, month, day, hour, min, sec, valid
+    uint8_t valid = payload[19];
+    if ((valid & 0x04) == 0) {
+        return; // UTC not resolved yet
+    }
+
+    uint8_t month = payload[14];
+    uint8_t day = payload[15];
+    uint8_t hour = payload[16];
+    uint8_t minute = payload[17];
+    uint8_t second = payload[18];
+    if (month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour > 23 || minute > 59 || second > 60) {
+        return; // Corrupt frame, keep the previous timestamp
+    }
+
+    // Same "hhmmss.ss ddmmyy" layout the NMEA path produces
+    snprintf(data.timestamp, GPS_TIMESTAMP_SIZE, "%02u%02u%02u.00 %02u%02u%02u",
+             hour % 100u, minute % 100u, second % 100u,
+             day % 100u, month % 100u, (unsigned)(readU16(12) % 100));
+}
+
+size_t UbxParser::buildFrame(uint8_t msgClass, uint8_t msgId, const uint8_t *body,
+                             uint16_t bodyLength, uint8_t *frame) {
+    frame[0] = UBX_SYNC_1;
+    frame[1] = UBX_SYNC_2;
+    frame[2] = msgClass;
+    frame[3] = msgId;
+    frame[4] = bodyLength & 0xFF;
+    frame[5] = bodyLength >> 8;
+    if (bodyLength > 0) {
+        memcpy(frame + 6, body, bodyLength);
+    }
+
+    uint8_t a = 0;
+    uint8_t b = 0;
+    for (uint16_t i = 2; i < 6 + bodyLength; i++) {
+        a += frame[i];
+        b += a;
+    }
+    frame[6 + bodyLength] = a;
+    frame[7 + bodyLength] = b;
+    return bodyLength + UBX_FRAME_OVERHEAD;
+}
+
+uint32_t UbxParser::readU32(uint8_t offset) {
+    return (uint32_t)payload[offset] |
+           ((uint32_t)payload[offset + 1] << 8) |
+           ((uint32_t)payload[offset + 2] << 16) |
+           ((uint32_t)payload[offset + 3] << 24);
+}
+
+int32_t UbxParser::readI32(uint8_t offset) {
+    return (int32_t)readU32(offset);
+}
+
+uint16_t UbxParser::readU16(uint8_t offset) {
+    return (uint16_t)payload[offset] | ((uint16_t)payload[offset + 1] << 8);
+}
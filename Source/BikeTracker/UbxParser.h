@@ -0,0 +1,110 @@
+// UbxParser.h
+// Streaming parser for the u-blox UBX binary protocol
+
+#ifndef UBXPARSER_H
+#define UBXPARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "GPSData.h"
+
+#define UBX_SYNC_1 0xB5
+#define UBX_SYNC_2 0x62
+#define UBX_MAX_PAYLOAD 40          // NAV-VELNED is the largest frame we decode (36 bytes)
+#define UBX_FRAME_OVERHEAD 8        // Sync, class, id, length and checksum
+
+// Message classes and ids
+#define UBX_CLASS_NAV 0x01
+#define UBX_CLASS_ACK 0x05
+#define UBX_CLASS_CFG 0x06
+#define UBX_NAV_POSLLH_ID 0x02
+#define UBX_NAV_VELNED_ID 0x12
+#define UBX_NAV_TIMEUTC_ID 0x21
+#define UBX_ACK_NAK_ID 0x00
+#define UBX_ACK_ACK_ID 0x01
+#define UBX_CFG_PRT_ID 0x00
+#define UBX_CFG_MSG_ID 0x01
+
+// CFG-PRT protocol masks
+#define UBX_PROTO_UBX 0x01
+#define UBX_PROTO_NMEA 0x02
+
+#define UBX_VALID_ACCURACY_MM 50000 // Positions with a worse hAcc are treated as no fix
+
+enum UbxMessageType {
+    UBX_NAV_POSLLH,
+    UBX_NAV_VELNED,
+    UBX_NAV_TIMEUTC,
+    UBX_ACK_ACK,
+    UBX_ACK_NAK,
+    UBX_OTHER,
+    UBX_MESSAGE_TYPES,
+    UBX_NONE = UBX_MESSAGE_TYPES
+};
+
+struct UbxStats {
+    unsigned long accepted;
+    unsigned long badChecksum;
+    unsigned long overflowed;   // Payload larger than UBX_MAX_PAYLOAD, skipped
+};
+
+class UbxParser {
+public:
+    UbxParser();
+    void reset();
+
+    // Feed one byte from the receiver. Returns the message type once a
+    // frame with a valid checksum is complete, UBX_NONE otherwise.
+    UbxMessageType encode(uint8_t b);
+
+    // Apply the last accepted NAV frame to a fix record
+    bool decode(GPSData &data);
+
+    // For ACK-ACK / ACK-NAK: the class and id being acknowledged
+    bool isAckFor(uint8_t msgClass, uint8_t msgId);
+
+    uint32_t lastTimeOfWeek();      // iTOW of the last accepted NAV frame (ms)
+    const UbxStats &getStats();
+
+    // Build a complete frame (sync, header, payload, checksum) into frame,
+    // which must hold length + UBX_FRAME_OVERHEAD bytes. Returns the size.
+    static size_t buildFrame(uint8_t msgClass, uint8_t msgId, const uint8_t *payload,
+                             uint16_t length, uint8_t *frame);
+
+private:
+    enum ParserState {
+        STATE_SYNC_1,
+        STATE_SYNC_2,
+        STATE_CLASS,
+        STATE_ID,
+        STATE_LENGTH_1,
+        STATE_LENGTH_2,
+        STATE_PAYLOAD,
+        STATE_CHECKSUM_A,
+        STATE_CHECKSUM_B
+    };
+
+    ParserState state;
+    uint8_t msgClass;
+    uint8_t msgId;
+    uint16_t length;
+    uint16_t received;
+    uint8_t checksumA;
+    uint8_t checksumB;
+    uint8_t payload[UBX_MAX_PAYLOAD];
+    UbxMessageType messageType;
+    uint32_t timeOfWeek;
+    UbxStats stats;
+
+    void addChecksum(uint8_t b);
+    UbxMessageType classify();
+    void decodePosLLH(GPSData &data);
+    void decodeVelNED(GPSData &data);
+    void decodeTimeUTC(GPSData &data);
+
+    uint32_t readU32(uint8_t offset);
+    int32_t readI32(uint8_t offset);
+    uint16_t readU16(uint8_t offset);
+};
+
+#endif // UBXPARSER_H
@@ -0,0 +1,221 @@
+// UploadQueue.cpp
+// Implementation of the web API report queue
+
+#include "UploadQueue.h"
+#include <string.h>
+
+UploadQueue::UploadQueue(const RetryPolicy &retryPolicy) : policy(retryPolicy) {
+    for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        used[i] = false;
+        flying[i] = false;
+    }
+    flyingCount = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool UploadQueue::push(int32_t latitudeE7, int32_t longitudeE7, const String &alertType, uint8_t maxAttempts,
+                       unsigned long capturedAt, uint32_t sequence, uint16_t alertId) {
+    bool evicted = false;
+    int8_t slot = freeSlot();
+    if (slot < 0) {
+        slot = evictionCandidate();
+        if (slot < 0) {
+            return false; // Only the report in flight left, nothing to replace
+        }
+        stats.evicted++;
+        evicted = true;
+    }
+    
+    UploadMessage &message = slots[slot];
+    message.latitudeE7 = latitudeE7;
+    message.longitudeE7 = longitudeE7;
+    message.alertType = alertType;
+    message.capturedAt = capturedAt;
+    message.sequence = sequence;
+    message.alertId = alertId;
+    message.attempts = 0;
+    message.maxAttempts = maxAttempts;
+    message.queuedAt = millis();
+    message.dueAt = message.queuedAt;
+    used[slot] = true;
+    stats.queued++;
+    return !evicted;
+}
+
+int8_t UploadQueue::freeSlot() {
+    for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        if (!used[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int8_t UploadQueue::evictionCandidate() {
+    // Oldest routine report, or failing that the oldest alert
+    int8_t oldestRoutine = -1;
+    int8_t oldestAlert = -1;
+    for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        if (!used[i] || flying[i]) {
+            continue;
+        }
+        int8_t &oldest = (slots[i].alertType.length() == 0) ? oldestRoutine : oldestAlert;
+        if (oldest < 0 || isOlder(slots[i], slots[oldest])) {
+            oldest = i;
+        }
+    }
+    return oldestRoutine >= 0 ? oldestRoutine : oldestAlert;
+}
+
+bool UploadQueue::isOlder(const UploadMessage &a, const UploadMessage &b) {
+    // Logged reports may come from an earlier boot, where millis() differs
+    if (a.sequence != 0 && b.sequence != 0) {
+        return a.sequence < b.sequence;
+    }
+    return (long)(a.capturedAt - b.capturedAt) < 0;
+}
+
+uint8_t UploadQueue::begin(uint8_t maxBatch, unsigned long maxAge) {
+    if (flyingCount > 0) {
+        return 0;
+    }
+    if (maxBatch < 1) {
+        maxBatch = 1;
+    }
+    
+    // Oldest due alert and oldest due routine report, and how many are due
+    int8_t alert = -1;
+    int8_t routine = -1;
+    uint8_t routineDue = 0;
+    for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        if (!used[i] || (long)(millis() - slots[i].dueAt) < 0) {
+            continue;
+        }
+        if (slots[i].alertType.length() > 0) {
+            if (alert < 0 || isOlder(slots[i], slots[alert])) {
+                alert = i;
+            }
+        } else {
+            routineDue++;
+            if (routine < 0 || isOlder(slots[i], slots[routine])) {
+                routine = i;
+            }
+        }
+    }
+    
+    uint8_t batch = 0;
+    if (alert >= 0) {
+        batch = 1;
+    } else if (routine >= 0 &&
+               (routineDue >= maxBatch || millis() - slots[routine].queuedAt >= maxAge)) {
+        batch = routineDue < maxBatch ? routineDue : maxBatch;
+    }
+    
+    // Asked last so a half-open trial is only spent on a real send
+    if (batch == 0 || !policy.allowAttempt()) {
+        return 0;
+    }
+    
+    if (alert >= 0) {
+        flying[alert] = true;
+        order[0] = alert;
+    } else {
+        // Oldest first, one pass per report; the batch is small
+        for (uint8_t n = 0; n < batch; n++) {
+            int8_t next = -1;
+            for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+                if (!used[i] || flying[i] || slots[i].alertType.length() > 0 ||
+                    (long)(millis() - slots[i].dueAt) < 0) {
+                    continue;
+                }
+                if (next < 0 || isOlder(slots[i], slots[next])) {
+                    next = i;
+                }
+            }
+            flying[next] = true;
+            order[n] = next;
+        }
+    }
+    
+    flyingCount = batch;
+    for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        if (flying[i]) {
+            slots[i].attempts++;
+        }
+    }
+    return batch;
+}
+
+UploadMessage *UploadQueue::current(uint8_t index) {
+    // Slot order wraps, so follow the order the reports were taken in
+    return index < flyingCount ? &slots[order[index]] : NULL;
+}
+
+UploadOutcome UploadQueue::complete(bool success) {
+    if (flyingCount == 0) {
+        return UPLOAD_DROPPED;
+    }
+    
+    if (success) {
+        policy.recordSuccess();
+    } else {
+        policy.recordFailure();
+    }
+    
+    UploadOutcome outcome = success ? UPLOAD_SENT : UPLOAD_DEFERRED;
+    for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        if (!flying[i]) {
+            continue;
+        }
+        flying[i] = false;
+        UploadMessage &message = slots[i];
+        
+        if (success) {
+            used[i] = false;
+            stats.sent++;
+        } else if (message.attempts >= message.maxAttempts) {
+            used[i] = false;
+            stats.dropped++;
+            outcome = UPLOAD_DROPPED;
+        } else {
+            message.dueAt = millis() + policy.backoff(message.attempts);
+        }
+    }
+    flyingCount = 0;
+    return outcome;
+}
+
+uint8_t UploadQueue::count() {
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        if (used[i]) {
+            total++;
+        }
+    }
+    return total;
+}
+
+bool UploadQueue::isFull() {
+    return freeSlot() < 0;
+}
+
+bool UploadQueue::contains(uint32_t sequence) {
+    for (uint8_t i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        if (used[i] && slots[i].sequence == sequence) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool UploadQueue::isBusy() {
+    return flyingCount > 0;
+}
+
+RetryPolicy &UploadQueue::getPolicy() {
+    return policy;
+}
+
+const UploadQueueStats &UploadQueue::getStats() {
+    return stats;
+}
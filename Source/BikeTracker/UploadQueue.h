@@ -0,0 +1,89 @@
+// UploadQueue.h
+// Header for the queue of web API reports waiting to be sent
+//
+// Reports are queued rather than sent inline. The owner takes the next
+// due report with begin(), sends it as a GSM job and reports the result
+// with complete(). A failed report goes back into the queue with a backoff
+// from the shared RetryPolicy until its own attempt budget runs out.
+// Reports backed by the offline log carry its sequence number, so a report
+// dropped or evicted here can be loaded again from flash.
+// Routine reports can go out as a batch in one request; they then share
+// the result but each keeps its own attempt budget and backoff.
+
+#ifndef UPLOADQUEUE_H
+#define UPLOADQUEUE_H
+
+#include <Arduino.h>
+#include "RetryPolicy.h"
+
+#define UPLOAD_QUEUE_SIZE 8
+
+struct UploadMessage {
+    int32_t latitudeE7;
+    int32_t longitudeE7;
+    String alertType;               // Empty for routine location reports
+    unsigned long capturedAt;       // millis() when the position was taken
+    uint32_t sequence;              // Offline log sequence, 0 if only held here
+    uint16_t alertId;               // AlertQueue event it reports, 0 if none
+    uint8_t attempts;
+    uint8_t maxAttempts;            // Per-message budget
+    unsigned long queuedAt;         // millis() when it entered the queue
+    unsigned long dueAt;
+};
+
+enum UploadOutcome {
+    UPLOAD_SENT,
+    UPLOAD_DEFERRED,                // Failed, queued again with a backoff
+    UPLOAD_DROPPED                  // Failed and out of attempts
+};
+
+struct UploadQueueStats {
+    unsigned long queued;
+    unsigned long sent;
+    unsigned long dropped;          // Budget exhausted
+    unsigned long evicted;          // Pushed out by newer reports while full
+};
+
+class UploadQueue {
+public:
+    UploadQueue(const RetryPolicy &retryPolicy);
+    
+    // Queue a report. When full, the oldest routine report waiting is
+    // evicted (alerts only if there is no routine report to evict).
+    // Returns false if something was evicted.
+    bool push(int32_t latitudeE7, int32_t longitudeE7, const String &alertType, uint8_t maxAttempts,
+              unsigned long capturedAt, uint32_t sequence = 0, uint16_t alertId = 0);
+    
+    // Start the next send and return how many reports it carries. A due
+    // alert goes alone. Otherwise the oldest due routine reports go
+    // together, up to maxBatch, once maxBatch of them are due or the oldest
+    // has been queued for maxAge. 0 if a send is already in flight, nothing
+    // is ready or the breaker is open.
+    uint8_t begin(uint8_t maxBatch, unsigned long maxAge);
+    UploadMessage *current(uint8_t index = 0);  // Reports in flight, oldest first, NULL past the last
+    // Result of the send for every report in it. UPLOAD_DROPPED if any of
+    // them ran out of attempts.
+    UploadOutcome complete(bool success);
+    
+    uint8_t count();
+    bool isFull();
+    bool contains(uint32_t sequence);
+    bool isBusy();                  // A send is in flight
+    RetryPolicy &getPolicy();
+    const UploadQueueStats &getStats();
+    
+private:
+    RetryPolicy policy;
+    UploadMessage slots[UPLOAD_QUEUE_SIZE];
+    bool used[UPLOAD_QUEUE_SIZE];
+    bool flying[UPLOAD_QUEUE_SIZE]; // Part of the send in flight
+    uint8_t flyingCount;
+    uint8_t order[UPLOAD_QUEUE_SIZE];   // Slots in flight, in the order begin() took them
+    UploadQueueStats stats;
+    
+    int8_t freeSlot();
+    int8_t evictionCandidate();
+    bool isOlder(const UploadMessage &a, const UploadMessage &b);
+};
+
+#endif // UPLOADQUEUE_H
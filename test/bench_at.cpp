@@ -0,0 +1,135 @@
+// bench_at.cpp
+// Modem reply matching: the incremental AtMatcher and the whole AtEngine
+// against the String::indexOf rescan of the original waitForResponse()
+//
+// The rescan is quadratic in the reply length. On the host, find() is
+// vectorised, which hides much of that; the ESP8266's strstr() is not.
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string>
+#include "HostBench.h"
+#include "Baseline.h"
+#include "AtMatcher.h"
+#include "AtEngine.h"
+#include "MockTransport.h"
+
+#define ROUNDS 200
+
+struct Transcript {
+    const char *name;
+    const char *command;
+    const char *expected;
+    std::string reply;
+    bool success;
+};
+
+static std::string httpReadReply(size_t bodyLength) {
+    std::string body = "{\"status\":\"success\",\"commands\":[";
+    for (int i = 0; body.size() + 80 < bodyLength; i++) {
+        char entry[96];
+        snprintf(entry, sizeof(entry), "%s{\"id\":%d,\"type\":\"geofence\",\"lat\":14.59%05d,\"lon\":120.98%05d}",
+                 i > 0 ? "," : "", i, i * 37 % 100000, i * 53 % 100000);
+        body += entry;
+    }
+    body += "]}";
+    char header[32];
+    snprintf(header, sizeof(header), "\r\n+HTTPREAD: %u\r\n", (unsigned)body.size());
+    return std::string("AT+HTTPREAD\r") + header + body + "\r\nOK\r\n";
+}
+
+// Echo on, as the modem answers before ATE0
+static Transcript transcripts[] = {
+    { "AT", "AT", "OK", "AT\r\r\nOK\r\n", true },
+    { "AT+CSQ", "AT+CSQ", "OK", "AT+CSQ\r\r\n+CSQ: 18,0\r\n\r\nOK\r\n", true },
+    { "AT+CREG? (error)", "AT+CREG?", "+CREG:", "AT+CREG?\r\r\n+CME ERROR: 10\r\n", false },
+    { "AT+HTTPACTION=1", "AT+HTTPACTION=1", "+HTTPACTION:",
+      "AT+HTTPACTION=1\r\r\nOK\r\n\r\n+HTTPACTION: 1,200,912\r\n", true },
+    { "AT+HTTPREAD with a JSON body", "AT+HTTPREAD", "OK", httpReadReply(900), true },
+};
+
+static AtResult engineResult;
+static bool engineDone;
+
+static void onCommand(void *context, AtResult result, const String &response) {
+    (void)context;
+    (void)response;
+    engineResult = result;
+    engineDone = true;
+}
+
+int main() {
+    int count = sizeof(transcripts) / sizeof(transcripts[0]);
+    printf("bench_at: %d rounds per reply; ns and allocations per reply byte\n", ROUNDS);
+    bool correct = true;
+
+    for (int t = 0; t < count; t++) {
+        const Transcript &transcript = transcripts[t];
+        const char *reply = transcript.reply.c_str();
+        size_t length = transcript.reply.size();
+        unsigned long bytes = (unsigned long)length * ROUNDS;
+        printf(" %s (%lu bytes)\n", transcript.name, (unsigned long)length);
+
+        // Original: append, then indexOf() twice over the whole reply, per byte
+        String expected = transcript.expected;
+        String lastResponse;
+        unsigned long allocationsBefore = benchAllocations();
+        double start = benchSeconds();
+        bool scanned = false;
+        for (int round = 0; round < ROUNDS; round++) {
+            scanned = baseline::scanResponse(reply, length, expected, lastResponse);
+        }
+        benchReport("String indexOf (baseline)", "byte", bytes, benchSeconds() - start,
+                    benchAllocations() - allocationsBefore);
+        correct = correct && scanned == transcript.success;
+
+        // The two matchers AtEngine runs on every byte
+        AtMatcher expectedMatch;
+        AtMatcher errorMatch;
+        expectedMatch.setPattern(transcript.expected);
+        errorMatch.setPattern("ERROR");
+        bool matched = false;
+        allocationsBefore = benchAllocations();
+        start = benchSeconds();
+        for (int round = 0; round < ROUNDS; round++) {
+            expectedMatch.reset();
+            errorMatch.reset();
+            matched = false;
+            for (size_t i = 0; i < length; i++) {
+                bool expectedHit = expectedMatch.feed(reply[i]);
+                bool errorHit = errorMatch.feed(reply[i]);
+                if (expectedHit || errorHit) {
+                    matched = expectedHit;
+                    break;
+                }
+            }
+        }
+        benchReport("AtMatcher", "byte", bytes, benchSeconds() - start, benchAllocations() - allocationsBefore);
+        benchKeep(matched);
+        correct = correct && matched == transcript.success;
+
+        // The whole engine: queue, send, line handling, reply capture
+        MockTransport port;
+        AtEngine engine(port);
+        port.begin(9600);
+        allocationsBefore = benchAllocations();
+        start = benchSeconds();
+        for (int round = 0; round < ROUNDS; round++) {
+            engineDone = false;
+            engine.submit(transcript.command, transcript.expected, 5000, onCommand, NULL);
+            engine.update();
+            port.clearSent();
+            size_t sent = 0;
+            while (!engineDone) {
+                if (sent < length) {
+                    sent += port.inject((const uint8_t *)reply + sent, length - sent);
+                }
+                engine.update();
+            }
+        }
+        benchReport("AtEngine, whole command", "byte", bytes, benchSeconds() - start,
+                    benchAllocations() - allocationsBefore);
+        correct = correct && (engineResult == AT_RESULT_OK) == transcript.success;
+    }
+    return correct ? 0 : 1;
+}
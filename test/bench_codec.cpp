@@ -0,0 +1,104 @@
+// bench_codec.cpp
+// Upload size per fix and encode time: the original one-fix JSON, the
+// batched JSON, and the LocationCodec binary batch, with a decode check
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "HostBench.h"
+#include "Baseline.h"
+#include "APIConfig.h"
+#include "LocationCodec.h"
+#include "UploadBodies.h"
+
+#define RIDE_SECONDS 3600
+#define SAMPLE_SECONDS 10           // One report every 10 s of the ride
+#define ROUNDS 50
+
+static bool decodesBack(const LocationFix *fixes, int count, const uint8_t *buffer, size_t length) {
+    LocationDecoder decoder(buffer, length);
+    LocationHeader header;
+    if (!decoder.readHeader(header) || strcmp(header.deviceId, DEVICE_ID) != 0 || strcmp(header.imei, BODY_IMEI) != 0) {
+        return false;
+    }
+    LocationFix fix;
+    int decoded = 0;
+    while (decoder.next(fix)) {
+        if (decoded >= count || fix.latitudeE7 != fixes[decoded].latitudeE7 ||
+            fix.longitudeE7 != fixes[decoded].longitudeE7 || fix.timestamp != fixes[decoded].timestamp) {
+            return false;
+        }
+        decoded++;
+    }
+    return !decoder.failed() && decoded == count;
+}
+
+static void report(const char *name, double bytesPerFix, unsigned long fixes, double seconds,
+                   unsigned long allocations) {
+    char label[64];
+    snprintf(label, sizeof(label), "%-16s %6.1f bytes/fix", name, bytesPerFix);
+    benchReport(label, "fix", fixes, seconds, allocations);
+}
+
+int main() {
+    static LocationFix fixes[RIDE_SECONDS / SAMPLE_SECONDS];
+    int fixCount = rideFixes(fixes, RIDE_SECONDS, SAMPLE_SECONDS);
+    printf("bench_codec: %d fixes, one every %d s; bytes per fix and encode time\n", fixCount, SAMPLE_SECONDS);
+
+    const int batchSizes[] = { 1, PH_MAX_BATCH_SIZE, 20 };
+    bool correct = true;
+    uint8_t buffer[LOCATION_CODEC_HEADER_MAX + 20 * LOCATION_CODEC_FIX_MAX];
+
+    // The original: one JSON object per fix, float coordinates
+    size_t bytes = 0;
+    unsigned long allocationsBefore = benchAllocations();
+    double start = benchSeconds();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < fixCount; i++) {
+            String body = baseline::locationJSON(DEVICE_ID, fixes[i].latitudeE7 / 1e7f, fixes[i].longitudeE7 / 1e7f,
+                                                 fixes[i].timestamp, "", BODY_SIGNAL, BODY_LOCAL_IP, BODY_IMEI);
+            bytes += body.length();
+        }
+    }
+    double seconds = benchSeconds() - start;
+    printf(" one fix per POST\n");
+    report("JSON (baseline)", (double)bytes / ROUNDS / fixCount, (unsigned long)fixCount * ROUNDS, seconds,
+           benchAllocations() - allocationsBefore);
+
+    for (size_t b = 0; b < sizeof(batchSizes) / sizeof(batchSizes[0]); b++) {
+        int batch = batchSizes[b];
+        int batches = fixCount / batch;
+        int used = batches * batch;
+        printf(" batches of %d\n", batch);
+
+        bytes = 0;
+        allocationsBefore = benchAllocations();
+        start = benchSeconds();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int i = 0; i < batches; i++) {
+                bytes += batchJSON(fixes + i * batch, batch).length();
+            }
+        }
+        seconds = benchSeconds() - start;
+        report("JSON", (double)bytes / ROUNDS / used, (unsigned long)used * ROUNDS, seconds,
+           benchAllocations() - allocationsBefore);
+
+        bytes = 0;
+        allocationsBefore = benchAllocations();
+        start = benchSeconds();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int i = 0; i < batches; i++) {
+                bytes += binaryBatch(fixes + i * batch, batch, buffer, sizeof(buffer));
+            }
+        }
+        seconds = benchSeconds() - start;
+        report("LocationCodec", (double)bytes / ROUNDS / used, (unsigned long)used * ROUNDS, seconds,
+           benchAllocations() - allocationsBefore);
+
+        for (int i = 0; i < batches; i++) {
+            size_t length = binaryBatch(fixes + i * batch, batch, buffer, sizeof(buffer));
+            correct = correct && length > 0 && decodesBack(fixes + i * batch, batch, buffer, length);
+        }
+    }
+    printf("  decode check %s\n", correct ? "passed" : "FAILED");
+    return correct ? 0 : 1;
+}
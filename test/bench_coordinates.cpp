@@ -0,0 +1,176 @@
+// bench_coordinates.cpp
+// Per-fix cost and precision of the 1e-7 degree integer coordinates
+// against the float path they replaced: parse a GGA sentence, measure the
+// distance from the previous fix and format the position as text
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <vector>
+#include "HostBench.h"
+#include "Ride.h"
+#include "Baseline.h"
+#include "NmeaParser.h"
+#include "Coordinates.h"
+#include "Distance.h"
+
+#define RIDE_SECONDS 3600
+#define PASSES 20
+#define METRES_PER_DEGREE 111194.93    // On the 6371 km sphere
+
+struct Truth {
+    double latitude;            // Exactly what the sentence says
+    double longitude;
+};
+
+static double nmeaDegrees(const char *field, const char *hemisphere) {
+    const char *dot = strchr(field, '.');
+    int degreeDigits = (int)(dot - field) - 2;
+    double degrees = 0;
+    for (int i = 0; i < degreeDigits; i++) {
+        degrees = degrees * 10 + (field[i] - '0');
+    }
+    degrees += atof(field + degreeDigits) / 60.0;
+    return (*hemisphere == 'S' || *hemisphere == 'W') ? -degrees : degrees;
+}
+
+static double haversine(double lat1, double lon1, double lat2, double lon2) {
+    double dLat = (lat2 - lat1) * M_PI / 180.0;
+    double dLon = (lon2 - lon1) * M_PI / 180.0;
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(lat1 * M_PI / 180.0) * cos(lat2 * M_PI / 180.0) * sin(dLon / 2) * sin(dLon / 2);
+    return 6371000.0 * 2 * atan2(sqrt(a), sqrt(1 - a));
+}
+
+struct Errors {
+    double positionMax;
+    double positionSum;
+    double distanceMax;
+    double distanceSum;
+    int count;
+
+    void add(double latitude, double longitude, const Truth &truth, double distance, double trueDistance) {
+        double north = (latitude - truth.latitude) * METRES_PER_DEGREE;
+        double east = (longitude - truth.longitude) * METRES_PER_DEGREE * cos(truth.latitude * M_PI / 180.0);
+        double position = sqrt(north * north + east * east);
+        double distanceError = fabs(distance - trueDistance);
+        positionMax = position > positionMax ? position : positionMax;
+        distanceMax = distanceError > distanceMax ? distanceError : distanceMax;
+        positionSum += position;
+        distanceSum += distanceError;
+        count++;
+    }
+
+    void print(const char *name) {
+        printf("  %-32s position error mean %.3f m, max %.3f m; distance error mean %.4f m, max %.4f m\n",
+               name, positionSum / count, positionMax, distanceSum / count, distanceMax);
+    }
+};
+
+int main() {
+    static RideFix ride[RIDE_SECONDS];
+    makeRide(ride, RIDE_SECONDS);
+    std::string transcript = rideNmea(ride, RIDE_SECONDS);
+
+    // The GGA sentences, and the position each one states
+    std::vector<std::string> sentences;
+    std::vector<String> sentenceStrings;
+    std::vector<Truth> truth;
+    size_t position = 0;
+    while ((position = transcript.find("$GPGGA", position)) != std::string::npos) {
+        size_t end = transcript.find('\n', position) + 1;
+        std::string sentence = transcript.substr(position, end - position);
+        char latitude[16], ns, longitude[16], ew;
+        sscanf(sentence.c_str(), "$GPGGA,%*[^,],%15[^,],%c,%15[^,],%c", latitude, &ns, longitude, &ew);
+        Truth fix = { nmeaDegrees(latitude, &ns), nmeaDegrees(longitude, &ew) };
+        truth.push_back(fix);
+        sentences.push_back(sentence);
+        sentenceStrings.push_back(String(sentence.c_str()));
+        position = end;
+    }
+    int fixes = sentences.size();
+    printf("bench_coordinates: %d fixes, %d passes; parse GGA, distance from the previous fix, format\n",
+           fixes, PASSES);
+
+    // Float degrees, String parsing and formatting, float haversine
+    Errors floatErrors = {};
+    int misread = 0;
+    unsigned long allocationsBefore = benchAllocations();
+    double start = benchSeconds();
+    for (int pass = 0; pass < PASSES; pass++) {
+        float previousLat = 0, previousLon = 0;
+        for (int i = 0; i < fixes; i++) {
+            baseline::parseGGA(sentenceStrings[i]);
+            float lat = baseline::currentData.latitude;
+            float lon = baseline::currentData.longitude;
+            float distance = i > 0 ? baseline::calculateDistance(previousLat, previousLon, lat, lon) : 0;
+            String text = String(lat, 6) + "," + String(lon, 6);
+            benchKeep(distance);
+            benchKeep(text);
+            if (pass == 0) {
+                // The original convertDMSToDecimal takes any field of 7 or
+                // more characters as dddmm, so "1435.9700" reads as 143
+                // degrees. Precision is judged on correctly converted floats.
+                if (fabs(lat - truth[i].latitude) > 0.001) {
+                    misread++;
+                }
+                if (i > 0) {
+                    float trueLat = (float)truth[i].latitude;
+                    float trueLon = (float)truth[i].longitude;
+                    float floatDistance = baseline::calculateDistance((float)truth[i - 1].latitude,
+                                                                      (float)truth[i - 1].longitude, trueLat, trueLon);
+                    floatErrors.add(trueLat, trueLon, truth[i], floatDistance,
+                                    haversine(truth[i - 1].latitude, truth[i - 1].longitude,
+                                              truth[i].latitude, truth[i].longitude));
+                }
+            }
+            previousLat = lat;
+            previousLon = lon;
+        }
+    }
+    double floatSeconds = benchSeconds() - start;
+    benchReport("float + String (baseline)", "fix", (unsigned long)fixes * PASSES, floatSeconds,
+                benchAllocations() - allocationsBefore);
+
+    // 1e-7 degree integers from NmeaParser, Distance and formatCoordinate
+    Errors fixedErrors = {};
+    NmeaParser parser;
+    GPSData record;
+    memset(&record, 0, sizeof(record));
+    allocationsBefore = benchAllocations();
+    start = benchSeconds();
+    for (int pass = 0; pass < PASSES; pass++) {
+        int32_t previousLat = 0, previousLon = 0;
+        for (int i = 0; i < fixes; i++) {
+            const char *c = sentences[i].c_str();
+            while (*c != '\0') {
+                if (parser.encode(*c++) == NMEA_GGA) {
+                    parser.decode(record);
+                }
+            }
+            float distance = i > 0 ? distanceMetres(previousLat, previousLon, record.latitudeE7, record.longitudeE7) : 0;
+            char text[2 * COORDINATE_TEXT_SIZE];
+            size_t length = formatCoordinate(record.latitudeE7, text);
+            text[length++] = ',';
+            formatCoordinate(record.longitudeE7, text + length);
+            benchKeep(distance);
+            benchKeep(text);
+            if (pass == 0 && i > 0) {
+                fixedErrors.add(record.latitudeE7 / 1e7, record.longitudeE7 / 1e7, truth[i], distance,
+                                haversine(truth[i - 1].latitude, truth[i - 1].longitude,
+                                          truth[i].latitude, truth[i].longitude));
+            }
+            previousLat = record.latitudeE7;
+            previousLon = record.longitudeE7;
+        }
+    }
+    double fixedSeconds = benchSeconds() - start;
+    benchReport("int32 1e-7 degrees", "fix", (unsigned long)fixes * PASSES, fixedSeconds,
+                benchAllocations() - allocationsBefore);
+
+    floatErrors.print("float");
+    printf("  (the baseline parser misread %d of %d latitudes)\n", misread, fixes);
+    fixedErrors.print("int32 1e-7 degrees");
+    printf("  speed-up %.1fx on the host; its FPU hides most of the float cost the ESP8266 pays in software\n",
+           floatSeconds / fixedSeconds);
+    return fixedErrors.positionMax < 0.02 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+// bench_distance.cpp
+// Accuracy against time for the distance kernels: the equirectangular
+// kernel with a cached reference, float haversine, and the original
+// BikeTrackerCore haversine, at spans up to DISTANCE_FLAT_SPAN. Errors
+// are against double precision haversine on the same sphere.
+
+#include <stdio.h>
+#include <math.h>
+#include "HostBench.h"
+#include "Baseline.h"
+#include "Distance.h"
+
+#define POINTS 4096
+#define ROUNDS 200
+#define FLAT_TOLERANCE 0.05         // Metres; "within centimetres" in Distance.h
+
+static uint32_t pointState = 4242;
+
+static double pointRandom() {
+    pointState = pointState * 1664525UL + 1013904223UL;
+    return (pointState >> 8) / 16777216.0;
+}
+
+static double trueMetres(int32_t lat1, int32_t lon1, int32_t lat2, int32_t lon2) {
+    double phi1 = lat1 * 1e-7 * M_PI / 180.0;
+    double phi2 = lat2 * 1e-7 * M_PI / 180.0;
+    double dPhi = phi2 - phi1;
+    double dLambda = (lon2 - lon1) * 1e-7 * M_PI / 180.0;
+    double a = sin(dPhi / 2) * sin(dPhi / 2) + cos(phi1) * cos(phi2) * sin(dLambda / 2) * sin(dLambda / 2);
+    return 2.0 * DISTANCE_EARTH_RADIUS * asin(sqrt(a));
+}
+
+struct Kernel {
+    const char *name;
+    double errorMax;
+    double errorSum;
+    double seconds;
+};
+
+int main() {
+    static int32_t latitudes[POINTS];
+    static int32_t longitudes[POINTS];
+    static double truth[POINTS];
+    bool correct = true;
+
+    const double referenceLatitudes[] = { 14.6, 45.0, 60.0 };
+    // Spans in 1e-7 degrees of the larger axis, up to the flat limit
+    const long spans[] = { 100, 1000, 10000, 100000, DISTANCE_FLAT_SPAN / 2, DISTANCE_FLAT_SPAN };
+
+    printf("bench_distance: %d points per span, %d rounds; error vs double haversine, time per call\n",
+           POINTS, ROUNDS);
+    for (size_t r = 0; r < sizeof(referenceLatitudes) / sizeof(referenceLatitudes[0]); r++) {
+        int32_t originLat = (int32_t)lround(referenceLatitudes[r] * 1e7);
+        int32_t originLon = 1209842000;
+        DistanceReference reference;
+        setDistanceReference(reference, originLat, originLon);
+        printf(" reference at %.1f degrees\n", referenceLatitudes[r]);
+
+        for (size_t s = 0; s < sizeof(spans) / sizeof(spans[0]); s++) {
+            pointState = 4242;
+            for (int i = 0; i < POINTS; i++) {
+                double bearing = pointRandom() * 2 * M_PI;
+                double reach = spans[s] * (0.5 + 0.5 * pointRandom());
+                latitudes[i] = originLat + (int32_t)lround(reach * cos(bearing));
+                longitudes[i] = originLon + (int32_t)lround(reach * sin(bearing));
+                truth[i] = trueMetres(originLat, originLon, latitudes[i], longitudes[i]);
+            }
+
+            Kernel kernels[3] = {
+                { "equirectangular", 0, 0, 0 },
+                { "float haversine", 0, 0, 0 },
+                { "original haversine", 0, 0, 0 },
+            };
+            for (int k = 0; k < 3; k++) {
+                float result = 0;
+                double start = benchSeconds();
+                for (int round = 0; round < ROUNDS; round++) {
+                    for (int i = 0; i < POINTS; i++) {
+                        if (k == 0) {
+                            result = equirectangularMetres(reference, latitudes[i], longitudes[i]);
+                        } else if (k == 1) {
+                            result = haversineMetres(originLat, originLon, latitudes[i], longitudes[i]);
+                        } else {
+                            result = baseline::calculateDistance(originLat / 1e7f, originLon / 1e7f,
+                                                                 latitudes[i] / 1e7f, longitudes[i] / 1e7f);
+                        }
+                        benchKeep(result);
+                        if (round == 0) {
+                            double error = fabs(result - truth[i]);
+                            kernels[k].errorMax = error > kernels[k].errorMax ? error : kernels[k].errorMax;
+                            kernels[k].errorSum += error;
+                        }
+                    }
+                }
+                kernels[k].seconds = benchSeconds() - start;
+            }
+
+            printf("  span %7ld (%7.0f m)", spans[s], spans[s] * 1e-7 * M_PI / 180.0 * DISTANCE_EARTH_RADIUS);
+            for (int k = 0; k < 3; k++) {
+                printf(" | %s %6.1f/%6.1f mm %5.1f ns", kernels[k].name, kernels[k].errorSum * 1000 / POINTS,
+                       kernels[k].errorMax * 1000, kernels[k].seconds * 1e9 / ((double)POINTS * ROUNDS));
+            }
+            printf("\n");
+            correct = correct && kernels[0].errorMax <= FLAT_TOLERANCE;
+        }
+    }
+    printf("  errors are mean/max; the original's come mostly from float degrees (about 1 m at 120E)\n");
+    printf("  equirectangular within %.2f m up to DISTANCE_FLAT_SPAN: %s\n", FLAT_TOLERANCE, correct ? "yes" : "NO");
+    return correct ? 0 : 1;
+}
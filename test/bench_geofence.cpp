@@ -0,0 +1,158 @@
+// bench_geofence.cpp
+// GeofenceEngine cost per fix at 1, 10 and 100 zones, against testing
+// every zone, with a check that the index never misses a crossing.
+// Built with GEOFENCE_MAX_ZONES=128 (see the Makefile).
+
+#include <stdio.h>
+#include <math.h>
+#include "HostBench.h"
+#include "Ride.h"
+#include "Baseline.h"
+#include "GeofenceEngine.h"
+
+#define RIDE_SECONDS 3600
+#define ROUNDS 20
+
+struct ZoneSpec {
+    bool circle;
+    int32_t latitudeE7[8];      // Centre, or polygon vertices
+    int32_t longitudeE7[8];
+    uint8_t vertices;
+    float radius;               // Metres, circle or polygon size
+};
+
+static uint32_t zoneState = 777;
+
+static double zoneRandom() {
+    zoneState = zoneState * 1664525UL + 1013904223UL;
+    return (zoneState >> 8) / 16777216.0;
+}
+
+// Zones near points of the ride, so it crosses some of them; every
+// fourth is a polygon
+static void makeZones(const RideFix *ride, ZoneSpec *specs, int count) {
+    zoneState = 777;
+    for (int i = 0; i < count; i++) {
+        ZoneSpec &spec = specs[i];
+        const RideFix &at = ride[(int)(zoneRandom() * RIDE_SECONDS)];
+        double latitude = at.latitude + (zoneRandom() - 0.5) * 0.006;
+        double longitude = at.longitude + (zoneRandom() - 0.5) * 0.006;
+        double metresPerDegreeLon = 111195.0 * cos(latitude * M_PI / 180.0);
+        spec.circle = (i % 4) != 3;
+        spec.radius = 80.0f + (float)(zoneRandom() * 320.0);
+        if (spec.circle) {
+            spec.vertices = 1;
+            spec.latitudeE7[0] = (int32_t)lround(latitude * 1e7);
+            spec.longitudeE7[0] = (int32_t)lround(longitude * 1e7);
+            continue;
+        }
+        spec.vertices = 5 + (int)(zoneRandom() * 4);
+        for (int v = 0; v < spec.vertices; v++) {
+            double angle = 2 * M_PI * v / spec.vertices;
+            double reach = spec.radius * (0.7 + 0.3 * zoneRandom());
+            spec.latitudeE7[v] = (int32_t)lround((latitude + reach * cos(angle) / 111195.0) * 1e7);
+            spec.longitudeE7[v] = (int32_t)lround((longitude + reach * sin(angle) / metresPerDegreeLon) * 1e7);
+        }
+    }
+}
+
+static void addZones(GeofenceEngine &engine, const ZoneSpec *specs, int count) {
+    engine.clear();
+    for (int i = 0; i < count; i++) {
+        char name[GEOFENCE_NAME_SIZE];
+        snprintf(name, sizeof(name), "zone%d", i % 100);
+        unsigned long dwell = (i % 2) ? 60000 : 0;
+        if (specs[i].circle) {
+            engine.addCircle(name, specs[i].latitudeE7[0], specs[i].longitudeE7[0], specs[i].radius, dwell);
+        } else {
+            engine.addPolygon(name, specs[i].latitudeE7, specs[i].longitudeE7, specs[i].vertices, dwell);
+        }
+    }
+}
+
+int main() {
+    static RideFix ride[RIDE_SECONDS];
+    makeRide(ride, RIDE_SECONDS);
+    static int32_t latitudes[RIDE_SECONDS];
+    static int32_t longitudes[RIDE_SECONDS];
+    for (int i = 0; i < RIDE_SECONDS; i++) {
+        latitudes[i] = (int32_t)lround(ride[i].latitude * 1e7);
+        longitudes[i] = (int32_t)lround(ride[i].longitude * 1e7);
+    }
+    static ZoneSpec specs[100];
+    makeZones(ride, specs, 100);
+    static GeofenceEngine engine;
+    bool correct = true;
+
+    printf("bench_geofence: %d fixes, %d passes; a quarter of the zones are polygons\n", RIDE_SECONDS, ROUNDS);
+    const int zoneCounts[] = { 1, 10, 100 };
+    for (size_t z = 0; z < sizeof(zoneCounts) / sizeof(zoneCounts[0]); z++) {
+        int zones = zoneCounts[z];
+        addZones(engine, specs, zones);
+        correct = correct && engine.count() == zones;
+        printf(" %d zones\n", zones);
+
+        // The original check, float haversine per zone (polygons by their size)
+        unsigned long allocationsBefore = benchAllocations();
+        double start = benchSeconds();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int i = 0; i < RIDE_SECONDS; i++) {
+                int inside = 0;
+                for (int k = 0; k < zones; k++) {
+                    float distance = baseline::calculateDistance(specs[k].latitudeE7[0] / 1e7f,
+                                                                 specs[k].longitudeE7[0] / 1e7f,
+                                                                 latitudes[i] / 1e7f, longitudes[i] / 1e7f);
+                    inside += distance <= specs[k].radius;
+                }
+                benchKeep(inside);
+            }
+        }
+        benchReport("float haversine, every zone", "fix", (unsigned long)RIDE_SECONDS * ROUNDS,
+                    benchSeconds() - start, benchAllocations() - allocationsBefore);
+
+        // Every zone through the engine's own test, no index
+        allocationsBefore = benchAllocations();
+        start = benchSeconds();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int i = 0; i < RIDE_SECONDS; i++) {
+                int inside = 0;
+                for (int k = 0; k < zones; k++) {
+                    inside += engine.contains(k, latitudes[i], longitudes[i]);
+                }
+                benchKeep(inside);
+            }
+        }
+        benchReport("GeofenceEngine, every zone", "fix", (unsigned long)RIDE_SECONDS * ROUNDS,
+                    benchSeconds() - start, benchAllocations() - allocationsBefore);
+
+        // update(): grid index, state and events
+        unsigned long now = 0;
+        GeofenceStats before = engine.getStats();   // Kept across clear()
+        allocationsBefore = benchAllocations();
+        start = benchSeconds();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (int i = 0; i < RIDE_SECONDS; i++) {
+                engine.update(latitudes[i], longitudes[i], now += 1000);
+            }
+        }
+        double seconds = benchSeconds() - start;
+        const GeofenceStats &stats = engine.getStats();
+        unsigned long updates = stats.updates - before.updates;
+        benchReport("GeofenceEngine::update", "fix", updates, seconds, benchAllocations() - allocationsBefore);
+        printf("  %.2f zones tested per fix, %lu events per pass\n",
+               (double)(stats.zoneTests - before.zoneTests) / updates, (stats.events - before.events) / ROUNDS);
+
+        // The index must agree with testing every zone
+        addZones(engine, specs, zones);
+        for (int i = 0; i < RIDE_SECONDS; i++) {
+            engine.update(latitudes[i], longitudes[i], i * 1000UL);
+            for (int k = 0; k < zones; k++) {
+                if (engine.isInside(k) != engine.contains(k, latitudes[i], longitudes[i])) {
+                    correct = false;
+                }
+            }
+        }
+    }
+    printf("  index check %s\n", correct ? "passed" : "FAILED");
+    return correct ? 0 : 1;
+}
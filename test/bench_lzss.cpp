@@ -0,0 +1,123 @@
+// bench_lzss.cpp
+// LZSS on the upload bodies of the synthetic ride: compression ratio,
+// encode and decode time per byte, and the RAM each side needs
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "HostBench.h"
+#include "APIConfig.h"
+#include "UploadBodies.h"
+#include "Lzss.h"
+
+#define RIDE_SECONDS 3600
+#define SAMPLE_SECONDS 10
+#define ROUNDS 20
+
+static void appendByte(void *context, uint8_t value) {
+    ((std::string *)context)->push_back((char)value);
+}
+
+static std::string compress(const std::string &body) {
+    std::string packed;
+    packed.reserve(body.size());
+    LzssEncoder encoder(appendByte, &packed);
+    for (size_t i = 0; i < body.size(); i++) {
+        encoder.write((uint8_t)body[i]);
+    }
+    encoder.finish();
+    return packed;
+}
+
+static bool expand(const std::string &packed, std::string &body) {
+    body.clear();
+    LzssDecoder decoder(appendByte, &body);
+    for (size_t i = 0; i < packed.size(); i++) {
+        if (!decoder.write((uint8_t)packed[i])) {
+            return false;
+        }
+    }
+    return decoder.finish();
+}
+
+// Every body of one kind over the whole ride
+static bool run(const char *name, const std::vector<std::string> &bodies) {
+    size_t original = 0;
+    size_t packedTotal = 0;
+    size_t smaller = 0;
+    std::vector<std::string> packed;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        packed.push_back(compress(bodies[i]));
+        original += bodies[i].size();
+        packedTotal += packed[i].size();
+        if (packed[i].size() < bodies[i].size()) {
+            smaller++;
+        }
+    }
+
+    double start = benchSeconds();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < bodies.size(); i++) {
+            benchKeep(compress(bodies[i]));
+        }
+    }
+    double encodeSeconds = benchSeconds() - start;
+
+    bool correct = true;
+    std::string body;
+    start = benchSeconds();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (size_t i = 0; i < packed.size(); i++) {
+            correct = expand(packed[i], body) && body == bodies[i] && correct;
+        }
+    }
+    double decodeSeconds = benchSeconds() - start;
+
+    double bytes = (double)original * ROUNDS;
+    printf("  %-29s %4lu bodies %7.1f -> %7.1f bytes, ratio %.2f, %3lu%% of bodies smaller; "
+           "encode %5.1f ns/byte, decode %5.1f ns/byte%s\n",
+           name, (unsigned long)bodies.size(), (double)original / bodies.size(),
+           (double)packedTotal / bodies.size(), (double)packedTotal / original,
+           (unsigned long)(smaller * 100 / bodies.size()), encodeSeconds * 1e9 / bytes,
+           decodeSeconds * 1e9 / bytes, correct ? "" : ", ROUND TRIP FAILED");
+    return correct;
+}
+
+int main() {
+    static LocationFix fixes[RIDE_SECONDS / SAMPLE_SECONDS];
+    int fixCount = rideFixes(fixes, RIDE_SECONDS, SAMPLE_SECONDS);
+    printf("bench_lzss: %d fixes, one every %d s; window %d, RAM encoder %lu bytes, decoder %lu bytes\n",
+           fixCount, SAMPLE_SECONDS, LZSS_WINDOW_SIZE, (unsigned long)sizeof(LzssEncoder),
+           (unsigned long)sizeof(LzssDecoder));
+
+    bool correct = true;
+    std::vector<std::string> bodies;
+    for (int i = 0; i < fixCount; i++) {
+        bodies.push_back(locationJSON(fixes[i], "").c_str());
+    }
+    correct = run("JSON, one fix", bodies) && correct;
+
+    const int batchSizes[] = { PH_MAX_BATCH_SIZE, 20 };
+    for (size_t b = 0; b < sizeof(batchSizes) / sizeof(batchSizes[0]); b++) {
+        int batch = batchSizes[b];
+        char name[32];
+        bodies.clear();
+        for (int i = 0; i + batch <= fixCount; i += batch) {
+            bodies.push_back(batchJSON(fixes + i, batch).c_str());
+        }
+        snprintf(name, sizeof(name), "JSON, batches of %d", batch);
+        correct = run(name, bodies) && correct;
+
+        bodies.clear();
+        for (int i = 0; i + batch <= fixCount; i += batch) {
+            uint8_t buffer[LOCATION_CODEC_HEADER_MAX + 20 * LOCATION_CODEC_FIX_MAX];
+            size_t length = binaryBatch(fixes + i, batch, buffer, sizeof(buffer));
+            bodies.push_back(std::string((const char *)buffer, length));
+        }
+        snprintf(name, sizeof(name), "LocationCodec, batches of %d", batch);
+        correct = run(name, bodies) && correct;
+    }
+    printf("  Sim800L sends the original body whenever LZSS does not make it smaller\n");
+    return correct ? 0 : 1;
+}
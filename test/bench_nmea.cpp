@@ -0,0 +1,73 @@
+// bench_nmea.cpp
+// NMEA ingestion: sentences per second and heap allocations per sentence,
+// the streaming NmeaParser against the String parser it replaced
+
+#include <Arduino.h>
+#include <stdio.h>
+#include "HostBench.h"
+#include "Ride.h"
+#include "NmeaParser.h"
+#include "GPSEpoch.h"
+#include "Baseline.h"
+
+#define RIDE_SECONDS 3600
+#define PASSES 5
+
+int main() {
+    static RideFix ride[RIDE_SECONDS];
+    makeRide(ride, RIDE_SECONDS);
+    std::string transcript = rideNmea(ride, RIDE_SECONDS);
+    const char *text = transcript.c_str();
+    size_t length = transcript.size();
+
+    printf("bench_nmea: %d s ride, %lu bytes of NMEA, %d passes\n",
+           RIDE_SECONDS, (unsigned long)length, PASSES);
+
+    // Baseline
+    unsigned long sentences = 0;
+    unsigned long allocationsBefore = benchAllocations();
+    double start = benchSeconds();
+    for (int pass = 0; pass < PASSES; pass++) {
+        for (size_t i = 0; i < length; i++) {
+            if (baseline::feed(text[i])) {
+                sentences++;
+            }
+        }
+    }
+    double legacySeconds = benchSeconds() - start;
+    unsigned long legacyAllocations = benchAllocations() - allocationsBefore;
+    benchReport("String parser (baseline)", "sentence", sentences, legacySeconds, legacyAllocations);
+    benchKeep(baseline::currentData);
+
+    // NmeaParser and epoch assembly, as Neo6mGPS::processByte() runs them
+    NmeaParser parser;
+    GPSEpochAssembler epoch;
+    epoch.begin((1 << NMEA_GGA) | (1 << NMEA_RMC));
+    unsigned long accepted = 0;
+    allocationsBefore = benchAllocations();
+    start = benchSeconds();
+    for (int pass = 0; pass < PASSES; pass++) {
+        for (size_t i = 0; i < length; i++) {
+            NmeaSentenceType type = parser.encode(text[i]);
+            if (type == NMEA_NONE) {
+                continue;
+            }
+            accepted++;
+            if (type != NMEA_OTHER) {
+                uint32_t utcTime = 0;
+                bool hasTime = parser.epochTime(utcTime);
+                GPSData &record = epoch.beginPart(utcTime, hasTime);
+                parser.decode(record);
+                epoch.completePart(type);
+            }
+        }
+    }
+    double parserSeconds = benchSeconds() - start;
+    unsigned long parserAllocations = benchAllocations() - allocationsBefore;
+    benchReport("NmeaParser + GPSEpoch", "sentence", accepted, parserSeconds, parserAllocations);
+    benchKeep(epoch.getFix());
+
+    printf("  speed-up %.1fx, %lu fixes published\n",
+           (legacySeconds / sentences) / (parserSeconds / accepted), epoch.getStats().published);
+    return accepted == sentences && parserAllocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,278 @@
+// Arduino.cpp
+// Host stand-in for the Arduino core, see Arduino.h
+
+#include "Arduino.h"
+#include <ctype.h>
+#include <stdio.h>
+
+HardwareSerial Serial;
+
+static unsigned long long clockMicros = 0;
+
+unsigned long millis() {
+    return (unsigned long)(clockMicros / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)clockMicros;
+}
+
+void delay(unsigned long ms) {
+    clockMicros += (unsigned long long)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    clockMicros += us;
+}
+
+void yield() {
+}
+
+void hostSetMillis(unsigned long ms) {
+    clockMicros = (unsigned long long)ms * 1000;
+}
+
+void hostAdvanceMillis(unsigned long ms) {
+    delay(ms);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    (void)pin;
+    (void)value;
+}
+
+int digitalRead(uint8_t pin) {
+    (void)pin;
+    return LOW;
+}
+
+static unsigned long randomState = 1;
+
+long random(long max) {
+    if (max <= 0) {
+        return 0;
+    }
+    // Fixed LCG so runs repeat exactly
+    randomState = randomState * 1103515245UL + 12345UL;
+    return (long)((randomState >> 8) % (unsigned long)max);
+}
+
+long random(long min, long max) {
+    return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+    randomState = seed;
+}
+
+// =============================================================================
+// String
+// =============================================================================
+
+static std::string formatInteger(unsigned long value, unsigned char base, bool negative) {
+    char digits[72];
+    int position = sizeof(digits) - 1;
+    digits[position] = '\0';
+    if (base < 2) {
+        base = 10;
+    }
+    do {
+        int digit = value % base;
+        digits[--position] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value > 0);
+    if (negative) {
+        digits[--position] = '-';
+    }
+    return std::string(digits + position);
+}
+
+static std::string formatSigned(long value, unsigned char base) {
+    if (base == 10 && value < 0) {
+        return formatInteger(0UL - (unsigned long)value, base, true);
+    }
+    return formatInteger((unsigned long)value, base, false);
+}
+
+String::String(const char *value) : text(value != NULL ? value : "") {
+}
+
+String::String(const std::string &value) : text(value) {
+}
+
+String::String(char c) : text(1, c) {
+}
+
+String::String(unsigned char value, unsigned char base) : text(formatInteger(value, base, false)) {
+}
+
+String::String(int value, unsigned char base) : text(formatSigned(value, base)) {
+}
+
+String::String(unsigned int value, unsigned char base) : text(formatInteger(value, base, false)) {
+}
+
+String::String(long value, unsigned char base) : text(formatSigned(value, base)) {
+}
+
+String::String(unsigned long value, unsigned char base) : text(formatInteger(value, base, false)) {
+}
+
+String::String(float value, unsigned char decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, (double)value);
+    text = buffer;
+}
+
+String::String(double value, unsigned char decimals) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    text = buffer;
+}
+
+bool String::equalsIgnoreCase(const String &other) const {
+    if (text.size() != other.text.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < text.size(); i++) {
+        if (tolower((unsigned char)text[i]) != tolower((unsigned char)other.text[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool String::startsWith(const String &prefix, unsigned int offset) const {
+    return offset <= text.size() && text.compare(offset, prefix.text.size(), prefix.text) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+    return text.size() >= suffix.text.size() &&
+           text.compare(text.size() - suffix.text.size(), suffix.text.size(), suffix.text) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t position = text.find(c, from);
+    return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::indexOf(const String &other, unsigned int from) const {
+    if (from > text.size()) {
+        return -1;
+    }
+    size_t position = text.find(other.text, from);
+    return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t position = text.rfind(c);
+    return position == std::string::npos ? -1 : (int)position;
+}
+
+int String::lastIndexOf(const String &other) const {
+    size_t position = text.rfind(other.text);
+    return position == std::string::npos ? -1 : (int)position;
+}
+
+String String::substring(unsigned int from) const {
+    return substring(from, text.size());
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    // Like the core: arguments may come in either order and are clamped
+    if (from > to) {
+        unsigned int swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from >= text.size()) {
+        return String();
+    }
+    if (to > text.size()) {
+        to = text.size();
+    }
+    return String(text.substr(from, to - from));
+}
+
+void String::replace(const String &find, const String &replacement) {
+    if (find.text.empty()) {
+        return;
+    }
+    size_t position = 0;
+    while ((position = text.find(find.text, position)) != std::string::npos) {
+        text.replace(position, find.text.size(), replacement.text);
+        position += replacement.text.size();
+    }
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < text.size()) {
+        text.erase(index, count);
+    }
+}
+
+void String::trim() {
+    size_t start = 0;
+    while (start < text.size() && isspace((unsigned char)text[start])) {
+        start++;
+    }
+    size_t end = text.size();
+    while (end > start && isspace((unsigned char)text[end - 1])) {
+        end--;
+    }
+    text = text.substr(start, end - start);
+}
+
+void String::toUpperCase() {
+    for (size_t i = 0; i < text.size(); i++) {
+        text[i] = toupper((unsigned char)text[i]);
+    }
+}
+
+void String::toLowerCase() {
+    for (size_t i = 0; i < text.size(); i++) {
+        text[i] = tolower((unsigned char)text[i]);
+    }
+}
+
+String operator+(const String &a, const String &b) {
+    String sum = a;
+    sum += b;
+    return sum;
+}
+
+// =============================================================================
+// Print / Stream
+// =============================================================================
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (written < size && write(buffer[written])) {
+        written++;
+    }
+    return written;
+}
+
+String Stream::readStringUntil(char terminator) {
+    // Nothing arrives while a host test waits, so only what is buffered
+    String result;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) {
+        result += (char)c;
+    }
+    return result;
+}
+
+String Stream::readString() {
+    String result;
+    int c;
+    while ((c = read()) >= 0) {
+        result += (char)c;
+    }
+    return result;
+}
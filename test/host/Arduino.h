@@ -0,0 +1,156 @@
+// Arduino.h
+// Host stand-in for the parts of the ESP8266 Arduino core the portable
+// tracker modules use, so they build and run on Linux for tests and
+// benchmarks
+//
+// Time is virtual: millis() and micros() only move when a test advances
+// the clock or code under test calls delay(), so timeouts and backoffs
+// run instantly and deterministically. Serial discards its output.
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#define PI 3.1415926535897932384626433832795
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+#define DEC 10
+#define HEX 16
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Virtual clock
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+void hostSetMillis(unsigned long ms);       // Test side
+void hostAdvanceMillis(unsigned long ms);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+class String {
+public:
+    String(const char *text = "");
+    String(const std::string &text);
+    String(char c);
+    String(unsigned char value, unsigned char base = 10);
+    String(int value, unsigned char base = 10);
+    String(unsigned int value, unsigned char base = 10);
+    String(long value, unsigned char base = 10);
+    String(unsigned long value, unsigned char base = 10);
+    String(float value, unsigned char decimals = 2);
+    String(double value, unsigned char decimals = 2);
+
+    unsigned int length() const { return text.size(); }
+    bool isEmpty() const { return text.empty(); }
+    const char *c_str() const { return text.c_str(); }
+    bool reserve(unsigned int size) { text.reserve(size); return true; }
+
+    bool concat(const String &other) { text += other.text; return true; }
+    bool concat(const char *other) { text += other; return true; }
+    bool concat(char c) { text += c; return true; }
+    String &operator+=(const String &other) { text += other.text; return *this; }
+    String &operator+=(const char *other) { text += other; return *this; }
+    String &operator+=(char c) { text += c; return *this; }
+
+    char charAt(unsigned int index) const { return index < text.size() ? text[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    void setCharAt(unsigned int index, char c) { if (index < text.size()) text[index] = c; }
+
+    bool equals(const String &other) const { return text == other.text; }
+    bool equalsIgnoreCase(const String &other) const;
+    bool operator==(const String &other) const { return text == other.text; }
+    bool operator!=(const String &other) const { return text != other.text; }
+    bool operator==(const char *other) const { return text == other; }
+    bool operator!=(const char *other) const { return text != other; }
+    bool startsWith(const String &prefix, unsigned int offset = 0) const;
+    bool endsWith(const String &suffix) const;
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String &other, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    int lastIndexOf(const String &other) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(const String &find, const String &replacement);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    long toInt() const { return atol(text.c_str()); }
+    float toFloat() const { return (float)atof(text.c_str()); }
+
+private:
+    std::string text;
+};
+
+String operator+(const String &a, const String &b);
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    virtual void flush() {}
+
+    size_t print(const String &text) { return write((const uint8_t *)text.c_str(), text.length()); }
+    size_t print(const char *text) { return write(text); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value, int base = DEC) { return print(String((long)value, base)); }
+    size_t print(unsigned int value, int base = DEC) { return print(String((unsigned long)value, base)); }
+    size_t print(long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(unsigned long value, int base = DEC) { return print(String(value, base)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) { streamTimeout = timeout; }
+    String readStringUntil(char terminator);
+    String readString();
+
+protected:
+    unsigned long streamTimeout = 1000;
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baudrate) { (void)baudrate; }
+    void end() {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    size_t write(uint8_t b) override { (void)b; return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { (void)buffer; return size; }
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_ARDUINO_H
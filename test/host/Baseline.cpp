@@ -0,0 +1,156 @@
+// Baseline.cpp
+// The original String and float code, see Baseline.h
+
+#include "Baseline.h"
+
+namespace baseline {
+
+GPSData currentData;
+static String rawData;
+
+float convertDMSToDecimal(String dms, String direction) {
+    if (dms.length() < 4) return 0.0;
+    float degrees, minutes;
+    if (dms.length() >= 7) {
+        degrees = dms.substring(0, 3).toFloat();
+        minutes = dms.substring(3).toFloat();
+    } else {
+        degrees = dms.substring(0, 2).toFloat();
+        minutes = dms.substring(2).toFloat();
+    }
+    float decimal = degrees + (minutes / 60.0);
+    if (direction == "S" || direction == "W") {
+        decimal = -decimal;
+    }
+    return decimal;
+}
+
+bool parseGGA(String sentence) {
+    int commaIndex[14];
+    int commaCount = 0;
+    for (unsigned int i = 0; i < sentence.length() && commaCount < 14; i++) {
+        if (sentence.charAt(i) == ',') {
+            commaIndex[commaCount++] = i;
+        }
+    }
+    if (commaCount >= 6) {
+        String quality = sentence.substring(commaIndex[5] + 1, commaIndex[6]);
+        if (quality.toInt() > 0) {
+            currentData.isValid = true;
+            String latStr = sentence.substring(commaIndex[1] + 1, commaIndex[2]);
+            String latDir = sentence.substring(commaIndex[2] + 1, commaIndex[3]);
+            if (latStr.length() > 0) {
+                currentData.latitude = convertDMSToDecimal(latStr, latDir);
+            }
+            String lonStr = sentence.substring(commaIndex[3] + 1, commaIndex[4]);
+            String lonDir = sentence.substring(commaIndex[4] + 1, commaIndex[5]);
+            if (lonStr.length() > 0) {
+                currentData.longitude = convertDMSToDecimal(lonStr, lonDir);
+            }
+            if (commaCount >= 7) {
+                currentData.satellites = sentence.substring(commaIndex[6] + 1, commaIndex[7]).toInt();
+            }
+            if (commaCount >= 8) {
+                currentData.hdop = sentence.substring(commaIndex[7] + 1, commaIndex[8]).toFloat();
+            }
+            if (commaCount >= 9) {
+                currentData.altitude = sentence.substring(commaIndex[8] + 1, commaIndex[9]).toFloat();
+            }
+        } else {
+            currentData.isValid = false;
+        }
+    }
+    return currentData.isValid;
+}
+
+bool parseRMC(String sentence) {
+    int commaIndex[12];
+    int commaCount = 0;
+    for (unsigned int i = 0; i < sentence.length() && commaCount < 12; i++) {
+        if (sentence.charAt(i) == ',') {
+            commaIndex[commaCount++] = i;
+        }
+    }
+    if (commaCount >= 7) {
+        String status = sentence.substring(commaIndex[1] + 1, commaIndex[2]);
+        if (status == "A") {
+            String speedStr = sentence.substring(commaIndex[6] + 1, commaIndex[7]);
+            if (speedStr.length() > 0) {
+                currentData.speed = speedStr.toFloat() * 1.852;
+            }
+            String timeStr = sentence.substring(commaIndex[0] + 1, commaIndex[1]);
+            String dateStr = sentence.substring(commaIndex[8] + 1, commaIndex[9]);
+            currentData.timestamp = timeStr + " " + dateStr;
+        }
+    }
+    return true;
+}
+
+bool feed(char c) {
+    if (c == '$') {
+        rawData = "";
+    }
+    rawData += c;
+    if (c != '\n') {
+        return false;
+    }
+    String sentence = rawData;
+    rawData = "";
+    if (sentence.startsWith("$GPGGA") || sentence.startsWith("$GNGGA")) {
+        parseGGA(sentence);
+    } else if (sentence.startsWith("$GPRMC") || sentence.startsWith("$GNRMC")) {
+        parseRMC(sentence);
+    }
+    return true;
+}
+
+
+bool scanResponse(const char *reply, size_t length, const String &expected, String &lastResponse) {
+    String response = "";
+    for (size_t i = 0; i < length; i++) {
+        char c = reply[i];
+        response += c;
+        if (response.indexOf(expected) >= 0) {
+            lastResponse = response;
+            return true;
+        }
+        if (response.indexOf("ERROR") >= 0) {
+            lastResponse = response;
+            return false;
+        }
+    }
+    lastResponse = response;
+    return false;
+}
+
+String locationJSON(const String &deviceId, float latitude, float longitude, unsigned long timestamp,
+                    const String &alertType, int signalStrength, const String &localIP, const String &imei) {
+    String jsonData = "{";
+    jsonData += "\"deviceId\":\"" + deviceId + "\",";
+    jsonData += "\"latitude\":" + String(latitude, 6) + ",";
+    jsonData += "\"longitude\":" + String(longitude, 6) + ",";
+    jsonData += "\"timestamp\":\"" + String(timestamp) + "\",";
+    if (alertType.length() > 0) {
+        jsonData += "\"alertType\":\"" + alertType + "\",";
+    } else {
+        jsonData += "\"alertType\":\"\",";
+    }
+    jsonData += "\"signalStrength\":" + String(signalStrength) + ",";
+    jsonData += "\"localIP\":\"" + localIP + "\",";
+    jsonData += "\"imei\":\"" + imei + "\"";
+    jsonData += "}";
+    return jsonData;
+}
+
+float calculateDistance(float lat1, float lon1, float lat2, float lon2) {
+    const float R = 6371000;
+    float dLat = (lat2 - lat1) * PI / 180.0;
+    float dLon = (lon2 - lon1) * PI / 180.0;
+    float a = sin(dLat / 2) * sin(dLat / 2) +
+              cos(lat1 * PI / 180.0) * cos(lat2 * PI / 180.0) *
+              sin(dLon / 2) * sin(dLon / 2);
+    float c = 2 * atan2(sqrt(a), sqrt(1 - a));
+    return R * c;
+}
+
+} // namespace baseline
@@ -0,0 +1,47 @@
+// Baseline.h
+// The tracker's original String and float code, kept for the benchmarks
+// to measure the replacements against. Copied from the first revision of
+// Neo6mGPS and BikeTrackerCore with only the class scope removed.
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <Arduino.h>
+
+namespace baseline {
+
+struct GPSData {
+    bool isValid;
+    float latitude;
+    float longitude;
+    float altitude;
+    float speed;
+    int satellites;
+    float hdop;
+    String timestamp;
+};
+
+extern GPSData currentData;
+
+// Neo6mGPS::read() and parseGPSData() for one byte; true when a sentence ended
+bool feed(char c);
+bool parseGGA(String sentence);
+bool parseRMC(String sentence);
+float convertDMSToDecimal(String dms, String direction);
+
+// The scan inside Sim800L::waitForResponse() over a reply already
+// received: append each byte, then search the whole reply for expected
+// and for "ERROR". True on expected; lastResponse gets the reply so far.
+bool scanResponse(const char *reply, size_t length, const String &expected, String &lastResponse);
+
+// The JSON body of the original Sim800L::sendLocationHTTP(), one fix per
+// POST. timestamp stands in for its millis() call.
+String locationJSON(const String &deviceId, float latitude, float longitude, unsigned long timestamp,
+                    const String &alertType, int signalStrength, const String &localIP, const String &imei);
+
+// BikeTrackerCore::calculateDistance(), float haversine
+float calculateDistance(float lat1, float lon1, float lat2, float lon2);
+
+} // namespace baseline
+
+#endif // BASELINE_H
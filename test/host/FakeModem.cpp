@@ -0,0 +1,113 @@
+// FakeModem.cpp
+// Implementation of the scripted SIM800L
+
+#include "FakeModem.h"
+#include <stdlib.h>
+
+FakeModem::FakeModem(MockTransport &transport) : port(transport) {
+    payloadExpected = 0;
+    bodyCount = 0;
+    httpStatus = 200;
+}
+
+void FakeModem::setReply(const char *prefix, const char *lines) {
+    Reply reply;
+    reply.prefix = prefix;
+    reply.lines = lines;
+    replies.push_back(reply);
+}
+
+void FakeModem::setHttpStatus(int status) {
+    httpStatus = status;
+}
+
+const std::vector<std::string> &FakeModem::commands() {
+    return log;
+}
+
+int FakeModem::count(const char *prefix) {
+    int total = 0;
+    for (size_t i = 0; i < log.size(); i++) {
+        if (log[i].compare(0, strlen(prefix), prefix) == 0) {
+            total++;
+        }
+    }
+    return total;
+}
+
+const std::string &FakeModem::lastBody() {
+    return body;
+}
+
+int FakeModem::bodies() {
+    return bodyCount;
+}
+
+void FakeModem::service() {
+    received.append(port.sentText(), port.sentLength());
+    port.clearSent();
+
+    while (!received.empty()) {
+        if (payloadExpected > 0) {
+            if (received.size() < payloadExpected) {
+                return;
+            }
+            body = received.substr(0, payloadExpected);
+            bodyCount++;
+            received.erase(0, payloadExpected);
+            payloadExpected = 0;
+            send("OK");
+            continue;
+        }
+        size_t end = received.find("\r\n");
+        if (end == std::string::npos) {
+            return;
+        }
+        std::string command = received.substr(0, end);
+        received.erase(0, end + 2);
+        if (!command.empty()) {
+            log.push_back(command);
+            answer(command);
+        }
+    }
+}
+
+void FakeModem::answer(const std::string &command) {
+    for (size_t i = 0; i < replies.size(); i++) {
+        if (command.compare(0, replies[i].prefix.size(), replies[i].prefix) == 0) {
+            send(replies[i].lines);
+            return;
+        }
+    }
+
+    if (command == "AT+CREG?") {
+        send("+CREG: 1,1\nOK");
+    } else if (command == "AT+SAPBR=2,1") {
+        send("+SAPBR: 1,1,\"10.0.0.2\"\nOK");
+    } else if (command == "AT+CSQ") {
+        send("+CSQ: 20,0\nOK");
+    } else if (command == "AT+GSN") {
+        send("861234567890123\nOK");
+    } else if (command.compare(0, 12, "AT+HTTPDATA=") == 0) {
+        payloadExpected = strtoul(command.c_str() + 12, NULL, 10);
+        send("DOWNLOAD");
+    } else if (command.compare(0, 14, "AT+HTTPACTION=") == 0) {
+        send("OK\n+HTTPACTION: " + command.substr(14) + "," + std::to_string(httpStatus) + ",0");
+    } else {
+        send("OK");
+    }
+}
+
+void FakeModem::send(const std::string &lines) {
+    std::string text;
+    size_t start = 0;
+    while (start <= lines.size()) {
+        size_t end = lines.find('\n', start);
+        if (end == std::string::npos) {
+            end = lines.size();
+        }
+        text += "\r\n" + lines.substr(start, end - start) + "\r\n";
+        start = end + 1;
+    }
+    port.inject(text.c_str());
+}
@@ -0,0 +1,51 @@
+// FakeModem.h
+// Scripted SIM800L on the far side of a MockTransport, for host tests
+//
+// service() reads the commands the driver wrote and answers each one the
+// way a registered modem with an open bearer would. Answers can be
+// overridden per command prefix. HTTPDATA payloads are captured.
+
+#ifndef FAKEMODEM_H
+#define FAKEMODEM_H
+
+#include <string>
+#include <vector>
+#include "MockTransport.h"
+
+class FakeModem {
+public:
+    FakeModem(MockTransport &port);
+
+    // Answer everything the driver has written since the last call
+    void service();
+
+    // Reply lines for commands starting with prefix, '\n' separated.
+    // Checked in the order added, before the defaults.
+    void setReply(const char *prefix, const char *lines);
+    void setHttpStatus(int status);
+
+    const std::vector<std::string> &commands();
+    int count(const char *prefix);          // Commands sent starting with prefix
+    const std::string &lastBody();          // Last HTTPDATA payload
+    int bodies();
+
+private:
+    struct Reply {
+        std::string prefix;
+        std::string lines;
+    };
+
+    MockTransport &port;
+    std::string received;
+    std::vector<std::string> log;
+    std::vector<Reply> replies;
+    size_t payloadExpected;                 // HTTPDATA bytes still to come, 0 if none
+    std::string body;
+    int bodyCount;
+    int httpStatus;
+
+    void answer(const std::string &command);
+    void send(const std::string &lines);
+};
+
+#endif // FAKEMODEM_H
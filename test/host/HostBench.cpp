@@ -0,0 +1,58 @@
+// HostBench.cpp
+// Implementation of the benchmark helpers, see HostBench.h
+
+#include "HostBench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <new>
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    void *block = malloc(size > 0 ? size : 1);
+    if (block == NULL) {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *block) noexcept {
+    free(block);
+}
+
+void operator delete[](void *block) noexcept {
+    free(block);
+}
+
+void operator delete(void *block, size_t size) noexcept {
+    (void)size;
+    free(block);
+}
+
+void operator delete[](void *block, size_t size) noexcept {
+    (void)size;
+    free(block);
+}
+
+double benchSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+unsigned long benchAllocations() {
+    return allocations;
+}
+
+void benchReport(const char *name, const char *unit, unsigned long operations,
+                 double seconds, unsigned long allocations) {
+    printf("  %-32s %12.0f %s/s %10.1f ns/%s %8.2f allocs/%s\n", name,
+           operations / seconds, unit, seconds * 1e9 / operations, unit,
+           (double)allocations / operations, unit);
+}
@@ -0,0 +1,25 @@
+// HostBench.h
+// Wall-clock timing and heap allocation counts for the host benchmarks
+//
+// Times come from the host CPU, so only the ratio between two code paths
+// carries over to the ESP8266, not the absolute numbers. Allocations are
+// operator new calls. The host String is a std::string, whose inline
+// buffer (15 characters) is larger than the ESP8266 core's (11), so
+// String-heavy code allocates at least as often on the device.
+
+#ifndef HOSTBENCH_H
+#define HOSTBENCH_H
+
+double benchSeconds();                  // Monotonic
+unsigned long benchAllocations();       // operator new calls so far
+
+// Keep the optimizer from discarding a result the benchmark never uses
+template <typename T> inline void benchKeep(const T &value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// One line: operations per second, nanoseconds and allocations per operation
+void benchReport(const char *name, const char *unit, unsigned long operations,
+                 double seconds, unsigned long allocations);
+
+#endif // HOSTBENCH_H
@@ -0,0 +1,38 @@
+// HostTest.h
+// Minimal checks for the host tests: each failed CHECK is printed with
+// its location, and TEST_RESULT() turns the count into the exit status
+
+#ifndef HOSTTEST_H
+#define HOSTTEST_H
+
+#include <stdio.h>
+
+static int hostTestFailures = 0;
+static int hostTestChecks = 0;
+
+#define CHECK(condition)                                                       \
+    do {                                                                       \
+        hostTestChecks++;                                                      \
+        if (!(condition)) {                                                    \
+            hostTestFailures++;                                                \
+            printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+        }                                                                      \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                          \
+    do {                                                                       \
+        hostTestChecks++;                                                      \
+        long long expectedValue = (long long)(expected);                       \
+        long long actualValue = (long long)(actual);                           \
+        if (expectedValue != actualValue) {                                    \
+            hostTestFailures++;                                                \
+            printf("%s:%d: CHECK_EQUAL failed: %s is %lld, expected %lld\n",   \
+                   __FILE__, __LINE__, #actual, actualValue, expectedValue);   \
+        }                                                                      \
+    } while (0)
+
+#define TEST_RESULT(name)                                                      \
+    (printf("%s: %d checks, %d failed\n", name, hostTestChecks, hostTestFailures), \
+     hostTestFailures == 0 ? 0 : 1)
+
+#endif // HOSTTEST_H
@@ -0,0 +1,100 @@
+// Ride.cpp
+// Implementation of the synthetic ride, see Ride.h
+
+#include "Ride.h"
+#include <math.h>
+#include <stdio.h>
+
+static uint32_t rideState = 12345;
+
+static double rideRandom() {
+    rideState = rideState * 1664525UL + 1013904223UL;
+    return (rideState >> 8) / 16777216.0;
+}
+
+void makeRide(RideFix *fixes, int count) {
+    rideState = 12345;
+    double latitude = 14.5995;
+    double longitude = 120.9842;
+    double speed = 0.0;
+    double course = 40.0;
+    double target = 18.0;
+    for (int i = 0; i < count; i++) {
+        // A stop every few minutes, otherwise cruise with some variation
+        if (i % 240 < 30) {
+            target = 0.0;
+        } else if (i % 60 == 0) {
+            target = 12.0 + rideRandom() * 14.0;
+        }
+        speed += (target - speed) * 0.15;
+        if (speed < 0.3) {
+            speed = 0.0;
+        }
+        course = fmod(course + (rideRandom() - 0.5) * 6.0 + 360.0, 360.0);
+
+        double metres = speed / 3.6;
+        latitude += metres * cos(course * M_PI / 180.0) / 111320.0;
+        longitude += metres * sin(course * M_PI / 180.0) / (111320.0 * cos(latitude * M_PI / 180.0));
+
+        RideFix &fix = fixes[i];
+        fix.latitude = latitude + (rideRandom() - 0.5) * 2e-5;
+        fix.longitude = longitude + (rideRandom() - 0.5) * 2e-5;
+        fix.speed = (float)speed;
+        fix.course = (float)course;
+        fix.altitude = 12.0f + (float)(rideRandom() * 3.0);
+        fix.satellites = 6 + (int)(rideRandom() * 6);
+        fix.hdop = 0.8f + (float)(rideRandom() * 1.5);
+        fix.second = i;
+    }
+}
+
+std::string nmeaCoordinate(double degrees, bool longitude, char &hemisphere) {
+    hemisphere = degrees < 0 ? (longitude ? 'W' : 'S') : (longitude ? 'E' : 'N');
+    degrees = fabs(degrees);
+    int whole = (int)degrees;
+    double minutes = (degrees - whole) * 60.0;
+    char text[24];
+    snprintf(text, sizeof(text), longitude ? "%03d%07.4f" : "%02d%07.4f", whole, minutes);
+    return text;
+}
+
+static void addSentence(std::string &out, const char *body) {
+    uint8_t checksum = 0;
+    for (const char *c = body; *c != '\0'; c++) {
+        checksum ^= (uint8_t)*c;
+    }
+    char text[100];
+    snprintf(text, sizeof(text), "$%s*%02X\r\n", body, checksum);
+    out += text;
+}
+
+std::string rideNmea(const RideFix *fixes, int count) {
+    std::string out;
+    char body[100];
+    for (int i = 0; i < count; i++) {
+        const RideFix &fix = fixes[i];
+        uint32_t seconds = 4 * 3600 + fix.second;
+        char time[16];
+        snprintf(time, sizeof(time), "%02u%02u%02u.00", seconds / 3600 % 24, seconds / 60 % 60, seconds % 60);
+        char ns, ew;
+        std::string lat = nmeaCoordinate(fix.latitude, false, ns);
+        std::string lon = nmeaCoordinate(fix.longitude, true, ew);
+        float knots = fix.speed / 1.852f;
+
+        snprintf(body, sizeof(body), "GPRMC,%s,A,%s,%c,%s,%c,%.3f,%.2f,161026,,,A",
+                 time, lat.c_str(), ns, lon.c_str(), ew, knots, fix.course);
+        addSentence(out, body);
+        snprintf(body, sizeof(body), "GPVTG,%.2f,T,,M,%.3f,N,%.3f,K,A", fix.course, knots, fix.speed);
+        addSentence(out, body);
+        snprintf(body, sizeof(body), "GPGGA,%s,%s,%c,%s,%c,1,%02d,%.2f,%.1f,M,46.9,M,,",
+                 time, lat.c_str(), ns, lon.c_str(), ew, fix.satellites, fix.hdop, fix.altitude);
+        addSentence(out, body);
+        snprintf(body, sizeof(body), "GPGSA,A,3,04,05,09,12,17,24,25,,,,,,%.2f,%.2f,%.2f",
+                 fix.hdop * 1.6f, fix.hdop, fix.hdop * 1.2f);
+        addSentence(out, body);
+        addSentence(out, "GPGSV,3,1,11,04,40,083,46,05,17,308,41,09,07,344,39,12,77,004,42");
+        addSentence(out, "GPGSV,3,2,11,17,18,159,40,24,30,208,43,25,52,235,44,26,11,040,");
+        addSentence(out, "GPGSV,3,3,11,28,35,124,,29,05,270,,31,21,062,");
+    }
+    return out;
+}
@@ -0,0 +1,32 @@
+// Ride.h
+// Synthetic 1 Hz bike ride for the host benchmarks
+//
+// Stands in for a recorded ride: stops, accelerations and slow turns
+// through Manila, with receiver noise, repeatable from run to run.
+
+#ifndef RIDE_H
+#define RIDE_H
+
+#include <stdint.h>
+#include <string>
+
+struct RideFix {
+    double latitude;            // Degrees
+    double longitude;
+    float speed;                // km/h
+    float course;               // Degrees
+    float altitude;
+    int satellites;
+    float hdop;
+    uint32_t second;            // Since the start of the ride
+};
+
+void makeRide(RideFix *fixes, int count);
+
+// The ride as a NEO-6M sends it: RMC, VTG, GGA, GSA and three GSV each second
+std::string rideNmea(const RideFix *fixes, int count);
+
+// NMEA coordinate text, "ddmm.mmmm" or "dddmm.mmmm" plus hemisphere
+std::string nmeaCoordinate(double degrees, bool longitude, char &hemisphere);
+
+#endif // RIDE_H
@@ -0,0 +1,72 @@
+// UploadBodies.cpp
+// Implementation of the benchmark upload bodies, see UploadBodies.h
+
+#include "UploadBodies.h"
+#include <math.h>
+#include "APIConfig.h"
+#include "Coordinates.h"
+#include "Sim800L.h"
+#include "Ride.h"
+
+int rideFixes(LocationFix *fixes, int rideSeconds, int sampleSeconds) {
+    RideFix *ride = new RideFix[rideSeconds];
+    makeRide(ride, rideSeconds);
+    int count = 0;
+    for (int i = 0; i < rideSeconds; i += sampleSeconds) {
+        LocationFix &fix = fixes[count++];
+        fix.latitudeE7 = (int32_t)lround(ride[i].latitude * 1e7);
+        fix.longitudeE7 = (int32_t)lround(ride[i].longitude * 1e7);
+        fix.timestamp = 86400000UL + ride[i].second * 1000UL;
+    }
+    delete[] ride;
+    return count;
+}
+
+String locationJSON(const LocationFix &fix, const char *alertType) {
+    char latitude[COORDINATE_TEXT_SIZE];
+    char longitude[COORDINATE_TEXT_SIZE];
+    formatCoordinate(fix.latitudeE7, latitude);
+    formatCoordinate(fix.longitudeE7, longitude);
+
+    String jsonData = "{";
+    jsonData += "\"deviceId\":\"" + String(DEVICE_ID) + "\",";
+    jsonData += "\"latitude\":" + String(latitude) + ",";
+    jsonData += "\"longitude\":" + String(longitude) + ",";
+    jsonData += "\"timestamp\":\"" + String((unsigned long)fix.timestamp) + "\",";
+    jsonData += "\"alertType\":\"" + String(alertType) + "\",";
+    jsonData += "\"signalStrength\":" + String(BODY_SIGNAL) + ",";
+    jsonData += "\"localIP\":\"" + String(BODY_LOCAL_IP) + "\",";
+    jsonData += "\"imei\":\"" + String(BODY_IMEI) + "\"";
+    jsonData += "}";
+    return jsonData;
+}
+
+String batchJSON(const LocationFix *fixes, int count) {
+    String list = "";
+    for (int i = 0; i < count; i++) {
+        Sim800L::appendLocationFix(list, fixes[i].latitudeE7, fixes[i].longitudeE7, fixes[i].timestamp);
+    }
+    String jsonData = "{";
+    jsonData += "\"deviceId\":\"" + String(DEVICE_ID) + "\",";
+    jsonData += "\"signalStrength\":" + String(BODY_SIGNAL) + ",";
+    jsonData += "\"localIP\":\"" + String(BODY_LOCAL_IP) + "\",";
+    jsonData += "\"imei\":\"" + String(BODY_IMEI) + "\",";
+    jsonData += "\"locations\":[" + list + "]";
+    jsonData += "}";
+    return jsonData;
+}
+
+size_t binaryBatch(const LocationFix *fixes, int count, uint8_t *buffer, size_t capacity) {
+    LocationHeader header;
+    memset(&header, 0, sizeof(header));
+    header.version = LOCATION_CODEC_VERSION;
+    strncpy(header.deviceId, DEVICE_ID, LOCATION_CODEC_ID_MAX);
+    strncpy(header.imei, BODY_IMEI, LOCATION_CODEC_IMEI_MAX);
+    header.signalStrength = BODY_SIGNAL;
+    LocationEncoder encoder(buffer, capacity);
+    encoder.begin(header);
+    for (int i = 0; i < count; i++) {
+        encoder.add(fixes[i]);
+    }
+    return encoder.failed() ? 0 : encoder.size();
+}
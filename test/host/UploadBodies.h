@@ -0,0 +1,26 @@
+// UploadBodies.h
+// Upload bodies of the synthetic ride, built the way the tracker builds
+// them, for the payload benchmarks. Sim800L::buildLocationJSON() is
+// private, so its two JSON forms are repeated here around the public
+// appendLocationFix().
+
+#ifndef UPLOADBODIES_H
+#define UPLOADBODIES_H
+
+#include <Arduino.h>
+#include "LocationCodec.h"
+
+#define BODY_IMEI "861234567890123"
+#define BODY_LOCAL_IP "10.123.45.67"
+#define BODY_SIGNAL 18
+
+// One fix every sampleSeconds of a ride of rideSeconds. Returns the count.
+int rideFixes(LocationFix *fixes, int rideSeconds, int sampleSeconds);
+
+String locationJSON(const LocationFix &fix, const char *alertType);
+String batchJSON(const LocationFix *fixes, int count);
+
+// LocationEncoder with the same metadata; 0 if buffer is too small
+size_t binaryBatch(const LocationFix *fixes, int count, uint8_t *buffer, size_t capacity);
+
+#endif // UPLOADBODIES_H
@@ -0,0 +1,206 @@
+// test_transport.cpp
+// The GPS and GSM drivers over MockTransport: NMEA in through Neo6mGPS,
+// AT commands and replies through Sim800L and a scripted modem
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "FakeModem.h"
+#include "MockTransport.h"
+#include "Neo6mGPS.h"
+#include "Sim800L.h"
+
+static const char *GGA = "$GPGGA,123519.00,1435.9700,N,12059.0526,E,1,08,0.9,12.5,M,46.9,M,,*5E\r\n";
+static const char *RMC = "$GPRMC,123519.00,A,1435.9700,N,12059.0526,E,12.6,84.4,161026,,,A*5F\r\n";
+static const char *GSA = "$GPGSA,A,3,04,05,,09,12,,,24,,,,,2.5,0.9,2.1*32\r\n";
+static const char *NEXT_GGA = "$GPGGA,123520.00,1435.9710,N,12059.0530,E,1,09,1.0,12.6,M,46.9,M,,*58\r\n";
+
+static void testNmeaEpochPublished() {
+    hostSetMillis(0);
+    MockTransport port;
+    Neo6mGPS gps(port);
+    gps.begin(9600);
+    CHECK(port.isOpen());
+    CHECK_EQUAL(9600, port.getBaudRate());
+    CHECK(strstr(port.sentText(), "$PUBX,40,GGA,0,1,0,0*5A\r\n") != NULL);
+    CHECK(strstr(port.sentText(), "$PUBX,40,RMC,0,1,0,0*47\r\n") != NULL);
+
+    // GGA alone is half an epoch
+    port.inject(GGA);
+    gps.poll();
+    CHECK_EQUAL(0, gps.getFixCount());
+
+    port.inject(RMC);
+    gps.poll();
+    CHECK_EQUAL(1, gps.getFixCount());
+    GPSData fix = gps.getLatestFix();
+    CHECK(fix.isValid);
+    CHECK_EQUAL(145995000, fix.latitudeE7);
+    CHECK_EQUAL(1209842100, fix.longitudeE7);
+    CHECK_EQUAL(8, fix.satellites);
+    CHECK(fabs(fix.hdop - 0.9f) < 0.001f);
+    CHECK(fabs(fix.speed - 12.6f * 1.852f) < 0.01f);
+    CHECK_EQUAL(strlen(GGA) + strlen(RMC), gps.getBytesReceived());
+
+    // The next second's GGA must not be published without its RMC
+    port.inject(NEXT_GGA);
+    gps.poll();
+    CHECK_EQUAL(1, gps.getFixCount());
+    CHECK_EQUAL(145995000, gps.getLatestFix().latitudeE7);
+}
+
+static void testNmeaLateGsaJoinsFix() {
+    // GSA follows GGA and RMC, after the epoch is already published
+    hostSetMillis(0);
+    MockTransport port;
+    Neo6mGPS gps(port);
+    gps.begin(9600);
+    port.inject(GGA);
+    port.inject(RMC);
+    port.inject(GSA);
+    gps.poll();
+    CHECK_EQUAL(1, gps.getFixCount());
+    GPSData fix = gps.getLatestFix();
+    CHECK_EQUAL(3, fix.fixMode);
+    CHECK(fabs(fix.pdop - 2.5f) < 0.001f);
+    CHECK(fabs(fix.vdop - 2.1f) < 0.001f);
+    CHECK_EQUAL(145995000, fix.latitudeE7);
+
+    // A new epoch starts blank until its own GSA
+    port.inject(NEXT_GGA);
+    port.inject("$GPRMC,123520.00,A,1435.9710,N,12059.0530,E,12.6,84.4,161026,,,A*53\r\n");
+    gps.poll();
+    CHECK_EQUAL(2, gps.getFixCount());
+    CHECK_EQUAL(0, gps.getLatestFix().fixMode);
+}
+
+static void testNmeaSplitAcrossReads() {
+    hostSetMillis(0);
+    MockTransport port;
+    Neo6mGPS gps(port);
+    gps.begin(9600);
+    for (const char *c = GGA; *c != '\0'; c++) {
+        port.inject((const uint8_t *)c, 1);
+        gps.poll();
+    }
+    for (const char *c = RMC; *c != '\0'; c++) {
+        port.inject((const uint8_t *)c, 1);
+        gps.poll();
+    }
+    CHECK_EQUAL(1, gps.getFixCount());
+    CHECK_EQUAL(145995000, gps.getLatestFix().latitudeE7);
+}
+
+static void testRxOverflowCounted() {
+    hostSetMillis(0);
+    MockTransport port(32);
+    Neo6mGPS gps(port);
+    gps.begin(9600);
+    CHECK_EQUAL(32, port.inject(GGA));
+    gps.poll();
+    CHECK_EQUAL(1, gps.getRxOverflowCount());
+    CHECK_EQUAL(0, gps.getFixCount());
+}
+
+static bool jobDone = false;
+static bool jobSuccess = false;
+
+static void onJob(void *context, bool success, const String &response) {
+    (void)context;
+    (void)response;
+    jobDone = true;
+    jobSuccess = success;
+}
+
+static void runModem(Sim800L &gsm, FakeModem &modem) {
+    for (int i = 0; i < 100000 && !jobDone; i++) {
+        gsm.update();
+        modem.service();
+        hostAdvanceMillis(1);
+    }
+}
+
+static void testRegistration() {
+    hostSetMillis(0);
+    MockTransport port;
+    FakeModem modem(port);
+    Sim800L gsm(port);
+    gsm.begin(9600);
+    jobDone = false;
+    CHECK(gsm.queueRegistration(onJob, NULL));
+    runModem(gsm, modem);
+    CHECK(jobDone && jobSuccess);
+    CHECK_EQUAL(GSM_NETWORK_CONNECTED, gsm.getStatus());
+    CHECK_EQUAL(1, modem.count("ATE0"));
+    CHECK_EQUAL(1, modem.count("AT+CMGF=1"));
+    CHECK_EQUAL(1, modem.count("AT+CREG?"));
+}
+
+static void testRegistrationSearching() {
+    hostSetMillis(0);
+    MockTransport port;
+    FakeModem modem(port);
+    modem.setReply("AT+CREG?", "+CREG: 1,2\nOK");
+    Sim800L gsm(port);
+    gsm.begin(9600);
+    jobDone = false;
+    CHECK(gsm.queueRegistration(onJob, NULL));
+    runModem(gsm, modem);
+    CHECK(jobDone && !jobSuccess);
+    CHECK_EQUAL(GSM_NO_NETWORK, gsm.getStatus());
+}
+
+static void testModemError() {
+    hostSetMillis(0);
+    MockTransport port;
+    FakeModem modem(port);
+    modem.setReply("AT+CMGF", "ERROR");
+    Sim800L gsm(port);
+    gsm.begin(9600);
+    jobDone = false;
+    CHECK(gsm.queueRegistration(onJob, NULL));
+    runModem(gsm, modem);
+    CHECK(jobDone && !jobSuccess);
+    CHECK_EQUAL(GSM_ERROR, gsm.getStatus());
+    CHECK_EQUAL(0, modem.count("AT+CREG?"));
+}
+
+static void testBinaryUploadSkipsRead() {
+    hostSetMillis(0);
+    MockTransport port;
+    FakeModem modem(port);
+    Sim800L gsm(port);
+    gsm.begin(9600);
+    jobDone = false;
+    CHECK(gsm.queueBinaryHTTP("http://example.com/batch", "application/octet-stream",
+                              String("\x01\x02\x03"), onJob, NULL));
+    runModem(gsm, modem);
+    CHECK(jobDone && jobSuccess);
+    CHECK_EQUAL(1, modem.count("AT+HTTPACTION=1"));
+    CHECK_EQUAL(0, modem.count("AT+HTTPREAD"));
+}
+
+static void testPlainRequestReadsBody() {
+    hostSetMillis(0);
+    MockTransport port;
+    FakeModem modem(port);
+    Sim800L gsm(port);
+    gsm.begin(9600);
+    jobDone = false;
+    CHECK(gsm.queueHTTP("GET", "http://example.com/status", "", onJob, NULL));
+    runModem(gsm, modem);
+    CHECK(jobDone && jobSuccess);
+    CHECK_EQUAL(1, modem.count("AT+HTTPREAD"));
+}
+
+int main() {
+    testNmeaEpochPublished();
+    testNmeaLateGsaJoinsFix();
+    testNmeaSplitAcrossReads();
+    testRxOverflowCounted();
+    testRegistration();
+    testRegistrationSearching();
+    testModemError();
+    testBinaryUploadSkipsRead();
+    testPlainRequestReadsBody();
+    return TEST_RESULT("test_transport");
+}
@@ -0,0 +1,166 @@
+// test_upload_batch.cpp
+// Batching of routine location reports (UploadQueue flush policy) and the
+// batch body the modem posts, on the virtual clock
+
+#include <Arduino.h>
+#include "HostTest.h"
+#include "FakeModem.h"
+#include "APIConfig.h"
+#include "UploadQueue.h"
+#include "MockTransport.h"
+#include "Sim800L.h"
+
+static RetryPolicy testPolicy() {
+    return RetryPolicy(HTTP_RETRY_DELAY, UPLOAD_BACKOFF_MAX, UPLOAD_BREAKER_THRESHOLD, UPLOAD_BREAKER_COOLDOWN);
+}
+
+static void pushRoutine(UploadQueue &queue, unsigned long capturedAt) {
+    queue.push(145995000 + (int32_t)capturedAt, 1209842000, "", HTTP_RETRY_ATTEMPTS, capturedAt);
+}
+
+static void testPartialBatchHeld() {
+    hostSetMillis(1000);
+    UploadQueue queue(testPolicy());
+    for (int i = 0; i < PH_MAX_BATCH_SIZE - 1; i++) {
+        pushRoutine(queue, millis());
+    }
+    CHECK_EQUAL(0, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    hostAdvanceMillis(PH_BATCH_MAX_AGE - 1);
+    CHECK_EQUAL(0, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    CHECK(!queue.isBusy());
+}
+
+static void testFullBatchSent() {
+    hostSetMillis(1000);
+    UploadQueue queue(testPolicy());
+    for (int i = 0; i < PH_MAX_BATCH_SIZE + 1; i++) {
+        pushRoutine(queue, 100 + i);
+    }
+    CHECK_EQUAL(PH_MAX_BATCH_SIZE, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    CHECK_EQUAL(100, queue.current(0)->capturedAt);
+    CHECK(queue.current(PH_MAX_BATCH_SIZE) == NULL);
+    CHECK_EQUAL(UPLOAD_SENT, queue.complete(true));
+    CHECK_EQUAL(1, queue.count());
+}
+
+static void testPartialBatchAtMaxAge() {
+    hostSetMillis(1000);
+    UploadQueue queue(testPolicy());
+    pushRoutine(queue, 1000);
+    hostAdvanceMillis(30000);
+    pushRoutine(queue, 31000);
+    hostAdvanceMillis(PH_BATCH_MAX_AGE - 30000);
+    CHECK_EQUAL(2, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    CHECK_EQUAL(UPLOAD_SENT, queue.complete(true));
+    CHECK_EQUAL(0, queue.count());
+}
+
+static void testFailedBatchRetriedAfterBackoff() {
+    hostSetMillis(1000);
+    UploadQueue queue(testPolicy());
+    for (int i = 0; i < PH_MAX_BATCH_SIZE; i++) {
+        pushRoutine(queue, 100 + i);
+    }
+    CHECK_EQUAL(PH_MAX_BATCH_SIZE, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    CHECK_EQUAL(UPLOAD_DEFERRED, queue.complete(false));
+    CHECK_EQUAL(0, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+
+    // The first backoff is at most the base delay
+    hostAdvanceMillis(HTTP_RETRY_DELAY);
+    CHECK_EQUAL(PH_MAX_BATCH_SIZE, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    CHECK_EQUAL(2, queue.current(0)->attempts);
+    CHECK_EQUAL(UPLOAD_SENT, queue.complete(true));
+}
+
+static void testAlertBypassesBatch() {
+    hostSetMillis(1000);
+    UploadQueue queue(testPolicy());
+    pushRoutine(queue, 100);
+    pushRoutine(queue, 101);
+    queue.push(1, 2, "MOTION_DETECTED", UPLOAD_ALERT_ATTEMPTS, 102, 0, 7);
+    CHECK_EQUAL(1, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    CHECK(queue.current(0)->alertType == "MOTION_DETECTED");
+    CHECK_EQUAL(7, queue.current(0)->alertId);
+    CHECK(queue.current(1) == NULL);
+}
+
+static void testBatchOldestFirstAfterWrap() {
+    // Slots are reused out of time order; the batch must not follow them
+    hostSetMillis(1000);
+    UploadQueue queue(testPolicy());
+    for (int i = 0; i < UPLOAD_QUEUE_SIZE; i++) {
+        pushRoutine(queue, 100 + i);
+    }
+    CHECK_EQUAL(PH_MAX_BATCH_SIZE, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    queue.complete(true);
+    for (int i = 0; i < PH_MAX_BATCH_SIZE; i++) {
+        pushRoutine(queue, 200 + i);
+    }
+    CHECK_EQUAL(PH_MAX_BATCH_SIZE, queue.begin(PH_MAX_BATCH_SIZE, PH_BATCH_MAX_AGE));
+    for (int i = 1; i < PH_MAX_BATCH_SIZE; i++) {
+        CHECK(queue.current(i - 1)->capturedAt < queue.current(i)->capturedAt);
+    }
+    CHECK_EQUAL(100 + PH_MAX_BATCH_SIZE, queue.current(0)->capturedAt);
+}
+
+static bool uploadDone = false;
+static bool uploadSuccess = false;
+
+static void onUpload(void *context, bool success, const String &response) {
+    (void)context;
+    (void)response;
+    uploadDone = true;
+    uploadSuccess = success;
+}
+
+static void testBatchBody() {
+    hostSetMillis(1000);
+    UploadQueue queue(testPolicy());
+    queue.push(145995000, 1209842000, "", HTTP_RETRY_ATTEMPTS, 5000);
+    queue.push(145995100, -1209842100, "", HTTP_RETRY_ATTEMPTS, 35000);
+    CHECK_EQUAL(2, queue.begin(2, PH_BATCH_MAX_AGE));
+
+    String fixes = "";
+    for (uint8_t i = 0; queue.current(i) != NULL; i++) {
+        UploadMessage *fix = queue.current(i);
+        Sim800L::appendLocationFix(fixes, fix->latitudeE7, fix->longitudeE7, fix->capturedAt);
+    }
+
+    MockTransport port;
+    FakeModem modem(port);
+    Sim800L gsm(port);
+    gsm.begin(9600);
+    uploadDone = false;
+    CHECK(gsm.queueLocationBatchHTTP("http://example.com/api", "bike-1", fixes, onUpload, NULL));
+    for (int i = 0; i < 100000 && !uploadDone; i++) {
+        gsm.update();
+        modem.service();
+        hostAdvanceMillis(1);
+    }
+    CHECK(uploadDone && uploadSuccess);
+    CHECK_EQUAL(1, modem.bodies());
+    CHECK_EQUAL(1, modem.count("AT+HTTPACTION=1"));
+
+    const char *expected =
+        "{\"deviceId\":\"bike-1\",\"signalStrength\":-1,\"localIP\":\"10.0.0.2\",\"imei\":\"Unknown\","
+        "\"locations\":["
+        "{\"latitude\":14.5995000,\"longitude\":120.9842000,\"timestamp\":\"5000\"},"
+        "{\"latitude\":14.5995100,\"longitude\":-120.9842100,\"timestamp\":\"35000\"}"
+        "]}";
+    CHECK(modem.lastBody() == expected);
+    if (modem.lastBody() != expected) {
+        printf("  body: %s\n", modem.lastBody().c_str());
+    }
+    queue.complete(uploadSuccess);
+}
+
+int main() {
+    testPartialBatchHeld();
+    testFullBatchSent();
+    testPartialBatchAtMaxAge();
+    testFailedBatchRetriedAfterBackoff();
+    testAlertBypassesBatch();
+    testBatchOldestFirstAfterWrap();
+    testBatchBody();
+    return TEST_RESULT("test_upload_batch");
+}